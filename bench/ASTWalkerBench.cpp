@@ -0,0 +1,153 @@
+// Walks the tree of a generated program counting nodes and summing integer
+// constants, once with a virtual ASTVisitor and once with an ASTWalker.
+// The size of the program in kilobytes can be given on the command line,
+// the default is 4096.
+
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+
+#include "Bench.hpp"
+#include "AST/ASTArena.hpp"
+#include "AST/ASTVisitor.hpp"
+#include "AST/ASTWalker.hpp"
+#include "Lexer/Lexer.hpp"
+#include "Lexer/TokenBuffer.hpp"
+#include "Parser/Parser.hpp"
+#include "Source/SourceBuffer.hpp"
+
+using namespace Nitro;
+
+namespace {
+
+// What every pass had to write before ASTWalker: all the overloads, and the
+// walk into the children in each of them
+class VirtualSum : public ASTVisitor {
+public:
+	void visit(ASTNodeConstant<std::int64_t>& node) override { count++; sum += node.m_value; }
+	void visit(ASTNodeConstant<double>&) override { count++; }
+	void visit(ASTNodeConstant<bool>&) override { count++; }
+	void visit(ASTNodeConstant<std::string_view>&) override { count++; }
+	void visit(ASTNodeConstant<char>&) override { count++; }
+	void visit(ASTNodeNil&) override { count++; }
+
+	void visit(ASTNodeBinary& node) override {
+		count++;
+		walk(node.m_left);
+		walk(node.m_right);
+	}
+
+	void visit(ASTNodeUnary& node) override {
+		count++;
+		walk(node.m_branch);
+	}
+
+	void visit(ASTNodeVariableInvokation& node) override {
+		count++;
+		for (ASTNode* arg : node.m_args) {
+			walk(arg);
+		}
+	}
+
+	void visit(ASTNodeVariableDeclaration& node) override {
+		count++;
+		walk(node.m_assign);
+	}
+
+	void visit(ASTNodeStatementSet& node) override {
+		count++;
+		for (ASTNode* statement : node.m_statements) {
+			walk(statement);
+		}
+	}
+
+	void visit(ASTNodeConditional& node) override {
+		count++;
+		for (auto& condition : node.m_conditions) {
+			walk(condition.first);
+			walk(condition.second);
+		}
+		walk(node.m_else_statement);
+	}
+
+	void visit(ASTNodeFunctionDefinition& node) override {
+		count++;
+		walk(node.m_contents);
+	}
+
+	void visit(ASTNodeFunctionReturn& node) override {
+		count++;
+		walk(node.m_expr);
+	}
+
+	std::size_t count = 0;
+	std::int64_t sum = 0;
+
+private:
+	void walk(ASTNode* node) {
+		if (node) {
+			node->visit(*this);
+		}
+	}
+};
+
+class WalkerSum : public ASTWalker<WalkerSum> {
+public:
+	using ASTWalker<WalkerSum>::enter;
+
+	template <typename Node>
+	bool enter(Node&) {
+		count++;
+		return true;
+	}
+
+	bool enter(ASTNodeInt64& node) {
+		count++;
+		sum += node.m_value;
+		return true;
+	}
+
+	std::size_t count = 0;
+	std::int64_t sum = 0;
+};
+
+} // namespace
+
+int main(int argc, char** argv) {
+	std::size_t kilobytes = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 4096;
+	constexpr int runs = 10;
+
+	SourceBuffer source = SourceBuffer::fromString(Bench::program(kilobytes << 10));
+	Lexer lexer(source);
+	TokenBuffer tokens = lexer.tokenizeAll();
+
+	ASTArena arena;
+	ASTNode* root = Parser(tokens, arena).parse();
+
+	VirtualSum reference;
+	root->visit(reference);
+	double nodes = static_cast<double>(reference.count);
+	std::printf("%zu bytes, %zu nodes\n", source.size(), reference.count);
+
+	double time = Bench::best(runs, [&] {
+		VirtualSum visitor;
+		root->visit(visitor);
+		Bench::keep(visitor.sum);
+	});
+	Bench::report("ASTVisitor", time, nodes, "node");
+
+	WalkerSum walker;
+	time = Bench::best(runs, [&] {
+		walker = WalkerSum();
+		walker.walk(root);
+		Bench::keep(walker.sum);
+	});
+	Bench::report("ASTWalker", time, nodes, "node");
+
+	if (walker.count != reference.count || walker.sum != reference.sum) {
+		std::printf("Walks differ\n");
+		return 1;
+	}
+
+	return 0;
+}
@@ -0,0 +1,151 @@
+#pragma once
+
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <string>
+
+namespace Nitro {
+namespace Bench {
+
+// Keeps the optimizer from discarding a computed value.
+template <typename T>
+inline void keep(const T& value) {
+#if defined(__GNUC__) || defined(__clang__)
+	asm volatile("" : : "g"(&value) : "memory");
+#else
+	static volatile const void* sink;
+	sink = &value;
+#endif
+}
+
+// Runs body runs times and returns the fastest run, in seconds.
+template <typename Body>
+double best(int runs, Body&& body) {
+	double fastest = 0.0;
+	for (int i = 0; i < runs; i++) {
+		auto begin = std::chrono::steady_clock::now();
+		body();
+		std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - begin;
+		if (i == 0 || elapsed.count() < fastest) {
+			fastest = elapsed.count();
+		}
+	}
+	return fastest;
+}
+
+inline void report(const char* name, double seconds, double items, const char* unit) {
+	std::printf("%-28s %10.3f ms %10.2f ns/%s\n", name, seconds * 1e3, seconds * 1e9 / items, unit);
+}
+
+// Generates a script of about size bytes: functions with nested blocks of
+// assignments, calls, conditions and returns.
+inline std::string script(std::size_t size) {
+	static const char* const statements[] = {
+		"let total = total + value * 3\n",
+		"if (count >= 10 && !done):\n",
+		"return result\n",
+		"let name = \"some text here\"\n",
+		"print(x, y, 42.5)\n",
+	};
+	constexpr std::size_t statement_count = sizeof(statements) / sizeof(statements[0]);
+
+	std::mt19937 rng(7);
+	std::string script;
+	script.reserve(size + 256);
+
+	while (script.size() < size) {
+		script += "func step(a, b, c):\n";
+		unsigned depth = 1;
+		for (unsigned i = 0, n = 4 + rng() % 12; i < n; i++) {
+			const char* statement = statements[rng() % statement_count];
+			script.append(depth, '\t');
+			script += statement;
+			if (statement[0] == 'i' && depth < 4) {
+				script.append(depth + 1, '\t');
+				script += "counter = counter + 1\n";
+				depth++;
+			} else if (depth > 1 && rng() % 3 == 0) {
+				depth--;
+			}
+		}
+		script += "\n";
+	}
+
+	return script;
+}
+
+// Generates a program of about size bytes that parses without errors:
+// functions whose bodies mix declarations, calls, conditionals with else
+// branches and returns, over expressions of every precedence level.
+inline std::string program(std::size_t size) {
+	static const char* const expressions[] = {
+		"a + b * 3 - c / 2",
+		"(x + 1) * (y - 2) ** 2",
+		"count >= 10 && !done || flag",
+		"mask & 255 | bits << 4 ^ ~value",
+		"step(a, b - 1, 42.5) + step(c, 0, 1)",
+		"\"some text here\" == name",
+		"-total != nil",
+		"'c'",
+	};
+	constexpr std::size_t expression_count = sizeof(expressions) / sizeof(expressions[0]);
+
+	std::mt19937 rng(11);
+	std::string program;
+	program.reserve(size + 256);
+
+	auto expression = [&] {
+		return expressions[rng() % expression_count];
+	};
+
+	// Appends a block of statements at the given depth
+	auto block = [&](auto& self, unsigned depth) -> void {
+		for (unsigned i = 0, n = 2 + rng() % 4; i < n; i++) {
+			program.append(depth, '\t');
+			switch (rng() % 5) {
+				case 0:
+					program += "let total = ";
+					program += expression();
+					program += "\n";
+					break;
+				case 1:
+					program += "print(total, ";
+					program += expression();
+					program += ")\n";
+					break;
+				case 2:
+					program += "return ";
+					program += expression();
+					program += "\n";
+					break;
+				default:
+					if (depth >= 4) {
+						program += expression();
+						program += "\n";
+						break;
+					}
+					program += "if (";
+					program += expression();
+					program += "):\n";
+					self(self, depth + 1);
+					if (rng() % 2) {
+						program.append(depth, '\t');
+						program += "else:\n";
+						self(self, depth + 1);
+					}
+					break;
+			}
+		}
+	};
+
+	while (program.size() < size) {
+		program += "func step(a, b, c):\n";
+		block(block, 1);
+	}
+
+	return program;
+}
+
+} // namespace Bench
+} // namespace Nitro
@@ -0,0 +1,322 @@
+// Times the ClosureEvaluator against an interpreter that walks the tree
+// through ASTVisitor on every run, and against the stack VM. A script is
+// usually run once, so compiling the resolved tree counts: on the short
+// script it takes as long as the run.
+
+#include <cstdio>
+#include <cstdlib>
+#include <deque>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "Bench.hpp"
+#include "AST/ASTArena.hpp"
+#include "AST/ASTNodeConstant.hpp"
+#include "AST/ASTNodeNil.hpp"
+#include "AST/ASTNodeBinary.hpp"
+#include "AST/ASTNodeUnary.hpp"
+#include "AST/ASTNodeVariableInvokation.hpp"
+#include "AST/ASTNodeVariableDeclaration.hpp"
+#include "AST/ASTNodeStatementSet.hpp"
+#include "AST/ASTNodeConditional.hpp"
+#include "AST/ASTNodeFunctionDefinition.hpp"
+#include "AST/ASTNodeFunctionReturn.hpp"
+#include "AST/ASTVisitor.hpp"
+#include "Lexer/Lexer.hpp"
+#include "Lexer/TokenBuffer.hpp"
+#include "Optimizer/ConstantFolder.hpp"
+#include "Parser/Parser.hpp"
+#include "Semantic/ScopeResolver.hpp"
+#include "Source/SourceBuffer.hpp"
+#include "VM/BytecodeCompiler.hpp"
+#include "VM/ClosureCompiler.hpp"
+#include "VM/ClosureEvaluator.hpp"
+#include "VM/Natives.hpp"
+#include "VM/Operators.hpp"
+#include "VM/TopLevel.hpp"
+#include "VM/VM.hpp"
+
+using namespace Nitro;
+
+namespace {
+
+// The naive way: every node is reached through ASTNode::visit, leaves its
+// value in a member, and frames are vectors. Scripts are trusted, errors
+// abort.
+class TreeInterpreter : public ASTVisitor {
+public:
+	TreeInterpreter(ASTNode* program, const ScopeResolver& resolver, std::ostream& out)
+		: m_top(TopLevel::of(program, resolver)), m_frame_size(resolver.programFrameSize()), m_out(&out) {}
+
+	void run() {
+		m_globals = m_top.globals;
+		std::vector<Value> frame(m_frame_size);
+		m_frame = &frame;
+		m_returning = false;
+		for (ASTNode* statement : m_top.statements) {
+			if (m_returning) {
+				break;
+			}
+			statement->visit(*this);
+		}
+	}
+
+	void visit(ASTNodeConstant<std::int64_t>& node) override { m_value = Value::integer(node.m_value); }
+
+	void visit(ASTNodeConstant<double>& node) override { m_value = Value::floating(node.m_value); }
+
+	void visit(ASTNodeConstant<bool>& node) override { m_value = Value::boolean(node.m_value); }
+
+	void visit(ASTNodeConstant<std::string_view>& node) override {
+		m_strings.push_back(node.m_value);
+		m_value = Value::string(&m_strings.back());
+	}
+
+	void visit(ASTNodeConstant<char>& node) override { m_value = Value::character(node.m_value); }
+
+	void visit(ASTNodeNil&) override { m_value = Value::nil(); }
+
+	void visit(ASTNodeBinary& node) override {
+		using Type = ASTNodeBinary::Type;
+		if (node.m_type == Type::And || node.m_type == Type::Or) {
+			bool is_and = node.m_type == Type::And;
+			node.m_left->visit(*this);
+			if (m_value.truthy() != is_and) {
+				m_value = Value::boolean(!is_and);
+				return;
+			}
+			node.m_right->visit(*this);
+			m_value = Value::boolean(m_value.truthy());
+			return;
+		}
+
+		node.m_left->visit(*this);
+		Value left = m_value;
+		node.m_right->visit(*this);
+		Value right = m_value;
+
+		const char* error = nullptr;
+		switch (node.m_type) {
+			case Type::Add: error = Operators::add(left, right, m_value); break;
+			case Type::Sub: error = Operators::sub(left, right, m_value); break;
+			case Type::Mult: error = Operators::mult(left, right, m_value); break;
+			case Type::Div: error = Operators::div(left, right, m_value); break;
+			case Type::Pow: error = Operators::pow(left, right, m_value); break;
+			case Type::Greater: error = Operators::greater(left, right, m_value); break;
+			case Type::GreaterEqual: error = Operators::greaterEqual(left, right, m_value); break;
+			case Type::RShift: error = Operators::rshift(left, right, m_value); break;
+			case Type::Less: error = Operators::less(left, right, m_value); break;
+			case Type::LessEqual: error = Operators::lessEqual(left, right, m_value); break;
+			case Type::LShift: error = Operators::lshift(left, right, m_value); break;
+			case Type::Equality: error = Operators::equal(left, right, m_value); break;
+			case Type::NonEquality: error = Operators::notEqual(left, right, m_value); break;
+			case Type::BitwiseAnd: error = Operators::bitwiseAnd(left, right, m_value); break;
+			case Type::BitwiseOr: error = Operators::bitwiseOr(left, right, m_value); break;
+			case Type::BitwiseXor: error = Operators::bitwiseXor(left, right, m_value); break;
+			case Type::And:
+			case Type::Or: break;
+		}
+		if (error) {
+			std::abort();
+		}
+	}
+
+	void visit(ASTNodeUnary& node) override {
+		node.m_branch->visit(*this);
+		Value value = m_value;
+		const char* error = nullptr;
+		switch (node.m_type) {
+			case ASTNodeUnary::Type::Plus: break;
+			case ASTNodeUnary::Type::Negate: error = Operators::negate(value, m_value); break;
+			case ASTNodeUnary::Type::Not: error = Operators::logicalNot(value, m_value); break;
+			case ASTNodeUnary::Type::BitwiseNot: error = Operators::bitwiseNot(value, m_value); break;
+		}
+		if (error) {
+			std::abort();
+		}
+	}
+
+	void visit(ASTNodeVariableInvokation& node) override {
+		Value callee = node.m_slot.kind == ASTSlot::Kind::Local ? (*m_frame)[node.m_slot.index] : m_globals[node.m_slot.index];
+		if (!node.m_call) {
+			m_value = callee;
+			return;
+		}
+
+		std::vector<Value> args;
+		for (ASTNode* arg : node.m_args) {
+			arg->visit(*this);
+			args.push_back(m_value);
+		}
+		if (callee.isNative()) {
+			m_value = natives()[callee.asIndex()].function(*m_out, args.data(), args.size());
+			return;
+		}
+
+		ASTNodeFunctionDefinition& function = *m_top.functions[callee.asIndex() - 1];
+		args.resize(function.m_frame_size);
+		std::vector<Value>* caller = m_frame;
+		m_frame = &args;
+		m_value = Value::nil();
+		function.m_contents->visit(*this);
+		if (!m_returning) {
+			m_value = Value::nil();
+		}
+		m_returning = false;
+		m_frame = caller;
+	}
+
+	void visit(ASTNodeVariableDeclaration& node) override {
+		if (node.m_assign) {
+			node.m_assign->visit(*this);
+		} else {
+			m_value = Value::nil();
+		}
+		if (node.m_slot.kind == ASTSlot::Kind::Global) {
+			m_globals[node.m_slot.index] = m_value;
+		} else {
+			(*m_frame)[node.m_slot.index] = m_value;
+		}
+	}
+
+	void visit(ASTNodeStatementSet& node) override {
+		for (ASTNode* statement : node.m_statements) {
+			if (m_returning) {
+				return;
+			}
+			statement->visit(*this);
+		}
+	}
+
+	void visit(ASTNodeConditional& node) override {
+		for (auto& condition : node.m_conditions) {
+			condition.first->visit(*this);
+			if (m_value.truthy()) {
+				condition.second->visit(*this);
+				return;
+			}
+		}
+		if (node.m_else_statement) {
+			node.m_else_statement->visit(*this);
+		}
+	}
+
+	void visit(ASTNodeFunctionDefinition&) override {}
+
+	void visit(ASTNodeFunctionReturn& node) override {
+		if (node.m_expr) {
+			node.m_expr->visit(*this);
+		} else {
+			m_value = Value::nil();
+		}
+		m_returning = true;
+	}
+
+private:
+	TopLevel m_top;
+	std::uint32_t m_frame_size;
+	std::ostream* m_out;
+
+	std::vector<Value> m_globals;
+	std::vector<Value>* m_frame = nullptr;
+	std::deque<std::string_view> m_strings;
+	Value m_value;
+	bool m_returning = false;
+};
+
+template <typename Compiler, typename Engine>
+void timeEngine(const char* name, ASTNode* ast, const ScopeResolver& resolver, int runs, const std::string& expected, double tree) {
+	std::ostringstream out;
+	double compile = Bench::best(runs, [&] {
+		Compiler compiler;
+		auto program = compiler.compile(ast, resolver);
+		Bench::keep(program);
+	});
+
+	Compiler compiler;
+	auto program = compiler.compile(ast, resolver);
+	Engine engine(program);
+	engine.setOutput(out);
+	double run = Bench::best(runs, [&] {
+		out.str("");
+		if (!engine.run()) {
+			std::abort();
+		}
+	});
+	if (out.str() != expected) {
+		std::abort();
+	}
+
+	std::printf("  %-12s %12.1f us compile %12.1f us run %6.2fx\n", name, compile * 1e6, run * 1e6,
+		tree / (compile + run));
+}
+
+void bench(const char* name, const std::string& text, int runs) {
+	SourceBuffer source = SourceBuffer::fromString(text);
+	Lexer lexer(source);
+	TokenBuffer tokens = lexer.tokenizeAll();
+	ASTArena arena;
+	Parser parser(tokens, arena);
+	ASTNode* ast = parser.parse();
+
+	ConstantFolder folder(arena);
+	ast = folder.fold(ast);
+
+	ScopeResolver resolver;
+	for (const Native& native : natives()) {
+		resolver.declareGlobal(native.name);
+	}
+	resolver.resolve(ast);
+
+	std::ostringstream out;
+	TreeInterpreter interpreter(ast, resolver, out);
+	double tree = Bench::best(runs, [&] {
+		out.str("");
+		interpreter.run();
+	});
+	std::string expected = out.str();
+
+	std::printf("%s (speedup over the tree walk, compile included)\n", name);
+	std::printf("  %-12s %12.1f us compile %12.1f us run\n", "tree walk", 0.0, tree * 1e6);
+	timeEngine<ClosureCompiler, ClosureEvaluator>("closures", ast, resolver, runs, expected, tree);
+	timeEngine<BytecodeCompiler, VM>("stack VM", ast, resolver, runs, expected, tree);
+}
+
+} // namespace
+
+int main() {
+	bench("fib", "func fib(n):\n"
+		"\tif (n < 2):\n"
+		"\t\treturn n\n"
+		"\treturn fib(n - 1) + fib(n - 2)\n"
+		"print(fib(27))\n", 5);
+
+	bench("loop", "func sum(i, acc):\n"
+		"\tif (i == 0):\n"
+		"\t\treturn acc\n"
+		"\tlet x = i * 3 + (i >> 2)\n"
+		"\treturn sum(i - 1, acc + (x ^ 5) - 1.5)\n"
+		"func outer(j, acc):\n"
+		"\tif (j == 0):\n"
+		"\t\treturn acc\n"
+		"\treturn outer(j - 1, sum(1000, acc))\n"
+		"print(outer(1000, 0))\n", 5);
+
+	// Runs in about as long as it takes to compile
+	bench("short", "func area(w, h):\n"
+		"\treturn w * h\n"
+		"func describe(w, h):\n"
+		"\tif (w == h):\n"
+		"\t\tprint(\"square\", area(w, h))\n"
+		"\telse if (w > h):\n"
+		"\t\tprint(\"wide\", area(w, h))\n"
+		"\telse:\n"
+		"\t\tprint(\"tall\", area(w, h))\n"
+		"describe(3, 3)\n"
+		"describe(4, 2)\n"
+		"describe(1, 5)\n", 2000);
+
+	return 0;
+}
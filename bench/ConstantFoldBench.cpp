@@ -0,0 +1,85 @@
+// Folds a generated program whose literals are written as constant
+// expressions, like 255 as (1 << 8) - 1, and reports the time the pass takes
+// and the nodes it takes out. The size of the program in megabytes can be
+// given on the command line, the default is 16.
+
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <utility>
+
+#include "Bench.hpp"
+#include "AST/ASTArena.hpp"
+#include "AST/ASTWalker.hpp"
+#include "Lexer/Lexer.hpp"
+#include "Lexer/TokenBuffer.hpp"
+#include "Optimizer/ConstantFolder.hpp"
+#include "Parser/Parser.hpp"
+#include "Source/SourceBuffer.hpp"
+
+using namespace Nitro;
+
+namespace {
+
+struct NodeCounter : ASTWalker<NodeCounter> {
+	template <typename Node>
+	bool enter(Node&) {
+		count++;
+		return true;
+	}
+
+	std::size_t count = 0;
+};
+
+void replaceAll(std::string& text, const std::string& from, const std::string& to) {
+	std::string result;
+	result.reserve(text.size() * 2);
+	std::size_t at = 0;
+	for (std::size_t found; (found = text.find(from, at)) != std::string::npos; at = found + from.size()) {
+		result.append(text, at, found - at);
+		result += to;
+	}
+	result.append(text, at, std::string::npos);
+	text = std::move(result);
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+	std::size_t megabytes = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 16;
+	constexpr int runs = 5;
+
+	std::string text = Bench::program(megabytes << 20);
+	replaceAll(text, "255", "((1 << 8) - 1)");
+	replaceAll(text, "42.5", "(85 / 2.0 * 1)");
+	replaceAll(text, "- 2)", "- (4 - 2))");
+	replaceAll(text, "(count >= 10", "(false && count >= 10");
+
+	SourceBuffer source = SourceBuffer::fromString(text);
+	Lexer lexer(source);
+	TokenBuffer tokens = lexer.tokenizeAll();
+
+	std::size_t nodes = 0;
+	std::size_t eliminated = 0;
+	double time = 0.0;
+	for (int i = 0; i < runs; i++) {
+		ASTArena arena;
+		Parser parser(tokens, arena);
+		ASTNode* program = parser.parse();
+
+		NodeCounter counter;
+		counter.walk(program);
+		nodes = counter.count;
+
+		ConstantFolder folder(arena);
+		double run = Bench::best(1, [&] { Bench::keep(folder.fold(program)); });
+		time = i == 0 || run < time ? run : time;
+		eliminated = folder.eliminated();
+	}
+
+	std::printf("%zu bytes, %zu nodes\n", source.size(), nodes);
+	Bench::report("ConstantFolder::fold", time, static_cast<double>(nodes), "node");
+	std::printf("%-28s %10zu nodes eliminated (%.1f%%)\n", "", eliminated, 100.0 * static_cast<double>(eliminated) / static_cast<double>(nodes));
+
+	return 0;
+}
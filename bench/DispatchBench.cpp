@@ -0,0 +1,126 @@
+// Times both VMs on branch-heavy scripts, with the dispatch strategy the
+// library was built with (NITRO_DISPATCH). Build once per strategy to
+// compare them. The VMs are built with NITRO_COUNT_DISPATCHES here, so the
+// times include counting.
+
+#include <cstdio>
+#include <cstdlib>
+#include <sstream>
+#include <string>
+
+#include "Bench.hpp"
+#include "AST/ASTArena.hpp"
+#include "Lexer/Lexer.hpp"
+#include "Lexer/TokenBuffer.hpp"
+#include "Optimizer/ConstantFolder.hpp"
+#include "Parser/Parser.hpp"
+#include "Semantic/ScopeResolver.hpp"
+#include "Source/SourceBuffer.hpp"
+#include "VM/BytecodeCompiler.hpp"
+#include "VM/Dispatch.hpp"
+#include "VM/Natives.hpp"
+#include "VM/RegisterCompiler.hpp"
+#include "VM/RegisterVM.hpp"
+#include "VM/VM.hpp"
+
+using namespace Nitro;
+
+namespace {
+
+template <typename Compiler>
+auto compileScript(const SourceBuffer& source) {
+	Lexer lexer(source);
+	TokenBuffer tokens = lexer.tokenizeAll();
+	ASTArena arena;
+	Parser parser(tokens, arena);
+	ASTNode* ast = parser.parse();
+
+	ConstantFolder folder(arena);
+	ast = folder.fold(ast);
+
+	ScopeResolver resolver;
+	for (const Native& native : natives()) {
+		resolver.declareGlobal(native.name);
+	}
+	resolver.resolve(ast);
+
+	Compiler compiler;
+	return compiler.compile(ast, resolver);
+}
+
+template <typename Engine, typename Program>
+void runEngine(const char* name, const Program& program) {
+	constexpr int runs = 5;
+
+	Engine vm(program);
+	std::ostringstream out;
+	vm.setOutput(out);
+	double time = Bench::best(runs, [&] {
+		out.str("");
+		if (!vm.run()) {
+			std::abort();
+		}
+	});
+
+	Bench::report(name, time, static_cast<double>(vm.dispatches()), "dispatch");
+}
+
+void bench(const char* name, const std::string& text) {
+	SourceBuffer source = SourceBuffer::fromString(text);
+	Program stack = compileScript<BytecodeCompiler>(source);
+	RegisterProgram registers = compileScript<RegisterCompiler>(source);
+
+	std::printf("%s\n", name);
+	runEngine<VM>("  stack", stack);
+	runEngine<RegisterVM>("  register", registers);
+}
+
+} // namespace
+
+int main() {
+	std::printf("dispatch: %s\n", DISPATCH_STRATEGY);
+
+	// Data dependent branches, taken about half of the time
+	bench("collatz", "func steps(n, count):\n"
+		"\tif (n == 1):\n"
+		"\t\treturn count\n"
+		"\tif ((n & 1) == 1):\n"
+		"\t\treturn steps(3 * n + 1, count + 1)\n"
+		"\treturn steps(n >> 1, count + 1)\n"
+		"func total(i, acc):\n"
+		"\tif (i == 0):\n"
+		"\t\treturn acc\n"
+		"\treturn total(i - 1, acc + steps(i, 0))\n"
+		"print(total(3000, 0))\n");
+
+	// A chain of conditions over scrambled bits
+	bench("classify", "func kind(x):\n"
+		"\tlet low = x & 15\n"
+		"\tif (low < 3):\n"
+		"\t\treturn 1\n"
+		"\telse if (low == 5 || low == 9):\n"
+		"\t\treturn 2\n"
+		"\telse if (low > 12 && (x & 64) == 0):\n"
+		"\t\treturn 3\n"
+		"\telse if (!(low != 7) || (x & 256) == 256):\n"
+		"\t\treturn 4\n"
+		"\telse:\n"
+		"\t\treturn 5\n"
+		"func run(i, acc):\n"
+		"\tif (i == 0):\n"
+		"\t\treturn acc\n"
+		"\treturn run(i - 1, acc + kind((i * 7919) >> 3))\n"
+		"func outer(j, acc):\n"
+		"\tif (j == 0):\n"
+		"\t\treturn acc\n"
+		"\treturn outer(j - 1, run(1000, acc))\n"
+		"print(outer(1000, 0))\n");
+
+	bench("fib", "func fib(n):\n"
+		"\tif (n < 2):\n"
+		"\t\treturn n\n"
+		"\treturn fib(n - 1) + fib(n - 2)\n"
+		"print(fib(27))\n");
+
+	return 0;
+}
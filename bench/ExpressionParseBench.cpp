@@ -0,0 +1,87 @@
+// Times the parser on expression heavy programs: one made of long random
+// expressions over every operator, and one of single literals, where the
+// cost is mostly getting from the statement down to the primary. The size
+// of each program in kilobytes can be given on the command line, the
+// default is 1024.
+
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <string>
+
+#include "Bench.hpp"
+#include "AST/ASTArena.hpp"
+#include "Lexer/Lexer.hpp"
+#include "Lexer/TokenBuffer.hpp"
+#include "Parser/Parser.hpp"
+#include "Source/SourceBuffer.hpp"
+
+using namespace Nitro;
+
+namespace {
+
+std::string expressions(std::size_t size) {
+	static const char* const operators[] = {
+		" + ", " - ", " * ", " / ", " ** ", " > ", " >= ", " >> ", " < ", " <= ",
+		" << ", " == ", " != ", " & ", " | ", " ^ ", " && ", " || ",
+	};
+	static const char* const operands[] = {
+		"a", "total", "42", "2.5", "true", "nil", "'c'", "\"text\"",
+		"-x", "!done", "~mask", "f(a, 1)", "(b + c)",
+	};
+	constexpr std::size_t operator_count = sizeof(operators) / sizeof(operators[0]);
+	constexpr std::size_t operand_count = sizeof(operands) / sizeof(operands[0]);
+
+	std::mt19937 rng(5);
+	std::string program;
+	program.reserve(size + 256);
+
+	while (program.size() < size) {
+		program += operands[rng() % operand_count];
+		for (unsigned i = 0, n = 2 + rng() % 10; i < n; i++) {
+			program += operators[rng() % operator_count];
+			program += operands[rng() % operand_count];
+		}
+		program += "\n";
+	}
+
+	return program;
+}
+
+std::string literals(std::size_t size) {
+	std::string program;
+	program.reserve(size + 16);
+
+	while (program.size() < size) {
+		program += "42\n";
+	}
+
+	return program;
+}
+
+void run(const char* name, std::string text) {
+	constexpr int runs = 10;
+
+	SourceBuffer source = SourceBuffer::fromString(std::move(text));
+	Lexer lexer(source);
+	TokenBuffer tokens = lexer.tokenizeAll();
+
+	double time = Bench::best(runs, [&] {
+		ASTArena arena;
+		Parser parser(tokens, arena);
+		ASTNode* ast = parser.parse();
+		Bench::keep(ast);
+	});
+	Bench::report(name, time, static_cast<double>(tokens.size()), "token");
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+	std::size_t kilobytes = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 1024;
+
+	run("expressions", expressions(kilobytes << 10));
+	run("literals", literals(kilobytes << 10));
+
+	return 0;
+}
@@ -0,0 +1,172 @@
+// Compares the tree of ASTNodes with the FlatAST on a generated program:
+// memory per node, parse time, and the time to walk every node summing the
+// integer constants. The size of the program in kilobytes can be given on
+// the command line, the default is 4096.
+
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+
+#include "Bench.hpp"
+#include "AST/ASTArena.hpp"
+#include "AST/ASTTreeBuilder.hpp"
+#include "AST/ASTVisitor.hpp"
+#include "AST/FlatAST.hpp"
+#include "Lexer/Lexer.hpp"
+#include "Lexer/TokenBuffer.hpp"
+#include "Parser/Parser.hpp"
+#include "Source/SourceBuffer.hpp"
+
+using namespace Nitro;
+
+namespace {
+
+class SumVisitor : public ASTVisitor {
+public:
+	void visit(ASTNodeConstant<std::int64_t>& node) override { count++; sum += node.m_value; }
+	void visit(ASTNodeConstant<double>&) override { count++; }
+	void visit(ASTNodeConstant<bool>&) override { count++; }
+	void visit(ASTNodeConstant<std::string_view>&) override { count++; }
+	void visit(ASTNodeConstant<char>&) override { count++; }
+	void visit(ASTNodeNil&) override { count++; }
+
+	void visit(ASTNodeBinary& node) override {
+		count++;
+		walk(node.m_left);
+		walk(node.m_right);
+	}
+
+	void visit(ASTNodeUnary& node) override {
+		count++;
+		walk(node.m_branch);
+	}
+
+	void visit(ASTNodeVariableInvokation& node) override {
+		count++;
+		for (ASTNode* arg : node.m_args) {
+			walk(arg);
+		}
+	}
+
+	void visit(ASTNodeVariableDeclaration& node) override {
+		count++;
+		walk(node.m_assign);
+	}
+
+	void visit(ASTNodeStatementSet& node) override {
+		count++;
+		for (ASTNode* statement : node.m_statements) {
+			walk(statement);
+		}
+	}
+
+	void visit(ASTNodeConditional& node) override {
+		count++;
+		for (auto& condition : node.m_conditions) {
+			walk(condition.first);
+			walk(condition.second);
+		}
+		walk(node.m_else_statement);
+	}
+
+	void visit(ASTNodeFunctionDefinition& node) override {
+		count++;
+		walk(node.m_contents);
+	}
+
+	void visit(ASTNodeFunctionReturn& node) override {
+		count++;
+		walk(node.m_expr);
+	}
+
+	std::size_t count = 0;
+	std::int64_t sum = 0;
+
+private:
+	void walk(ASTNode* node) {
+		if (node) {
+			node->visit(*this);
+		}
+	}
+};
+
+void flatWalk(const FlatAST& ast, FlatAST::Index index, std::size_t& count, std::int64_t& sum) {
+	count++;
+	if (ast.kind(index) == ASTKind::Int64) {
+		sum += ast.int64(index);
+	}
+	ast.forEachChild(index, [&](FlatAST::Index child) {
+		flatWalk(ast, child, count, sum);
+	});
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+	std::size_t kilobytes = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 4096;
+	constexpr int runs = 5;
+
+	SourceBuffer source = SourceBuffer::fromString(Bench::program(kilobytes << 10));
+	Lexer lexer(source);
+	TokenBuffer tokens = lexer.tokenizeAll();
+
+	ASTArena arena;
+	ASTNode* root = Parser(tokens, arena).parse();
+	FlatAST flat(tokens.source());
+	FlatParser(tokens, flat).parse();
+
+	double nodes = static_cast<double>(flat.size());
+	std::printf("%zu bytes, %zu nodes\n", source.size(), flat.size());
+	std::printf("%-28s %10.1f bytes/node\n", "tree", static_cast<double>(arena.bytesUsed()) / nodes);
+	std::printf("%-28s %10.1f bytes/node\n", "flat", static_cast<double>(flat.memoryUsage()) / nodes);
+
+	double time = Bench::best(runs, [&] {
+		ASTArena arena;
+		ASTNode* ast = Parser(tokens, arena).parse();
+		Bench::keep(ast);
+	});
+	Bench::report("parse, tree", time, nodes, "node");
+
+	time = Bench::best(runs, [&] {
+		FlatAST ast(tokens.source());
+		FlatParser(tokens, ast).parse();
+		Bench::keep(ast);
+	});
+	Bench::report("parse, flat", time, nodes, "node");
+
+	std::int64_t expected = 0;
+	time = Bench::best(runs, [&] {
+		SumVisitor visitor;
+		root->visit(visitor);
+		expected = visitor.sum;
+		Bench::keep(visitor.sum);
+	});
+	Bench::report("walk, tree visitor", time, nodes, "node");
+
+	time = Bench::best(runs, [&] {
+		std::size_t count = 0;
+		std::int64_t sum = 0;
+		flatWalk(flat, flat.root(), count, sum);
+		Bench::keep(sum);
+	});
+	Bench::report("walk, flat recursive", time, nodes, "node");
+
+	std::int64_t sum = 0;
+	time = Bench::best(runs, [&] {
+		sum = 0;
+		for (FlatAST::Index i = 0; i < flat.size(); i++) {
+			if (flat.kind(i) == ASTKind::Int64) {
+				sum += flat.int64(i);
+			}
+		}
+		Bench::keep(sum);
+	});
+	Bench::report("walk, flat in order", time, nodes, "node");
+
+	if (sum != expected) {
+		std::printf("Sums differ\n");
+		return 1;
+	}
+
+	return 0;
+}
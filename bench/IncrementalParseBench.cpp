@@ -0,0 +1,66 @@
+// Edits a line in the middle of a generated program, back and forth, and
+// compares IncrementalParser::update() with parsing the whole edited source
+// again. The size of the program in kilobytes can be given on the command
+// line, the default is 4096.
+
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+
+#include "Bench.hpp"
+#include "AST/ASTArena.hpp"
+#include "Lexer/Lexer.hpp"
+#include "Lexer/StringInterner.hpp"
+#include "Parser/IncrementalParser.hpp"
+#include "Parser/Parser.hpp"
+#include "Source/SourceBuffer.hpp"
+
+using namespace Nitro;
+
+int main(int argc, char** argv) {
+	std::size_t kilobytes = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 4096;
+	constexpr int runs = 5;
+	constexpr int edits = 20;
+
+	std::string text = Bench::program(kilobytes << 10);
+
+	// Adds a statement at the start of a function body halfway in
+	std::size_t at = text.find("func ", text.size() / 2);
+	at = text.find('\n', at) + 1;
+	const std::string line = "\tlet inserted = a + 1\n";
+
+	std::string edited = text;
+	edited.insert(at, line);
+
+	SourceBuffer before = SourceBuffer::fromString(text);
+	SourceBuffer after = SourceBuffer::fromString(edited);
+	const IncrementalParser::Edit insert{ at, at, at + line.size() };
+	const IncrementalParser::Edit remove{ at, at + line.size(), at };
+
+	StringInterner interner;
+	IncrementalParser parser(before, &interner);
+	std::printf("%zu bytes, %zu items\n", before.size(), parser.itemCount());
+
+	double full_time = Bench::best(runs, [&] {
+		for (int i = 0; i < edits; i++) {
+			const SourceBuffer& source = i % 2 ? before : after;
+			Lexer lexer(source);
+			lexer.setInterner(&interner);
+			ASTArena arena;
+			Parser full(lexer, arena);
+			Bench::keep(full.parse());
+		}
+	});
+	Bench::report("Parser::parse", full_time, edits, "edit");
+
+	double incremental_time = Bench::best(runs, [&] {
+		for (int i = 0; i < edits; i++) {
+			Bench::keep(i % 2 ? parser.update(before, remove) : parser.update(after, insert));
+		}
+	});
+	Bench::report("IncrementalParser::update", incremental_time, edits, "edit");
+	std::printf("%-28s %10zu bytes re-parsed per edit\n", "", parser.reparsed());
+	std::printf("%-28s %10.2fx\n", "", full_time / incremental_time);
+
+	return 0;
+}
@@ -0,0 +1,112 @@
+// Compares the perfect hash keyword lookup with the first character switch
+// it replaced, on an identifier heavy word list.
+
+#include <cstdio>
+#include <random>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "Bench.hpp"
+#include "Lexer/Keywords.hpp"
+
+using namespace Nitro;
+
+namespace {
+
+Token::Type checkKeyword(std::string_view word, std::size_t start, std::size_t length, std::string_view rest, Token::Type type) {
+	if (word.size() == start + length && word.substr(start, length) == rest) {
+		return type;
+	}
+
+	return Token::Type::Identifier;
+}
+
+// The hand written switch Lexer::identifierOrKeywordType used to be
+Token::Type switchLookup(std::string_view word) {
+	switch (word[0]) {
+		case 'b': return checkKeyword(word, 1, 4, "reak", Token::Type::BreakKeyword);
+		case 'c': return checkKeyword(word, 1, 7, "ontinue", Token::Type::ContinueKeyword);
+		case 'e': return checkKeyword(word, 1, 3, "lse", Token::Type::ElseKeyword);
+		case 'f': {
+			if (word.size() > 1) {
+				switch (word[1]) {
+					case 'a': return checkKeyword(word, 2, 3, "lse", Token::Type::FalseKeyword);
+					case 'u': return checkKeyword(word, 2, 2, "nc", Token::Type::FuncKeyword);
+					case 'o': return checkKeyword(word, 2, 1, "r", Token::Type::ForKeyword);
+				}
+			}
+		} break;
+		case 'i': return checkKeyword(word, 1, 1, "f", Token::Type::IfKeyword);
+		case 'l': return checkKeyword(word, 1, 2, "et", Token::Type::LetKeyword);
+		case 'n': return checkKeyword(word, 1, 2, "il", Token::Type::NilKeyword);
+		case 'r': return checkKeyword(word, 1, 5, "eturn", Token::Type::ReturnKeyword);
+		case 't': return checkKeyword(word, 1, 3, "rue", Token::Type::TrueKeyword);
+		case 'w': return checkKeyword(word, 1, 4, "hile", Token::Type::WhileKeyword);
+	}
+
+	return Token::Type::Identifier;
+}
+
+std::vector<std::string> makeWords(std::size_t count) {
+	// Identifiers that share prefixes with keywords are the expensive case
+	// for the switch, so they are heavily represented.
+	static const char* const pool[] = {
+		"if", "else", "while", "for", "continue", "break", "return", "func",
+		"let", "true", "false", "nil",
+		"fore", "format", "fun", "function", "fa", "f", "forward", "iff",
+		"index", "returned", "ret", "letter", "lettuce", "node", "nil_",
+		"truth", "tree", "whiled", "width", "elsewhere", "counter", "brk",
+		"x", "y", "value", "total", "buffer", "_tmp", "result", "acc",
+	};
+	constexpr std::size_t pool_size = sizeof(pool) / sizeof(pool[0]);
+
+	std::mt19937 rng(42);
+	std::vector<std::string> words;
+	words.reserve(count);
+	for (std::size_t i = 0; i < count; i++) {
+		words.emplace_back(pool[rng() % pool_size]);
+	}
+	return words;
+}
+
+} // namespace
+
+int main() {
+	constexpr std::size_t count = 1 << 20;
+	constexpr int runs = 15;
+
+	std::vector<std::string> owned = makeWords(count);
+	std::vector<std::string_view> words(owned.begin(), owned.end());
+
+	for (std::string_view word : words) {
+		if (switchLookup(word) != Keywords::lookup(word)) {
+			std::printf("Mismatch on \"%.*s\"\n", static_cast<int>(word.size()), word.data());
+			return 1;
+		}
+	}
+
+	std::printf("%zu words, %zu keywords, hash seed %u\n",
+		count, sizeof(Keywords::KEYWORDS) / sizeof(Keywords::KEYWORDS[0]), Keywords::SEED);
+
+	double switch_time = Bench::best(runs, [&] {
+		unsigned keywords = 0;
+		for (std::string_view word : words) {
+			keywords += switchLookup(word) != Token::Type::Identifier;
+		}
+		Bench::keep(keywords);
+	});
+
+	double hash_time = Bench::best(runs, [&] {
+		unsigned keywords = 0;
+		for (std::string_view word : words) {
+			keywords += Keywords::lookup(word) != Token::Type::Identifier;
+		}
+		Bench::keep(keywords);
+	});
+
+	Bench::report("switch", switch_time, count, "word");
+	Bench::report("perfect hash", hash_time, count, "word");
+
+	return 0;
+}
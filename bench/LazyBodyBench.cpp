@@ -0,0 +1,71 @@
+// Parses a generated program eagerly and with lazy function bodies, then
+// parses one body in ten on demand, as a run that calls a tenth of the
+// functions would. Reports time and arena memory. The size of the program
+// in megabytes can be given on the command line, the default is 16.
+
+#include <cstdio>
+#include <cstdlib>
+
+#include "Bench.hpp"
+#include "AST/ASTArena.hpp"
+#include "AST/ASTNodeFunctionDefinition.hpp"
+#include "AST/ASTNodeStatementSet.hpp"
+#include "Lexer/Lexer.hpp"
+#include "Lexer/TokenBuffer.hpp"
+#include "Parser/Parser.hpp"
+#include "Source/SourceBuffer.hpp"
+
+using namespace Nitro;
+
+int main(int argc, char** argv) {
+	std::size_t megabytes = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 16;
+	constexpr int runs = 5;
+
+	SourceBuffer source = SourceBuffer::fromString(Bench::program(megabytes << 20));
+	Lexer lexer(source);
+	TokenBuffer tokens = lexer.tokenizeAll();
+	std::printf("%zu bytes, %zu tokens\n", source.size(), tokens.size());
+
+	std::size_t eager_bytes = 0;
+	double eager_time = Bench::best(runs, [&] {
+		ASTArena arena;
+		Parser parser(tokens, arena);
+		Bench::keep(parser.parse());
+		eager_bytes = arena.bytesUsed();
+	});
+	Bench::report("eager parse", eager_time, static_cast<double>(tokens.size()), "token");
+
+	std::size_t lazy_bytes = 0;
+	double lazy_time = Bench::best(runs, [&] {
+		ASTArena arena;
+		Parser parser(tokens, arena);
+		parser.setLazyBodies(true);
+		Bench::keep(parser.parse());
+		lazy_bytes = arena.bytesUsed();
+	});
+	Bench::report("lazy parse", lazy_time, static_cast<double>(tokens.size()), "token");
+
+	std::size_t tenth_bytes = 0;
+	double tenth_time = Bench::best(runs, [&] {
+		ASTArena arena;
+		Parser parser(tokens, arena);
+		parser.setLazyBodies(true);
+		auto* program = static_cast<ASTNodeStatementSet*>(parser.parse());
+
+		std::size_t i = 0;
+		for (ASTNode* node : program->m_statements) {
+			if (node->m_kind == ASTKind::FunctionDefinition && i++ % 10 == 0) {
+				Bench::keep(functionBody(*static_cast<ASTNodeFunctionDefinition*>(node), tokens, arena));
+			}
+		}
+		tenth_bytes = arena.bytesUsed();
+	});
+	Bench::report("lazy, a tenth of bodies", tenth_time, static_cast<double>(tokens.size()), "token");
+
+	std::printf("\n%-28s %10s %14s\n", "", "time", "arena bytes");
+	std::printf("%-28s %9.2fx %14zu\n", "eager", 1.0, eager_bytes);
+	std::printf("%-28s %9.2fx %14zu\n", "lazy", lazy_time / eager_time, lazy_bytes);
+	std::printf("%-28s %9.2fx %14zu\n", "lazy, a tenth of bodies", tenth_time / eager_time, tenth_bytes);
+
+	return 0;
+}
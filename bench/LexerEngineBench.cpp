@@ -0,0 +1,108 @@
+// Compares the throughput of the direct (hand written) and table driven
+// lexer engines on a few kinds of input. Both engines must agree on every
+// token.
+
+#include <cstdio>
+#include <random>
+#include <string>
+
+#include "Bench.hpp"
+#include "Lexer/Lexer.hpp"
+#include "Source/SourceBuffer.hpp"
+
+using namespace Nitro;
+
+namespace {
+
+std::size_t countTokens(const SourceBuffer& source, Lexer::Engine engine) {
+	Lexer lexer(source, engine);
+	std::size_t count = 0;
+	for (;;) {
+		Token token = lexer.next();
+		count++;
+		Bench::keep(token);
+		if (token.type == Token::Type::Eof || token.type == Token::Type::Error) {
+			return count;
+		}
+	}
+}
+
+bool sameTokens(const SourceBuffer& source) {
+	Lexer direct(source, Lexer::Engine::Direct);
+	Lexer table(source, Lexer::Engine::Table);
+	for (;;) {
+		Token a = direct.next();
+		Token b = table.next();
+		if (a.type != b.type || a.lexeme != b.lexeme || a.line != b.line || a.col != b.col) {
+			return false;
+		}
+		if (a.type == Token::Type::Eof || a.type == Token::Type::Error) {
+			return true;
+		}
+	}
+}
+
+// Long identifiers and string literals, the best case for the vectorized
+// scans of the direct engine
+std::string makeWords(std::size_t size) {
+	std::mt19937 rng(11);
+	std::string text;
+	while (text.size() < size) {
+		text += "let some_rather_long_identifier_";
+		text += std::to_string(rng() % 1000);
+		text += " = \"a string literal with a few words in it\"\n";
+	}
+	return text;
+}
+
+// Short tokens with barely any space between them
+std::string makeOperators(std::size_t size) {
+	static const char* const pieces[] = { "a", "+", "b1", "**", "(", ")", "<=", "7", "&&", "x", "!=", ",", "25", "|" };
+	constexpr std::size_t piece_count = sizeof(pieces) / sizeof(pieces[0]);
+
+	std::mt19937 rng(13);
+	std::string text;
+	while (text.size() < size) {
+		for (int i = 0; i < 20; i++) {
+			text += pieces[rng() % piece_count];
+		}
+		text += "\n";
+	}
+	return text;
+}
+
+} // namespace
+
+int main() {
+	constexpr std::size_t size = 8 << 20;
+	constexpr int runs = 7;
+
+	struct Input {
+		const char* name;
+		std::string text;
+	} inputs[] = {
+		{ "script", Bench::script(size) },
+		{ "words", makeWords(size) },
+		{ "operators", makeOperators(size) },
+	};
+
+	for (const Input& input : inputs) {
+		SourceBuffer source = SourceBuffer::fromString(input.text);
+		if (!sameTokens(source)) {
+			std::printf("Engines disagree on %s\n", input.name);
+			return 1;
+		}
+
+		std::size_t tokens = countTokens(source, Lexer::Engine::Direct);
+		std::printf("%s: %zu bytes, %zu tokens\n", input.name, source.size(), tokens);
+
+		double direct_time = Bench::best(runs, [&] { countTokens(source, Lexer::Engine::Direct); });
+		double table_time = Bench::best(runs, [&] { countTokens(source, Lexer::Engine::Table); });
+
+		Bench::report("  direct", direct_time, static_cast<double>(source.size()), "byte");
+		Bench::report("  table", table_time, static_cast<double>(source.size()), "byte");
+		std::printf("  %.1f / %.1f MB/s\n", source.size() / direct_time / 1e6, source.size() / table_time / 1e6);
+	}
+
+	return 0;
+}
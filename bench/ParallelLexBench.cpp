@@ -0,0 +1,55 @@
+// Tokenizes a generated script serially and with ParallelLexer on 1, 2, 4, ...
+// threads, up to the number of hardware threads. The size of the script in
+// megabytes can be given on the command line, the default is 50.
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+
+#include "Bench.hpp"
+#include "Lexer/Lexer.hpp"
+#include "Lexer/ParallelLexer.hpp"
+#include "Lexer/TokenBuffer.hpp"
+#include "Source/SourceBuffer.hpp"
+
+using namespace Nitro;
+
+int main(int argc, char** argv) {
+	std::size_t megabytes = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 50;
+	constexpr int runs = 5;
+
+	SourceBuffer source = SourceBuffer::fromString(Bench::script(megabytes << 20));
+
+	Lexer reference_lexer(source);
+	TokenBuffer reference = reference_lexer.tokenizeAll();
+	std::printf("%zu bytes, %zu tokens\n", source.size(), reference.size());
+
+	double serial_time = Bench::best(runs, [&] {
+		Lexer lexer(source);
+		TokenBuffer tokens = lexer.tokenizeAll();
+		Bench::keep(tokens);
+	});
+	Bench::report("Lexer::tokenizeAll", serial_time, static_cast<double>(source.size()), "byte");
+
+	unsigned hardware = std::max(1u, std::thread::hardware_concurrency());
+	for (unsigned threads = 1; threads <= hardware; threads *= 2) {
+		ParallelLexer lexer(source, threads);
+		if (lexer.tokenizeAll().size() != reference.size()) {
+			std::printf("Token count mismatch on %u threads\n", threads);
+			return 1;
+		}
+
+		double time = Bench::best(runs, [&] {
+			TokenBuffer tokens = lexer.tokenizeAll();
+			Bench::keep(tokens);
+		});
+
+		char name[64];
+		std::snprintf(name, sizeof(name), "ParallelLexer, %u threads", threads);
+		Bench::report(name, time, static_cast<double>(source.size()), "byte");
+		std::printf("%-28s %10.2fx\n", "", serial_time / time);
+	}
+
+	return 0;
+}
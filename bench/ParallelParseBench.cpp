@@ -0,0 +1,84 @@
+// Parses a generated program of thousands of functions serially and with
+// ParallelParser on 1, 2, 4, ... threads, up to the number of hardware
+// threads. The size of the program in megabytes and the most threads to try
+// can be given on the command line, the defaults are 16 and the number of
+// hardware threads.
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <sstream>
+#include <string>
+#include <thread>
+
+#include "Bench.hpp"
+#include "AST/ASTArena.hpp"
+#include "AST/ASTNodeStatementSet.hpp"
+#include "AST/ASTPrettyPrinter.hpp"
+#include "Lexer/Lexer.hpp"
+#include "Lexer/TokenBuffer.hpp"
+#include "Parser/ParallelParser.hpp"
+#include "Parser/Parser.hpp"
+#include "Source/SourceBuffer.hpp"
+
+using namespace Nitro;
+
+namespace {
+
+std::string print(ASTNode* program) {
+	std::ostringstream out;
+	ASTPrettyPrinter printer(out);
+	printer.walk(program);
+	return out.str();
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+	std::size_t megabytes = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 16;
+	unsigned max_threads = argc > 2 ? static_cast<unsigned>(std::strtoul(argv[2], nullptr, 10))
+		: std::max(1u, std::thread::hardware_concurrency());
+	constexpr int runs = 5;
+
+	SourceBuffer source = SourceBuffer::fromString(Bench::program(megabytes << 20));
+	Lexer lexer(source);
+	TokenBuffer tokens = lexer.tokenizeAll();
+
+	ASTArena reference_arena;
+	Parser reference_parser(tokens, reference_arena);
+	ASTNode* reference = reference_parser.parse();
+	std::string reference_text = print(reference);
+	std::printf("%zu bytes, %zu tokens, %zu functions, %u hardware threads\n", source.size(), tokens.size(),
+		static_cast<ASTNodeStatementSet*>(reference)->m_statements.size(), std::thread::hardware_concurrency());
+
+	double serial_time = Bench::best(runs, [&] {
+		ASTArena arena;
+		Parser parser(tokens, arena);
+		Bench::keep(parser.parse());
+	});
+	Bench::report("Parser::parse", serial_time, static_cast<double>(tokens.size()), "token");
+
+	for (unsigned threads = 1; threads <= max_threads; threads *= 2) {
+		{
+			ASTArena arena;
+			ParallelParser parser(tokens, arena, threads);
+			if (print(parser.parse()) != reference_text) {
+				std::printf("Tree mismatch on %u threads\n", threads);
+				return 1;
+			}
+		}
+
+		double time = Bench::best(runs, [&] {
+			ASTArena arena;
+			ParallelParser parser(tokens, arena, threads);
+			Bench::keep(parser.parse());
+		});
+
+		char name[64];
+		std::snprintf(name, sizeof(name), "ParallelParser, %u threads", threads);
+		Bench::report(name, time, static_cast<double>(tokens.size()), "token");
+		std::printf("%-28s %10.2fx\n", "", serial_time / time);
+	}
+
+	return 0;
+}
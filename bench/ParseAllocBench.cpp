@@ -0,0 +1,70 @@
+// Counts the heap allocations made while parsing a generated program and
+// freeing its tree, and times both. The source is tokenized beforehand, so
+// only the parser's allocations are counted. The size of the program in
+// kilobytes can be given on the command line, the default is 1024.
+
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+
+#include "Bench.hpp"
+#include "Lexer/Lexer.hpp"
+#include "Lexer/TokenBuffer.hpp"
+#include "AST/ASTArena.hpp"
+#include "Parser/Parser.hpp"
+#include "Source/SourceBuffer.hpp"
+
+namespace {
+
+std::size_t allocations = 0;
+
+} // namespace
+
+void* operator new(std::size_t size) {
+	allocations++;
+	if (void* memory = std::malloc(size ? size : 1)) {
+		return memory;
+	}
+	throw std::bad_alloc();
+}
+
+void operator delete(void* memory) noexcept {
+	std::free(memory);
+}
+
+void operator delete(void* memory, std::size_t) noexcept {
+	std::free(memory);
+}
+
+using namespace Nitro;
+
+int main(int argc, char** argv) {
+	std::size_t kilobytes = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 1024;
+	constexpr int runs = 5;
+
+	SourceBuffer source = SourceBuffer::fromString(Bench::program(kilobytes << 10));
+	Lexer lexer(source);
+	TokenBuffer tokens = lexer.tokenizeAll();
+	double kb = static_cast<double>(source.size()) / 1024.0;
+	std::printf("%zu bytes, %zu tokens\n", source.size(), tokens.size());
+
+	std::size_t before = allocations;
+	{
+		ASTArena arena;
+		Parser parser(tokens, arena);
+		ASTNode* ast = parser.parse();
+		Bench::keep(ast);
+	}
+	std::size_t count = allocations - before;
+	std::printf("%-28s %10zu %10.1f per KB\n", "allocations", count, static_cast<double>(count) / kb);
+
+	double time = Bench::best(runs, [&] {
+		ASTArena arena;
+		Parser parser(tokens, arena);
+		ASTNode* ast = parser.parse();
+		Bench::keep(ast);
+	});
+	Bench::report("parse and free", time, static_cast<double>(source.size()), "byte");
+
+	return 0;
+}
@@ -0,0 +1,129 @@
+// Runs the same scripts on the stack VM and on the register VM, reporting
+// the instructions each one dispatches and how long each takes. fib's
+// argument can be given on the command line, the default is 27. The VMs
+// are built with NITRO_COUNT_DISPATCHES here, so the times include
+// counting.
+
+#include <cstdio>
+#include <cstdlib>
+#include <sstream>
+#include <string>
+
+#include "Bench.hpp"
+#include "AST/ASTArena.hpp"
+#include "Lexer/Lexer.hpp"
+#include "Lexer/TokenBuffer.hpp"
+#include "Optimizer/ConstantFolder.hpp"
+#include "Parser/Parser.hpp"
+#include "Semantic/ScopeResolver.hpp"
+#include "Source/SourceBuffer.hpp"
+#include "VM/BytecodeCompiler.hpp"
+#include "VM/Natives.hpp"
+#include "VM/RegisterCompiler.hpp"
+#include "VM/RegisterVM.hpp"
+#include "VM/VM.hpp"
+
+using namespace Nitro;
+
+namespace {
+
+template <typename Compiler>
+auto compileScript(const SourceBuffer& source) {
+	Lexer lexer(source);
+	TokenBuffer tokens = lexer.tokenizeAll();
+	ASTArena arena;
+	Parser parser(tokens, arena);
+	ASTNode* ast = parser.parse();
+
+	ConstantFolder folder(arena);
+	ast = folder.fold(ast);
+
+	ScopeResolver resolver;
+	for (const Native& native : natives()) {
+		resolver.declareGlobal(native.name);
+	}
+	resolver.resolve(ast);
+
+	Compiler compiler;
+	return compiler.compile(ast, resolver);
+}
+
+template <typename Engine, typename Program>
+std::string runEngine(const char* name, const Program& program, double items, const char* unit) {
+	constexpr int runs = 5;
+
+	Engine vm(program);
+	std::ostringstream out;
+	vm.setOutput(out);
+	double time = Bench::best(runs, [&] {
+		out.str("");
+		if (!vm.run()) {
+			std::abort();
+		}
+	});
+
+	Bench::report(name, time, items, unit);
+	std::printf("%-28s %10.1f M    %10.2f per %s\n", "    dispatches", vm.dispatches() / 1e6, vm.dispatches() / items, unit);
+	return out.str();
+}
+
+void bench(const char* name, const std::string& text, double items, const char* unit) {
+	SourceBuffer source = SourceBuffer::fromString(text);
+	Program stack = compileScript<BytecodeCompiler>(source);
+	RegisterProgram registers = compileScript<RegisterCompiler>(source);
+
+	std::printf("%s\n", name);
+	std::string stack_out = runEngine<VM>("  stack", stack, items, unit);
+	std::string register_out = runEngine<RegisterVM>("  register", registers, items, unit);
+	if (stack_out != register_out) {
+		std::printf("  outputs differ: %s vs %s", stack_out.c_str(), register_out.c_str());
+		std::abort();
+	}
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+	long n = argc > 1 ? std::strtol(argv[1], nullptr, 10) : 27;
+
+	// fib(n) makes 2 fib(n + 1) - 1 calls
+	double a = 0, b = 1;
+	for (long i = 0; i < n; i++) {
+		double next = a + b;
+		a = b;
+		b = next;
+	}
+	double fib_calls = 2 * b - 1;
+
+	bench("fib", "func fib(n):\n"
+		"\tif (n < 2):\n"
+		"\t\treturn n\n"
+		"\treturn fib(n - 1) + fib(n - 2)\n"
+		"print(fib(" + std::to_string(n) + "))\n", fib_calls, "call");
+
+	bench("loop", "func inner(i, acc):\n"
+		"\tif (i == 0):\n"
+		"\t\treturn acc\n"
+		"\treturn inner(i - 1, acc + i * 3 - (i & 7) + (i >> 2) * 2)\n"
+		"func outer(j, acc):\n"
+		"\tif (j == 0):\n"
+		"\t\treturn acc\n"
+		"\treturn outer(j - 1, inner(1000, acc))\n"
+		"print(outer(1000, 0))\n", 1e6, "iteration");
+
+	// Locals, which the register VM reads in place
+	bench("locals", "func inner(i, x):\n"
+		"\tif (i == 0):\n"
+		"\t\treturn x\n"
+		"\tlet a = x * 0.5\n"
+		"\tlet b = a + 1.25 / (x + 2.0)\n"
+		"\tlet c = b - a * 0.125\n"
+		"\treturn inner(i - 1, c)\n"
+		"func outer(j, x):\n"
+		"\tif (j == 0):\n"
+		"\t\treturn x\n"
+		"\treturn outer(j - 1, inner(1000, x))\n"
+		"print(outer(1000, 1.0))\n", 1e6, "iteration");
+
+	return 0;
+}
@@ -0,0 +1,115 @@
+// Resolves the variables of a generated program, then reads every variable
+// use once by name from a hash table, as an executor without the pass
+// would, and once by its slot. The size of the program in megabytes can be
+// given on the command line, the default is 16.
+
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <ostream>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "Bench.hpp"
+#include "AST/ASTArena.hpp"
+#include "AST/ASTWalker.hpp"
+#include "Lexer/Lexer.hpp"
+#include "Lexer/StringInterner.hpp"
+#include "Lexer/TokenBuffer.hpp"
+#include "Parser/Parser.hpp"
+#include "Semantic/ScopeResolver.hpp"
+#include "Source/SourceBuffer.hpp"
+
+using namespace Nitro;
+
+namespace {
+
+struct Uses : ASTWalker<Uses> {
+	using ASTWalker<Uses>::enter;
+
+	bool enter(ASTNodeVariableInvokation& node) {
+		nodes.push_back(&node);
+		return true;
+	}
+
+	std::vector<ASTNodeVariableInvokation*> nodes;
+};
+
+} // namespace
+
+int main(int argc, char** argv) {
+	std::size_t megabytes = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 16;
+	constexpr int runs = 5;
+	constexpr int reads = 10;
+
+	SourceBuffer source = SourceBuffer::fromString(Bench::program(megabytes << 20));
+	StringInterner interner;
+	Lexer lexer(source);
+	lexer.setInterner(&interner);
+	TokenBuffer tokens = lexer.tokenizeAll();
+	ASTArena arena;
+	Parser parser(tokens, arena);
+	ASTNode* program = parser.parse();
+
+	// The generated functions use names they never declare, make them the
+	// host's globals
+	static const char* const names[] = { "a", "b", "c", "x", "y", "count", "done", "flag", "mask", "bits",
+		"value", "name", "total", "print" };
+
+	std::ostream discard(nullptr);
+	double resolve_time = Bench::best(runs, [&] {
+		ScopeResolver resolver(&interner);
+		resolver.setDiagnostics(discard);
+		for (const char* name : names) {
+			resolver.declareGlobal(name);
+		}
+		resolver.resolve(program);
+	});
+
+	ScopeResolver resolver(&interner);
+	for (const char* name : names) {
+		resolver.declareGlobal(name);
+	}
+	resolver.resolve(program);
+
+	Uses uses;
+	uses.walk(program);
+	std::printf("%zu bytes, %zu variable uses, %zu globals\n", source.size(), uses.nodes.size(), resolver.globals().size());
+	Bench::report("ScopeResolver::resolve", resolve_time, static_cast<double>(uses.nodes.size()), "use");
+
+	std::unordered_map<std::string_view, std::int64_t> by_name;
+	std::vector<std::int64_t> by_slot(resolver.globals().size());
+	for (std::size_t i = 0; i < resolver.globals().size(); i++) {
+		by_name[resolver.globals()[i]] = static_cast<std::int64_t>(i);
+		by_slot[i] = static_cast<std::int64_t>(i);
+	}
+	std::vector<std::int64_t> frame(64);
+
+	double name_time = Bench::best(runs, [&] {
+		std::int64_t sum = 0;
+		for (int i = 0; i < reads; i++) {
+			for (ASTNodeVariableInvokation* use : uses.nodes) {
+				auto found = by_name.find(use->m_identifier);
+				sum += found != by_name.end() ? found->second : 0;
+			}
+		}
+		Bench::keep(sum);
+	});
+	Bench::report("read by name", name_time, static_cast<double>(reads * uses.nodes.size()), "read");
+
+	double slot_time = Bench::best(runs, [&] {
+		std::int64_t sum = 0;
+		for (int i = 0; i < reads; i++) {
+			for (ASTNodeVariableInvokation* use : uses.nodes) {
+				const ASTSlot& slot = use->m_slot;
+				sum += slot.kind == ASTSlot::Kind::Global ? by_slot[slot.index] : frame[slot.index];
+			}
+		}
+		Bench::keep(sum);
+	});
+	Bench::report("read by slot", slot_time, static_cast<double>(reads * uses.nodes.size()), "read");
+	std::printf("%-28s %10.2fx\n", "", name_time / slot_time);
+
+	return 0;
+}
@@ -0,0 +1,70 @@
+// Streams a generated program through a StreamLexer and parses it one
+// top-level item at a time, freeing each item before the next, then reports
+// the most memory held at once. The size of the program in megabytes can be
+// given on the command line, the default is 1024.
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/resource.h>
+#endif
+
+#include "Bench.hpp"
+#include "AST/ASTArena.hpp"
+#include "Lexer/StreamLexer.hpp"
+#include "Parser/Parser.hpp"
+
+using namespace Nitro;
+
+int main(int argc, char** argv) {
+	std::size_t megabytes = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 1024;
+
+	// The same megabyte of functions over and over, so that the script is
+	// never in memory as a whole
+	const std::string piece = Bench::program(1 << 20);
+	const std::size_t total = std::max<std::size_t>(1, (megabytes << 20) / piece.size()) * piece.size();
+	std::size_t sent = 0;
+	StreamLexer lexer([&](char* buffer, std::size_t size) {
+		std::size_t n = std::min(size, total - sent);
+		for (std::size_t done = 0; done < n;) {
+			std::size_t at = (sent + done) % piece.size();
+			std::size_t count = std::min(n - done, piece.size() - at);
+			std::memcpy(buffer + done, piece.data() + at, count);
+			done += count;
+		}
+		sent += n;
+		return n;
+	});
+
+	ASTArena arena;
+	Parser parser(lexer, arena);
+
+	std::size_t items = 0;
+	std::size_t peak_arena = 0;
+	std::size_t peak_text = 0;
+	double time = Bench::best(1, [&] {
+		for (ASTNode* item = parser.parseNext(); item; item = parser.parseNext()) {
+			Bench::keep(item);
+			items++;
+			peak_arena = std::max(peak_arena, arena.bytesUsed());
+			peak_text = std::max(peak_text, lexer.windowCapacity() + lexer.retainedCapacity());
+			arena.reset();
+		}
+	});
+
+	std::printf("%zu bytes, %zu items\n", sent, items);
+	Bench::report("streamed parse", time, static_cast<double>(sent), "byte");
+	std::printf("%-28s %10zu bytes\n", "most arena per item", peak_arena);
+	std::printf("%-28s %10zu bytes\n", "most source text held", peak_text);
+#if defined(__unix__) || defined(__APPLE__)
+	rusage usage;
+	getrusage(RUSAGE_SELF, &usage);
+	std::printf("%-28s %10ld kB\n", "peak resident set", static_cast<long>(usage.ru_maxrss));
+#endif
+
+	return 0;
+}
@@ -0,0 +1,112 @@
+// Runs scripts on the bytecode VM: recursive fib, and arithmetic in a loop
+// written as recursion, since the language has no loops yet. Compiling is
+// timed apart from running. fib's argument can be given on the command
+// line, the default is 27.
+
+#include <cstdio>
+#include <cstdlib>
+#include <sstream>
+#include <string>
+
+#include "Bench.hpp"
+#include "AST/ASTArena.hpp"
+#include "Lexer/Lexer.hpp"
+#include "Lexer/TokenBuffer.hpp"
+#include "Optimizer/ConstantFolder.hpp"
+#include "Parser/Parser.hpp"
+#include "Semantic/ScopeResolver.hpp"
+#include "Source/SourceBuffer.hpp"
+#include "VM/BytecodeCompiler.hpp"
+#include "VM/Natives.hpp"
+#include "VM/VM.hpp"
+
+using namespace Nitro;
+
+namespace {
+
+Program compileScript(const SourceBuffer& source) {
+	Lexer lexer(source);
+	TokenBuffer tokens = lexer.tokenizeAll();
+	ASTArena arena;
+	Parser parser(tokens, arena);
+	ASTNode* ast = parser.parse();
+
+	ConstantFolder folder(arena);
+	ast = folder.fold(ast);
+
+	ScopeResolver resolver;
+	for (const Native& native : natives()) {
+		resolver.declareGlobal(native.name);
+	}
+	resolver.resolve(ast);
+
+	BytecodeCompiler compiler;
+	return compiler.compile(ast, resolver);
+}
+
+void bench(const char* name, const std::string& text, double items, const char* unit) {
+	constexpr int runs = 5;
+
+	SourceBuffer source = SourceBuffer::fromString(text);
+	double compile_time = Bench::best(runs, [&] { Bench::keep(compileScript(source)); });
+
+	Program program = compileScript(source);
+	VM vm(program);
+	std::ostringstream out;
+	vm.setOutput(out);
+	double run_time = Bench::best(runs, [&] {
+		out.str("");
+		if (!vm.run()) {
+			std::abort();
+		}
+	});
+
+	std::printf("%s = %s", name, out.str().c_str());
+	Bench::report("  compile", compile_time, 1, "script");
+	Bench::report("  run", run_time, items, unit);
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+	long n = argc > 1 ? std::strtol(argv[1], nullptr, 10) : 27;
+
+	// fib(n) makes 2 fib(n + 1) - 1 calls
+	double a = 0, b = 1;
+	for (long i = 0; i < n; i++) {
+		double next = a + b;
+		a = b;
+		b = next;
+	}
+	double fib_calls = 2 * b - 1;
+
+	bench("fib", "func fib(n):\n"
+		"\tif (n < 2):\n"
+		"\t\treturn n\n"
+		"\treturn fib(n - 1) + fib(n - 2)\n"
+		"print(fib(" + std::to_string(n) + "))\n", fib_calls, "call");
+
+	// A thousand runs of a thousand iterations, to keep the recursion
+	// shallow
+	bench("loop", "func inner(i, acc):\n"
+		"\tif (i == 0):\n"
+		"\t\treturn acc\n"
+		"\treturn inner(i - 1, acc + i * 3 - (i & 7) + (i >> 2) * 2)\n"
+		"func outer(j, acc):\n"
+		"\tif (j == 0):\n"
+		"\t\treturn acc\n"
+		"\treturn outer(j - 1, inner(1000, acc))\n"
+		"print(outer(1000, 0))\n", 1e6, "iteration");
+
+	bench("float", "func inner(i, x):\n"
+		"\tif (i == 0):\n"
+		"\t\treturn x\n"
+		"\treturn inner(i - 1, x * 0.5 + 1.25 / (x + 2.0))\n"
+		"func outer(j, x):\n"
+		"\tif (j == 0):\n"
+		"\t\treturn x\n"
+		"\treturn outer(j - 1, inner(1000, x))\n"
+		"print(outer(1000, 1.0))\n", 1e6, "iteration");
+
+	return 0;
+}
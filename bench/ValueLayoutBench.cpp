@@ -0,0 +1,143 @@
+// Compares the NaN-boxed Value with the 16 byte tagged union it replaced,
+// kept here as TaggedValue: adding up arrays of ints and of floats with the
+// language's + (ints wrap, a float operand makes a float), and counting
+// truthy values.
+
+#include <cstdint>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+#include "Bench.hpp"
+#include "VM/Operators.hpp"
+#include "VM/Value.hpp"
+
+using namespace Nitro;
+
+namespace {
+
+// The layout of Value before NaN-boxing
+class TaggedValue {
+public:
+	enum class Type : std::uint8_t {
+		Nil,
+		Bool,
+		Int,
+		Float
+	};
+
+	TaggedValue() : m_type(Type::Nil), m_int(0) {}
+
+	static TaggedValue boolean(bool value) {
+		TaggedValue v(Type::Bool);
+		v.m_bool = value;
+		return v;
+	}
+
+	static TaggedValue integer(std::int64_t value) {
+		TaggedValue v(Type::Int);
+		v.m_int = value;
+		return v;
+	}
+
+	static TaggedValue floating(double value) {
+		TaggedValue v(Type::Float);
+		v.m_float = value;
+		return v;
+	}
+
+	bool isInt() const { return m_type == Type::Int; }
+	bool isNumber() const { return m_type == Type::Int || m_type == Type::Float; }
+	std::int64_t asInt() const { return m_int; }
+	double asFloat() const { return m_float; }
+	double toFloat() const { return m_type == Type::Int ? static_cast<double>(m_int) : m_float; }
+	bool truthy() const { return !(m_type == Type::Nil || (m_type == Type::Bool && !m_bool)); }
+
+private:
+	explicit TaggedValue(Type type) : m_type(type), m_int(0) {}
+
+	Type m_type;
+	union {
+		bool m_bool;
+		std::int64_t m_int;
+		double m_float;
+	};
+};
+
+// Operators::add for TaggedValue
+const char* add(const TaggedValue& a, const TaggedValue& b, TaggedValue& out) {
+	if (a.isInt() && b.isInt()) {
+		out = TaggedValue::integer(Operators::wrap(static_cast<std::uint64_t>(a.asInt()) + static_cast<std::uint64_t>(b.asInt())));
+	} else if (a.isNumber() && b.isNumber()) {
+		out = TaggedValue::floating(a.toFloat() + b.toFloat());
+	} else {
+		return "Operands of + must be numbers";
+	}
+	return nullptr;
+}
+
+const char* add(const Value& a, const Value& b, Value& out) {
+	return Operators::add(a, b, out);
+}
+
+template <typename V>
+V sum(const std::vector<V>& values) {
+	V total = V::integer(0);
+	for (const V& value : values) {
+		if (add(total, value, total)) {
+			return V();
+		}
+	}
+	return total;
+}
+
+template <typename V>
+std::size_t countTruthy(const std::vector<V>& values) {
+	std::size_t count = 0;
+	for (const V& value : values) {
+		count += value.truthy();
+	}
+	return count;
+}
+
+template <typename V>
+void bench(const char* name, std::size_t count) {
+	constexpr int runs = 5;
+
+	std::mt19937_64 rng(7);
+	std::vector<V> ints, floats, mixed;
+	for (std::size_t i = 0; i < count; i++) {
+		ints.push_back(V::integer(static_cast<std::int64_t>(rng() % 1000000)));
+		floats.push_back(V::floating(static_cast<double>(rng() % 1000000) * 0.25));
+		switch (rng() % 4) {
+			case 0: mixed.push_back(V()); break;
+			case 1: mixed.push_back(V::boolean(rng() % 2)); break;
+			case 2: mixed.push_back(V::integer(static_cast<std::int64_t>(rng() % 100))); break;
+			default: mixed.push_back(V::floating(0.5)); break;
+		}
+	}
+
+	std::printf("%s, %zu bytes\n", name, sizeof(V));
+	Bench::report("  sum ints", Bench::best(runs, [&] { Bench::keep(sum(ints)); }), static_cast<double>(count), "value");
+	Bench::report("  sum floats", Bench::best(runs, [&] { Bench::keep(sum(floats)); }), static_cast<double>(count), "value");
+	Bench::report("  count truthy", Bench::best(runs, [&] { Bench::keep(countTruthy(mixed)); }), static_cast<double>(count), "value");
+}
+
+} // namespace
+
+int main() {
+	// Large enough that the arrays do not fit in the caches
+	constexpr std::size_t count = 1 << 22;
+
+	bench<Value>("NaN-boxed Value", count);
+	bench<TaggedValue>("tagged union", count);
+
+	// Sums past 48 bits, which box every result
+	IntHeap heap;
+	IntHeap::Scope scope(heap);
+	std::vector<Value> wide(count, Value::integer(std::int64_t(1) << 40));
+	double time = Bench::best(1, [&] { Bench::keep(sum(wide)); });
+	Bench::report("NaN-boxed, boxed sums", time, static_cast<double>(count), "value");
+
+	return 0;
+}
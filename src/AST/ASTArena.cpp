@@ -0,0 +1,56 @@
+#include "ASTArena.hpp"
+
+namespace Nitro {
+
+void* ASTArena::allocateSlow(std::size_t size, std::size_t align) {
+	m_used += size;
+
+	// Big allocations get a block of their own, so the rest of the current
+	// block is not wasted
+	if (size > BLOCK_SIZE / 4) {
+		m_large.push_back(std::unique_ptr<char[]>(new char[size]));
+		return m_large.back().get();
+	}
+
+	m_blocks.push_back(std::unique_ptr<char[]>(new char[BLOCK_SIZE]));
+	m_cursor = m_blocks.back().get();
+	m_end = m_cursor + BLOCK_SIZE;
+
+	// Blocks are aligned for any type, so the first allocation always fits
+	(void)align;
+	void* memory = m_cursor;
+	m_cursor += size;
+	return memory;
+}
+
+void ASTArena::reset() {
+	m_large.clear();
+	m_used = 0;
+
+	if (m_blocks.empty()) {
+		return;
+	}
+
+	m_blocks.resize(1);
+	m_cursor = m_blocks.front().get();
+	m_end = m_cursor + BLOCK_SIZE;
+}
+
+void ASTArena::adopt(ASTArena&& other) {
+	// Kept with the big allocations, which a reset frees entirely
+	for (auto& block : other.m_blocks) {
+		m_large.push_back(std::move(block));
+	}
+	for (auto& block : other.m_large) {
+		m_large.push_back(std::move(block));
+	}
+	m_used += other.m_used;
+
+	other.m_blocks.clear();
+	other.m_large.clear();
+	other.m_cursor = nullptr;
+	other.m_end = nullptr;
+	other.m_used = 0;
+}
+
+} // namespace Nitro
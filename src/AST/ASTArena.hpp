@@ -0,0 +1,121 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <utility>
+#include <vector>
+
+#include "../global/defs.hpp"
+
+namespace Nitro {
+
+/**
+* A fixed list of items allocated in an ASTArena, used for the children of a
+* node in place of a std::vector.
+*/
+template <typename T>
+class ASTList {
+public:
+	NITRO_DEFAULT_COPY_MOVE(ASTList)
+
+	ASTList() = default;
+
+	ASTList(T* data, std::size_t size) : m_data(data), m_size(static_cast<std::uint32_t>(size)) {}
+
+	T* begin() const { return m_data; }
+	T* end() const { return m_data + m_size; }
+
+	std::size_t size() const { return m_size; }
+	bool empty() const { return m_size == 0; }
+
+	T& operator[](std::size_t index) const { return m_data[index]; }
+
+private:
+	T* m_data = nullptr;
+	std::uint32_t m_size = 0;
+};
+
+/**
+* Owns all the nodes of one parse. Nodes are bump allocated from large
+* blocks and freed together when the arena is destroyed or reset, which
+* takes one free() per block however deep the tree is.
+*
+* Node destructors are never run, so nodes must not own anything outside
+* the arena: children are plain pointers and ASTLists, text is a view into
+* the source.
+*/
+class ASTArena {
+public:
+	NITRO_DISABLE_COPY(ASTArena)
+	NITRO_DEFAULT_MOVE(ASTArena)
+
+	static constexpr std::size_t BLOCK_SIZE = 64 * 1024;
+
+	ASTArena() = default;
+
+	template <typename T, typename... Args>
+	T* make(Args&&... args) {
+		static_assert(alignof(T) <= alignof(std::max_align_t), "ASTArena does not over-align");
+		return new (allocate(sizeof(T), alignof(T))) T(std::forward<Args>(args)...);
+	}
+
+	/**
+	* Copies count items into the arena.
+	*/
+	template <typename T>
+	ASTList<T> list(const T* items, std::size_t count) {
+		if (count == 0) {
+			return {};
+		}
+
+		T* data = static_cast<T*>(allocate(sizeof(T) * count, alignof(T)));
+		for (std::size_t i = 0; i < count; i++) {
+			new (data + i) T(items[i]);
+		}
+		return ASTList<T>(data, count);
+	}
+
+	void* allocate(std::size_t size, std::size_t align) {
+		std::uintptr_t cursor = reinterpret_cast<std::uintptr_t>(m_cursor);
+		std::uintptr_t aligned = (cursor + align - 1) & ~static_cast<std::uintptr_t>(align - 1);
+
+		if (m_cursor && aligned + size <= reinterpret_cast<std::uintptr_t>(m_end)) {
+			m_cursor = reinterpret_cast<char*>(aligned + size);
+			m_used += size;
+			return reinterpret_cast<void*>(aligned);
+		}
+
+		return allocateSlow(size, align);
+	}
+
+	/**
+	* Frees every node, keeping the first block for the next parse.
+	*/
+	void reset();
+
+	/**
+	* Takes over the nodes of other, which is left empty. They are freed
+	* with this arena's.
+	*/
+	void adopt(ASTArena&& other);
+
+	/**
+	* Bytes handed out since the last reset, for diagnostics.
+	*/
+	std::size_t bytesUsed() const { return m_used; }
+
+	std::size_t blockCount() const { return m_blocks.size() + m_large.size(); }
+
+private:
+	void* allocateSlow(std::size_t size, std::size_t align);
+
+	std::vector<std::unique_ptr<char[]>> m_blocks;
+	std::vector<std::unique_ptr<char[]>> m_large; // Big allocations and adopted blocks
+	char* m_cursor = nullptr;
+	char* m_end = nullptr;
+	std::size_t m_used = 0;
+};
+
+} // namespace Nitro
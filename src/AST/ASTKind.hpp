@@ -0,0 +1,31 @@
+#pragma once
+
+#include <cstdint>
+
+namespace Nitro {
+
+/**
+* The kinds of AST node, one per node class.
+*/
+enum class ASTKind : std::uint8_t {
+	Int64,
+	Float64,
+	Bool,
+	String,
+	Char,
+	Nil,
+
+	Binary,
+	Unary,
+
+	VariableInvokation,
+	VariableDeclaration,
+
+	StatementSet,
+	Conditional,
+
+	FunctionDefinition,
+	FunctionReturn
+};
+
+} // namespace Nitro
@@ -2,7 +2,7 @@
 
 namespace Nitro {
 
-ASTNode::ASTNode(Token tok) : m_tok(tok) {}
+ASTNode::ASTNode(Token tok, ASTKind kind) : m_kind(kind), m_tok(tok) {}
 
 ASTNode::~ASTNode() {}
 
@@ -2,13 +2,14 @@
 
 #include "../global/defs.hpp"
 #include "../Lexer/Lexer.hpp"
+#include "ASTKind.hpp"
 #include "ASTVisitor.hpp"
 
 namespace Nitro {
 
 class ASTNode {
 public:
-	explicit ASTNode(Token tok);
+	ASTNode(Token tok, ASTKind kind);
 
 	virtual ~ASTNode() = 0;
 
@@ -16,6 +17,7 @@ public:
 
 	virtual void visit(ASTVisitor& visitor) = 0;
 
+	ASTKind m_kind; // Which subclass this is, see ASTWalker
 	Token m_tok;   // Lexer token used for debugging purposes
 		       // Gettine line, col, etc.
 };
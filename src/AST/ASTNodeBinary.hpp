@@ -1,13 +1,13 @@
 #pragma once
 
-#include <memory>
-
 #include "ASTNode.hpp"
 
 namespace Nitro {
 
 class ASTNodeBinary : public ASTNode {
 public:
+	static constexpr ASTKind KIND = ASTKind::Binary;
+
 	enum class Type {
 		Add,
 		Sub,
@@ -36,9 +36,9 @@ public:
 	ASTNodeBinary(
 		Token tok,
 		Type type,
-		std::unique_ptr<ASTNode> left,
-		std::unique_ptr<ASTNode> right
-	) : ASTNode(tok), m_type(type), m_left(std::move(left)), m_right(std::move(right)) {}
+		ASTNode* left,
+		ASTNode* right
+	) : ASTNode(tok, KIND), m_type(type), m_left(left), m_right(right) {}
 
 	~ASTNodeBinary() override = default;
 
@@ -48,9 +48,9 @@ public:
 		visitor.visit(*this);
 	}
 
-	std::unique_ptr<ASTNode> m_left;
-	std::unique_ptr<ASTNode> m_right;
 	Type m_type;
+	ASTNode* m_left;
+	ASTNode* m_right;
 };
 
 } // namespace Nitro
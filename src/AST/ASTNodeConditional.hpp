@@ -2,18 +2,20 @@
 
 #include "ASTNode.hpp"
 
-#include <vector>
-#include <memory>
 #include <utility>
 
+#include "ASTArena.hpp"
+
 namespace Nitro {
 
 class ASTNodeConditional : public ASTNode {
 public:
-	using Conditional = std::pair<std::unique_ptr<ASTNode>, std::unique_ptr<ASTNode>>;
+	static constexpr ASTKind KIND = ASTKind::Conditional;
+
+	using Conditional = std::pair<ASTNode*, ASTNode*>;
 
-	ASTNodeConditional(Token tok, std::vector<Conditional> conditions, std::unique_ptr<ASTNode> Else) :
-		ASTNode(tok), m_conditions(std::move(conditions)), m_else_statement(std::move(Else)) {}
+	ASTNodeConditional(Token tok, ASTList<Conditional> conditions, ASTNode* Else) :
+		ASTNode(tok, KIND), m_conditions(conditions), m_else_statement(Else) {}
 
 	~ASTNodeConditional() override = default;
 
@@ -21,8 +23,8 @@ public:
 		visitor.visit(*this);
 	}
 
-	std::vector<Conditional> m_conditions;
-	std::unique_ptr<ASTNode> m_else_statement;
+	ASTList<Conditional> m_conditions;
+	ASTNode* m_else_statement;
 };
 
 } // namespace Nitro
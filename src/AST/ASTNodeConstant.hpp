@@ -1,15 +1,27 @@
+#pragma once
+
 #include "ASTNode.hpp"
 
 #include <cstdint>
 #include <string_view>
 #include <climits>
+#include <type_traits>
 
 namespace Nitro {
 
 template <typename T>
 class ASTNodeConstant : public ASTNode {
 public:
-	ASTNodeConstant(Token tok, T value) : ASTNode(tok), m_value(value) {}
+	static_assert(std::is_same_v<T, std::int64_t> || std::is_same_v<T, double> ||
+		std::is_same_v<T, bool> || std::is_same_v<T, char>, "No ASTKind for this constant type");
+
+	static constexpr ASTKind KIND =
+		std::is_same_v<T, double> ? ASTKind::Float64 :
+		std::is_same_v<T, bool> ? ASTKind::Bool :
+		std::is_same_v<T, char> ? ASTKind::Char :
+		ASTKind::Int64;
+
+	ASTNodeConstant(Token tok, T value) : ASTNode(tok, KIND), m_value(value) {}
 
 	~ASTNodeConstant() override = default;
 
@@ -22,6 +34,28 @@ public:
 	T m_value;
 };
 
+/**
+* String constants also carry the symbol of their text.
+*/
+template <>
+class ASTNodeConstant<std::string_view> : public ASTNode {
+public:
+	static constexpr ASTKind KIND = ASTKind::String;
+
+	ASTNodeConstant(Token tok, std::string_view value) : ASTNode(tok, KIND), m_value(value), m_symbol(tok.symbol) {}
+
+	~ASTNodeConstant() override = default;
+
+	friend class ASTVisitor;
+
+	void visit(ASTVisitor& visitor) override {
+		visitor.visit(*this);
+	}
+
+	std::string_view m_value;
+	Symbol m_symbol;
+};
+
 // Types of constants
 using ASTNodeFloat64 = ASTNodeConstant<double>;
 static_assert(sizeof(double) * CHAR_BIT == 64, "double is not a 64 bit value");
@@ -2,16 +2,27 @@
 
 #include "ASTNode.hpp"
 
-#include <vector>
+#include <cstdint>
 #include <string_view>
-#include <memory>
+
+#include "ASTArena.hpp"
+#include "ASTSlot.hpp"
 
 namespace Nitro {
 
 class ASTNodeFunctionDefinition : public ASTNode {
 public:
-	ASTNodeFunctionDefinition(Token tok, std::string_view id, std::vector<std::string_view> args, std::unique_ptr<ASTNode> contents) :
-		ASTNode(tok), m_identifier(id), m_args(std::move(args)), m_contents(std::move(contents)) {}
+	static constexpr ASTKind KIND = ASTKind::FunctionDefinition;
+
+	/**
+	* m_body of a function whose body has been parsed.
+	*/
+	static constexpr std::uint32_t PARSED = UINT32_MAX;
+
+	ASTNodeFunctionDefinition(Token tok, std::string_view id, Symbol symbol, ASTList<std::string_view> args,
+		ASTList<Symbol> arg_symbols, ASTNode* contents) :
+		ASTNode(tok, KIND), m_identifier(id), m_symbol(symbol), m_args(args),
+		m_arg_symbols(arg_symbols), m_contents(contents) {}
 
 	~ASTNodeFunctionDefinition() override = default;
 
@@ -20,8 +31,19 @@ public:
 	}
 
 	std::string_view m_identifier;
-	std::vector<std::string_view> m_args;
-	std::unique_ptr<ASTNode> m_contents;
+	Symbol m_symbol;
+	ASTList<std::string_view> m_args;
+	ASTList<Symbol> m_arg_symbols;
+	ASTNode* m_contents;
+
+	// Index of the body's first token, while m_contents is left unparsed
+	// by a lazy parse, see functionBody()
+	std::uint32_t m_body = PARSED;
+
+	// The global holding the function, and the slots its frame needs for
+	// arguments and locals, see ScopeResolver
+	ASTSlot m_slot;
+	std::uint32_t m_frame_size = 0;
 };
 
 } // namespace Nitro
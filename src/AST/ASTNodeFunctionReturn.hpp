@@ -2,14 +2,14 @@
 
 #include "ASTNode.hpp"
 
-#include <memory>
-
 namespace Nitro {
 
 class ASTNodeFunctionReturn : public ASTNode {
 public:
-	ASTNodeFunctionReturn(Token tok, std::unique_ptr<ASTNode> expr) :
-		ASTNode(tok), m_expr(std::move(expr)) {}
+	static constexpr ASTKind KIND = ASTKind::FunctionReturn;
+
+	ASTNodeFunctionReturn(Token tok, ASTNode* expr) :
+		ASTNode(tok, KIND), m_expr(expr) {}
 
 	~ASTNodeFunctionReturn() override = default;
 
@@ -17,7 +17,7 @@ public:
 		visitor.visit(*this);
 	}
 
-	std::unique_ptr<ASTNode> m_expr;
+	ASTNode* m_expr;
 };
 
 } // namespace Nitro
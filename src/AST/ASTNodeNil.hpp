@@ -1,10 +1,14 @@
+#pragma once
+
 #include "ASTNode.hpp"
 
 namespace Nitro {
 
 class ASTNodeNil : public ASTNode {
 public:
-	ASTNodeNil(Token tok) : ASTNode(tok) {}
+	static constexpr ASTKind KIND = ASTKind::Nil;
+
+	ASTNodeNil(Token tok) : ASTNode(tok, KIND) {}
 
 	~ASTNodeNil() override = default;
 
@@ -2,15 +2,16 @@
 
 #include "ASTNode.hpp"
 
-#include <vector>
-#include <memory>
+#include "ASTArena.hpp"
 
 namespace Nitro {
 
 class ASTNodeStatementSet : public ASTNode {
 public:
-	ASTNodeStatementSet(Token tok, std::vector<std::unique_ptr<ASTNode>> statements) :
-		ASTNode(tok), m_statements(std::move(statements)) {}
+	static constexpr ASTKind KIND = ASTKind::StatementSet;
+
+	ASTNodeStatementSet(Token tok, ASTList<ASTNode*> statements) :
+		ASTNode(tok, KIND), m_statements(statements) {}
 
 	~ASTNodeStatementSet() override = default;
 
@@ -18,7 +19,7 @@ public:
 		visitor.visit(*this);
 	}
 
-	std::vector<std::unique_ptr<ASTNode>> m_statements;
+	ASTList<ASTNode*> m_statements;
 };
 
 } // namespace Nitro
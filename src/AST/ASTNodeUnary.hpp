@@ -1,13 +1,13 @@
 #pragma once
 
-#include <memory>
-
 #include "ASTNode.hpp"
 
 namespace Nitro {
 
 class ASTNodeUnary : public ASTNode {
 public:
+	static constexpr ASTKind KIND = ASTKind::Unary;
+
 	enum class Type {
 		Plus, /* Does nothing! */
 		Negate,
@@ -15,8 +15,8 @@ public:
 		BitwiseNot
 	};
 
-	ASTNodeUnary(Token tok, Type type, std::unique_ptr<ASTNode> branch) : 
-		ASTNode(tok), m_type(type), m_branch(std::move(branch)) {}
+	ASTNodeUnary(Token tok, Type type, ASTNode* branch) : 
+		ASTNode(tok, KIND), m_type(type), m_branch(branch) {}
 
 	~ASTNodeUnary() override = default;
 
@@ -27,7 +27,7 @@ public:
 	}
 
 	Type m_type;
-	std::unique_ptr<ASTNode> m_branch;
+	ASTNode* m_branch;
 };
 
 } // namespace Nitro
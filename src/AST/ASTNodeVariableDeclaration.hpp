@@ -2,14 +2,18 @@
 
 #include "ASTNode.hpp"
 
-#include <memory>
 #include <string_view>
 
+#include "ASTSlot.hpp"
+
 namespace Nitro {
 
 class ASTNodeVariableDeclaration : public ASTNode {
 public:
-	ASTNodeVariableDeclaration(Token tok, std::string_view identifier, std::unique_ptr<ASTNode> assign) : ASTNode(tok), m_identifier(identifier), m_assign(std::move(assign)) {}
+	static constexpr ASTKind KIND = ASTKind::VariableDeclaration;
+
+	ASTNodeVariableDeclaration(Token tok, std::string_view identifier, Symbol symbol, ASTNode* assign) :
+		ASTNode(tok, KIND), m_identifier(identifier), m_symbol(symbol), m_assign(assign) {}
 
 	~ASTNodeVariableDeclaration() override = default;
 
@@ -18,7 +22,9 @@ public:
 	}
 
 	std::string_view m_identifier;
-	std::unique_ptr<ASTNode> m_assign;
+	Symbol m_symbol;
+	ASTNode* m_assign;
+	ASTSlot m_slot;
 };
 
 } // namespace Nitro
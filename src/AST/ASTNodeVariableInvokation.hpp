@@ -3,14 +3,17 @@
 #include "ASTNode.hpp"
 
 #include <string_view>
-#include <vector>
-#include <memory>
+
+#include "ASTArena.hpp"
+#include "ASTSlot.hpp"
 
 namespace Nitro {
 
 class ASTNodeVariableInvokation : public ASTNode {
 public:
-	ASTNodeVariableInvokation(Token tok, std::vector<std::unique_ptr<ASTNode>> args) : ASTNode(tok), m_identifier(tok.lexeme), m_args(std::move(args)) {}
+	static constexpr ASTKind KIND = ASTKind::VariableInvokation;
+
+	ASTNodeVariableInvokation(Token tok, ASTList<ASTNode*> args, bool call) : ASTNode(tok, KIND), m_identifier(tok.lexeme), m_symbol(tok.symbol), m_args(args), m_call(call) {}
 
 	~ASTNodeVariableInvokation() override = default;
 
@@ -19,7 +22,10 @@ public:
 	}
 
 	std::string_view m_identifier;
-	std::vector<std::unique_ptr<ASTNode>> m_args;
+	Symbol m_symbol;
+	ASTList<ASTNode*> m_args;
+	bool m_call; // f() rather than f
+	ASTSlot m_slot;
 };
 
 } // namespace Nitro
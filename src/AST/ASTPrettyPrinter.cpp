@@ -17,7 +17,13 @@
 namespace Nitro {
 
 ASTPrettyPrinter::ASTPrettyPrinter(std::ostream& os, int tabs) :
-	m_os(os), m_tabs(tabs), m_tabstr(tabs, '\t') {}
+	m_os(os), m_tabstr(tabs, '\t') {}
+
+void ASTPrettyPrinter::child(ASTNode* node) {
+	m_tabstr.push_back('\t');
+	walk(node);
+	m_tabstr.pop_back();
+}
 
 void ASTPrettyPrinter::visit(ASTNodeConstant<std::int64_t>& node) {
 	m_os << m_tabstr << "Constant: {\n";
@@ -74,16 +80,15 @@ void ASTPrettyPrinter::visit(ASTNodeBinary& node) {
 	m_os << m_tabstr << "Binary Op: {\n";
 	m_os << m_tabstr << "Type: " << static_cast<int>(node.m_type) << "\n";
 	m_os << m_tabstr << "Lhs -> {\n";
-	ASTPrettyPrinter printer(m_os, m_tabs + 1);
 	if (node.m_left) {
-		node.m_left->visit(printer);
+		child(node.m_left);
 	} else {
 		m_os << m_tabstr << "nullnode\n";
 	}
 	m_os << m_tabstr << "}\n";
 	m_os << m_tabstr << "Rhs -> {\n";
 	if (node.m_right) {
-		node.m_right->visit(printer);
+		child(node.m_right);
 	} else {
 		m_os << m_tabstr << "nullnode\n";
 	}
@@ -94,9 +99,8 @@ void ASTPrettyPrinter::visit(ASTNodeUnary& node) {
 	m_os << m_tabstr << "Unary Op: {\n";
 	m_os << m_tabstr << "Type: " << static_cast<int>(node.m_type) << "\n";
 	m_os << m_tabstr << "Branch -> {\n";
-	ASTPrettyPrinter printer(m_os, m_tabs + 1);
 	if (node.m_branch) {
-		node.m_branch->visit(printer);
+		child(node.m_branch);
 	} else {
 		m_os << m_tabstr << "nullnode\n";
 	}
@@ -108,9 +112,8 @@ void ASTPrettyPrinter::visit(ASTNodeVariableInvokation& node) {
 	m_os << m_tabstr << "Name: " << node.m_identifier << "\n";
 	m_os << m_tabstr << "N Args: " << node.m_args.size() << "\n";
 
-	for (auto & arg : node.m_args) {
-		ASTPrettyPrinter printer(m_os, m_tabs + 1);
-		arg->visit(printer);
+	for (ASTNode* arg : node.m_args) {
+		child(arg);
 	}
 
 	m_os << m_tabstr << "}\n";
@@ -120,20 +123,15 @@ void ASTPrettyPrinter::visit(ASTNodeVariableDeclaration& node) {
 	m_os << m_tabstr << "Declare var: {\n";
 	m_os << m_tabstr << "Name: " << node.m_identifier << "\n";
 	m_os << m_tabstr << "Assign -> {\n";
-	ASTPrettyPrinter printer(m_os, m_tabs + 1);
-	node.m_assign->visit(printer);
+	child(node.m_assign);
 	m_os << m_tabstr << "}\n";
 }
 
 void ASTPrettyPrinter::visit(ASTNodeStatementSet& node) {
 	m_os << m_tabstr << "Statements: {\n";
-	ASTPrettyPrinter printer(m_os, m_tabs + 1);
 
-	for (auto& statement : node.m_statements) {
-		if (statement) {
-			statement->visit(printer);
-		}
-		
+	for (ASTNode* statement : node.m_statements) {
+		child(statement);
 		m_os << m_tabstr << "\n";
 	}
 
@@ -141,21 +139,19 @@ void ASTPrettyPrinter::visit(ASTNodeStatementSet& node) {
 }
 
 void ASTPrettyPrinter::visit(ASTNodeConditional& node) {
-	ASTPrettyPrinter printer(m_os, m_tabs + 1);
-
 	m_os << m_tabstr << "Conditional: {\n";
 
 	for (auto& condition : node.m_conditions) {
 		m_os << m_tabstr << "if -> {\n";
-		condition.first->visit(printer);
+		child(condition.first);
 		m_os << m_tabstr << "} then -> {\n";
-		condition.second->visit(printer);
+		child(condition.second);
 		m_os << m_tabstr << "}\n";
 	}
 
 	if (node.m_else_statement) {
 		m_os << m_tabstr << "else -> {\n";
-		node.m_else_statement->visit(printer);
+		child(node.m_else_statement);
 		m_os << m_tabstr << "}\n";
 	}
 }
@@ -176,8 +172,7 @@ void ASTPrettyPrinter::visit(ASTNodeFunctionDefinition& node) {
 	m_os << ")\n";
 
 	m_os << m_tabstr << "Contents -> {\n";
-	ASTPrettyPrinter printer(m_os, m_tabs + 1);
-	node.m_contents->visit(printer);
+	child(node.m_contents);
 	m_os << m_tabstr << "}\n";
 }
 
@@ -186,8 +181,7 @@ void ASTPrettyPrinter::visit(ASTNodeFunctionReturn& node) {
 	m_os << m_tabstr << "Returns -> {\n";
 
 	if (node.m_expr) {
-		ASTPrettyPrinter printer(m_os, m_tabs + 1);
-		node.m_expr->visit(printer);
+		child(node.m_expr);
 	} else {
 		m_os << m_tabstr << "\t" << "Nothing...\n";
 	}
@@ -3,46 +3,50 @@
 #include <iostream>
 #include <string>
 
-#include "ASTVisitor.hpp"
+#include "ASTWalker.hpp"
 
 namespace Nitro {
 
 // Prints the AST to the terminal in a pleasing manner
-class ASTPrettyPrinter : public ASTVisitor {
+class ASTPrettyPrinter : public ASTWalker<ASTPrettyPrinter> {
 public:
 	ASTPrettyPrinter(std::ostream& os, int tabs = 0);
 
-	void visit(ASTNodeConstant<std::int64_t>& node) override;
+	void visit(ASTNodeConstant<std::int64_t>& node);
 
-	void visit(ASTNodeConstant<double>& node) override;
+	void visit(ASTNodeConstant<double>& node);
 
-	void visit(ASTNodeConstant<bool>& node) override;
+	void visit(ASTNodeConstant<bool>& node);
 
-	void visit(ASTNodeConstant<std::string_view>& node) override;
+	void visit(ASTNodeConstant<std::string_view>& node);
 
-	void visit(ASTNodeConstant<char>& node) override;
+	void visit(ASTNodeConstant<char>& node);
 
-	void visit(ASTNodeNil& node) override;
+	void visit(ASTNodeNil& node);
 
-	void visit(ASTNodeBinary& node) override;
+	void visit(ASTNodeBinary& node);
 
-	void visit(ASTNodeUnary& node) override;
+	void visit(ASTNodeUnary& node);
 
-	void visit(ASTNodeVariableInvokation& node) override;
+	void visit(ASTNodeVariableInvokation& node);
 
-	void visit(ASTNodeVariableDeclaration& node) override;
+	void visit(ASTNodeVariableDeclaration& node);
 
-	void visit(ASTNodeStatementSet& node) override;
+	void visit(ASTNodeStatementSet& node);
 
-	void visit(ASTNodeConditional& node) override;
+	void visit(ASTNodeConditional& node);
 
-	void visit(ASTNodeFunctionDefinition& node) override;
+	void visit(ASTNodeFunctionDefinition& node);
 
-	void visit(ASTNodeFunctionReturn& node) override;
+	void visit(ASTNodeFunctionReturn& node);
 
 private:
+	/**
+	* Prints a child node one level further in.
+	*/
+	void child(ASTNode* node);
+
 	std::ostream& m_os;
-	int m_tabs;
 	std::string m_tabstr;
 };
 
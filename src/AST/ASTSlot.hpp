@@ -0,0 +1,23 @@
+#pragma once
+
+#include <cstdint>
+
+namespace Nitro {
+
+/**
+* Where a variable lives, filled in by ScopeResolver so that running code
+* can index an array instead of looking the name up.
+*/
+struct ASTSlot {
+	enum class Kind : std::uint8_t {
+		Unresolved,
+		Local,  // index is a slot in the frame of a function depth frames out
+		Global  // index is among the globals
+	};
+
+	Kind kind = Kind::Unresolved;
+	std::uint32_t depth = 0;
+	std::uint32_t index = 0;
+};
+
+} // namespace Nitro
@@ -0,0 +1,120 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <utility>
+
+#include "../Lexer/Lexer.hpp"
+#include "../Lexer/StringInterner.hpp"
+#include "ASTArena.hpp"
+#include "ASTNode.hpp"
+#include "ASTNodeConstant.hpp"
+#include "ASTNodeNil.hpp"
+#include "ASTNodeBinary.hpp"
+#include "ASTNodeUnary.hpp"
+#include "ASTNodeVariableInvokation.hpp"
+#include "ASTNodeVariableDeclaration.hpp"
+#include "ASTNodeStatementSet.hpp"
+#include "ASTNodeConditional.hpp"
+#include "ASTNodeFunctionDefinition.hpp"
+#include "ASTNodeFunctionReturn.hpp"
+
+namespace Nitro {
+
+/**
+* Lets the parser build a tree of ASTNodes in an arena, see BasicParser.
+*/
+class ASTTreeBuilder {
+public:
+	using Node = ASTNode*;
+
+	static constexpr Node NONE = nullptr;
+
+	/**
+	* Whether function bodies can be left for later, see
+	* BasicParser::setLazyBodies().
+	*/
+	static constexpr bool LAZY_BODIES = true;
+
+	ASTTreeBuilder(ASTArena& arena) : m_arena(arena) {}
+
+	Node integer(const Token& tok, std::int64_t value) {
+		return m_arena.make<ASTNodeInt64>(tok, value);
+	}
+
+	Node floating(const Token& tok, double value) {
+		return m_arena.make<ASTNodeFloat64>(tok, value);
+	}
+
+	Node boolean(const Token& tok, bool value) {
+		return m_arena.make<ASTNodeBool>(tok, value);
+	}
+
+	Node character(const Token& tok, char value) {
+		return m_arena.make<ASTNodeChar>(tok, value);
+	}
+
+	Node string(const Token& tok) {
+		return m_arena.make<ASTNodeString>(tok, tok.lexeme);
+	}
+
+	Node nil(const Token& tok) {
+		return m_arena.make<ASTNodeNil>(tok);
+	}
+
+	Node binary(const Token& tok, ASTNodeBinary::Type type, Node lhs, Node rhs) {
+		return m_arena.make<ASTNodeBinary>(tok, type, lhs, rhs);
+	}
+
+	Node unary(const Token& tok, ASTNodeUnary::Type type, Node operand) {
+		return m_arena.make<ASTNodeUnary>(tok, type, operand);
+	}
+
+	Node variableInvokation(const Token& tok, const Node* args, std::size_t count, bool call) {
+		return m_arena.make<ASTNodeVariableInvokation>(tok, m_arena.list(args, count), call);
+	}
+
+	Node variableDeclaration(const Token& identifier, Node assign) {
+		return m_arena.make<ASTNodeVariableDeclaration>(identifier, identifier.lexeme, identifier.symbol, assign);
+	}
+
+	Node statementSet(const Token& tok, const Node* statements, std::size_t count) {
+		return m_arena.make<ASTNodeStatementSet>(tok, m_arena.list(statements, count));
+	}
+
+	Node conditional(const Token& tok, const std::pair<Node, Node>* conditions, std::size_t count, Node Else) {
+		return m_arena.make<ASTNodeConditional>(tok, m_arena.list(conditions, count), Else);
+	}
+
+	Node functionDefinition(const Token& identifier, const std::string_view* args, const Symbol* arg_symbols,
+		std::size_t count, Node contents) {
+		return m_arena.make<ASTNodeFunctionDefinition>(
+			identifier,
+			identifier.lexeme,
+			identifier.symbol,
+			m_arena.list(args, count),
+			m_arena.list(arg_symbols, count),
+			contents
+		);
+	}
+
+	/**
+	* A function whose body, starting at token body, is parsed later.
+	*/
+	Node lazyFunctionDefinition(const Token& identifier, const std::string_view* args, const Symbol* arg_symbols,
+		std::size_t count, std::uint32_t body) {
+		auto* node = static_cast<ASTNodeFunctionDefinition*>(functionDefinition(identifier, args, arg_symbols, count, NONE));
+		node->m_body = body;
+		return node;
+	}
+
+	Node functionReturn(const Token& tok, Node expr) {
+		return m_arena.make<ASTNodeFunctionReturn>(tok, expr);
+	}
+
+private:
+	ASTArena& m_arena;
+};
+
+} // namespace Nitro
@@ -0,0 +1,135 @@
+#pragma once
+
+#include "ASTKind.hpp"
+#include "ASTNode.hpp"
+#include "ASTNodeConstant.hpp"
+#include "ASTNodeNil.hpp"
+#include "ASTNodeBinary.hpp"
+#include "ASTNodeUnary.hpp"
+#include "ASTNodeVariableInvokation.hpp"
+#include "ASTNodeVariableDeclaration.hpp"
+#include "ASTNodeStatementSet.hpp"
+#include "ASTNodeConditional.hpp"
+#include "ASTNodeFunctionDefinition.hpp"
+#include "ASTNodeFunctionReturn.hpp"
+
+namespace Nitro {
+
+/**
+* Walks a tree of ASTNodes without virtual calls. Dispatch is a switch on
+* ASTNode::m_kind, and Derived's hooks are called statically, so the
+* compiler can inline the whole walk.
+*
+* For every node, walk() calls the hooks of Derived for its class:
+*
+*  enter(node)  before the node, returning false skips it entirely
+*  visit(node)  walks the node's children, in source order, by default
+*  leave(node)  after the node
+*
+* Derived overloads the hooks it needs for the node classes it cares about.
+* Overloads in Derived hide the defaults, so a pass that only handles some
+* classes brings the rest back with using ASTWalker<Derived>::visit (or
+* enter, leave).
+*/
+template <typename Derived>
+class ASTWalker {
+public:
+	/**
+	* Does nothing for a null node, which the parser leaves after an error.
+	*/
+	void walk(ASTNode* node) {
+		if (!node) {
+			return;
+		}
+
+		switch (node->m_kind) {
+			case ASTKind::Int64: dispatch(static_cast<ASTNodeInt64&>(*node)); break;
+			case ASTKind::Float64: dispatch(static_cast<ASTNodeFloat64&>(*node)); break;
+			case ASTKind::Bool: dispatch(static_cast<ASTNodeBool&>(*node)); break;
+			case ASTKind::String: dispatch(static_cast<ASTNodeString&>(*node)); break;
+			case ASTKind::Char: dispatch(static_cast<ASTNodeChar&>(*node)); break;
+			case ASTKind::Nil: dispatch(static_cast<ASTNodeNil&>(*node)); break;
+			case ASTKind::Binary: dispatch(static_cast<ASTNodeBinary&>(*node)); break;
+			case ASTKind::Unary: dispatch(static_cast<ASTNodeUnary&>(*node)); break;
+			case ASTKind::VariableInvokation: dispatch(static_cast<ASTNodeVariableInvokation&>(*node)); break;
+			case ASTKind::VariableDeclaration: dispatch(static_cast<ASTNodeVariableDeclaration&>(*node)); break;
+			case ASTKind::StatementSet: dispatch(static_cast<ASTNodeStatementSet&>(*node)); break;
+			case ASTKind::Conditional: dispatch(static_cast<ASTNodeConditional&>(*node)); break;
+			case ASTKind::FunctionDefinition: dispatch(static_cast<ASTNodeFunctionDefinition&>(*node)); break;
+			case ASTKind::FunctionReturn: dispatch(static_cast<ASTNodeFunctionReturn&>(*node)); break;
+		}
+	}
+
+	template <typename Node>
+	bool enter(Node&) { return true; }
+
+	template <typename Node>
+	void visit(Node& node) { walkChildren(node); }
+
+	template <typename Node>
+	void leave(Node&) {}
+
+	/**
+	* Walks the children of a node, for hooks that replace visit() but still
+	* want the default walk.
+	*/
+	template <typename T>
+	void walkChildren(ASTNodeConstant<T>&) {}
+
+	void walkChildren(ASTNodeNil&) {}
+
+	void walkChildren(ASTNodeBinary& node) {
+		walk(node.m_left);
+		walk(node.m_right);
+	}
+
+	void walkChildren(ASTNodeUnary& node) {
+		walk(node.m_branch);
+	}
+
+	void walkChildren(ASTNodeVariableInvokation& node) {
+		for (ASTNode* arg : node.m_args) {
+			walk(arg);
+		}
+	}
+
+	void walkChildren(ASTNodeVariableDeclaration& node) {
+		walk(node.m_assign);
+	}
+
+	void walkChildren(ASTNodeStatementSet& node) {
+		for (ASTNode* statement : node.m_statements) {
+			walk(statement);
+		}
+	}
+
+	void walkChildren(ASTNodeConditional& node) {
+		for (auto& condition : node.m_conditions) {
+			walk(condition.first);
+			walk(condition.second);
+		}
+		walk(node.m_else_statement);
+	}
+
+	void walkChildren(ASTNodeFunctionDefinition& node) {
+		walk(node.m_contents);
+	}
+
+	void walkChildren(ASTNodeFunctionReturn& node) {
+		walk(node.m_expr);
+	}
+
+private:
+	Derived& derived() { return static_cast<Derived&>(*this); }
+
+	template <typename Node>
+	void dispatch(Node& node) {
+		if (!derived().enter(node)) {
+			return;
+		}
+		derived().visit(node);
+		derived().leave(node);
+	}
+};
+
+} // namespace Nitro
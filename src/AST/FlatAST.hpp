@@ -0,0 +1,387 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "../global/defs.hpp"
+#include "../Lexer/Lexer.hpp"
+#include "../Lexer/StringInterner.hpp"
+#include "ASTKind.hpp"
+#include "ASTNodeBinary.hpp"
+#include "ASTNodeUnary.hpp"
+
+namespace Nitro {
+
+/**
+* An AST stored as one array of 16 byte nodes instead of a tree of objects.
+* Nodes refer to each other by index, and what does not fit in a node (lists
+* of children, names) goes into a shared array of 32 bit words.
+*
+* Children always come before their parent, so the root is the last node and
+* a pass that only needs to see children first can run over the nodes in
+* order, without recursing.
+*
+* Nodes record where their token starts in the source instead of a copy of
+* the token. The source must outlive the AST.
+*/
+class FlatAST {
+public:
+	NITRO_DISABLE_COPY(FlatAST)
+	NITRO_DEFAULT_MOVE(FlatAST)
+
+	using Index = std::uint32_t;
+
+	/**
+	* Stands for a missing child: a return without a value, a conditional
+	* without an else, or a node the parser could not build after an error.
+	*/
+	static constexpr Index NO_NODE = UINT32_MAX;
+
+	/**
+	* What a and b hold depends on the kind:
+	*
+	*  Int64, Float64       a, b: low and high 32 bits of the value
+	*  Bool                 op: the value
+	*  Char                 a: the character
+	*  String               a: length, b: symbol
+	*  Binary, Unary        op: the operator type, a: lhs or operand, b: rhs
+	*  VariableInvokation   op: 1 for a call, a: extra [length, symbol, count,
+	*                       arguments...]
+	*  VariableDeclaration  a: extra [length, symbol], b: assigned value
+	*  StatementSet         a: extra [statements...], b: count
+	*  Conditional          a: extra [count, (condition, branch)..., else]
+	*  FunctionDefinition   a: extra [length, symbol, count,
+	*                       (offset, length, symbol)...], b: body
+	*  FunctionReturn       a: returned value
+	*
+	* length and symbol are those of the node's name, which starts at offset.
+	*/
+	struct Node {
+		ASTKind kind;
+		std::uint8_t op;
+		std::uint32_t offset;
+		std::uint32_t a;
+		std::uint32_t b;
+	};
+
+	static_assert(sizeof(Node) == 16, "FlatAST nodes should stay 16 bytes");
+
+	/**
+	* A run of child indices.
+	*/
+	class Range {
+	public:
+		Range(const Index* begin, std::size_t size) : m_begin(begin), m_size(size) {}
+
+		const Index* begin() const { return m_begin; }
+		const Index* end() const { return m_begin + m_size; }
+
+		std::size_t size() const { return m_size; }
+
+		Index operator[](std::size_t index) const { return m_begin[index]; }
+
+	private:
+		const Index* m_begin;
+		std::size_t m_size;
+	};
+
+	explicit FlatAST(std::string_view source) : m_source(source) {}
+
+	std::string_view source() const { return m_source; }
+
+	std::size_t size() const { return m_nodes.size(); }
+
+	Index root() const { return m_nodes.empty() ? NO_NODE : static_cast<Index>(m_nodes.size() - 1); }
+
+	/**
+	* Bytes taken by the nodes and the extra data.
+	*/
+	std::size_t memoryUsage() const {
+		return m_nodes.size() * sizeof(Node) + m_extra.size() * sizeof(std::uint32_t);
+	}
+
+	const Node& node(Index index) const { return m_nodes[index]; }
+
+	ASTKind kind(Index index) const { return m_nodes[index].kind; }
+
+	std::uint32_t offset(Index index) const { return m_nodes[index].offset; }
+
+	std::int64_t int64(Index index) const { return static_cast<std::int64_t>(bits(index)); }
+
+	double float64(Index index) const {
+		double value;
+		std::uint64_t raw = bits(index);
+		std::memcpy(&value, &raw, sizeof(value));
+		return value;
+	}
+
+	bool boolean(Index index) const { return m_nodes[index].op != 0; }
+
+	char character(Index index) const { return static_cast<char>(m_nodes[index].a); }
+
+	/**
+	* The text of a String, or the identifier of a VariableInvokation,
+	* VariableDeclaration or FunctionDefinition.
+	*/
+	std::string_view name(Index index) const {
+		const Node& n = m_nodes[index];
+		std::uint32_t length = n.kind == ASTKind::String ? n.a : m_extra[n.a];
+		return m_source.substr(n.offset, length);
+	}
+
+	/**
+	* The symbol of name(), NO_SYMBOL if the source was not interned.
+	*/
+	Symbol symbol(Index index) const {
+		const Node& n = m_nodes[index];
+		return n.kind == ASTKind::String ? n.b : m_extra[n.a + 1];
+	}
+
+	ASTNodeBinary::Type binaryType(Index index) const { return static_cast<ASTNodeBinary::Type>(m_nodes[index].op); }
+
+	ASTNodeUnary::Type unaryType(Index index) const { return static_cast<ASTNodeUnary::Type>(m_nodes[index].op); }
+
+	Index lhs(Index index) const { return m_nodes[index].a; }
+
+	Index rhs(Index index) const { return m_nodes[index].b; }
+
+	Index operand(Index index) const { return m_nodes[index].a; }
+
+	Range arguments(Index index) const {
+		std::uint32_t extra = m_nodes[index].a;
+		return Range(m_extra.data() + extra + 3, m_extra[extra + 2]);
+	}
+
+	/**
+	* Whether a VariableInvokation is a call, f() rather than f.
+	*/
+	bool isCall(Index index) const { return m_nodes[index].op != 0; }
+
+	Index assigned(Index index) const { return m_nodes[index].b; }
+
+	Range statements(Index index) const {
+		return Range(m_extra.data() + m_nodes[index].a, m_nodes[index].b);
+	}
+
+	std::size_t conditionCount(Index index) const { return m_extra[m_nodes[index].a]; }
+
+	Index condition(Index index, std::size_t i) const { return m_extra[m_nodes[index].a + 1 + 2 * i]; }
+
+	Index branch(Index index, std::size_t i) const { return m_extra[m_nodes[index].a + 2 + 2 * i]; }
+
+	Index elseBranch(Index index) const {
+		std::uint32_t extra = m_nodes[index].a;
+		return m_extra[extra + 1 + 2 * m_extra[extra]];
+	}
+
+	std::size_t parameterCount(Index index) const { return m_extra[m_nodes[index].a + 2]; }
+
+	std::string_view parameterName(Index index, std::size_t i) const {
+		std::uint32_t extra = m_nodes[index].a + 3 + 3 * static_cast<std::uint32_t>(i);
+		return m_source.substr(m_extra[extra], m_extra[extra + 1]);
+	}
+
+	Symbol parameterSymbol(Index index, std::size_t i) const {
+		return m_extra[m_nodes[index].a + 5 + 3 * i];
+	}
+
+	Index body(Index index) const { return m_nodes[index].b; }
+
+	Index returned(Index index) const { return m_nodes[index].a; }
+
+	/**
+	* Calls function with each child of a node that is present, in source
+	* order.
+	*/
+	template <typename Function>
+	void forEachChild(Index index, Function&& function) const;
+
+private:
+	friend class FlatASTBuilder;
+
+	std::uint64_t bits(Index index) const {
+		return static_cast<std::uint64_t>(m_nodes[index].a) | static_cast<std::uint64_t>(m_nodes[index].b) << 32;
+	}
+
+	std::string_view m_source;
+	std::vector<Node> m_nodes;
+	std::vector<std::uint32_t> m_extra;
+};
+
+template <typename Function>
+void FlatAST::forEachChild(Index index, Function&& function) const {
+	auto visit = [&function](Index child) {
+		if (child != NO_NODE) {
+			function(child);
+		}
+	};
+
+	switch (kind(index)) {
+		case ASTKind::Binary:
+			visit(lhs(index));
+			visit(rhs(index));
+			break;
+		case ASTKind::Unary:
+			visit(operand(index));
+			break;
+		case ASTKind::VariableInvokation:
+			for (Index argument : arguments(index)) {
+				visit(argument);
+			}
+			break;
+		case ASTKind::VariableDeclaration:
+			visit(assigned(index));
+			break;
+		case ASTKind::StatementSet:
+			for (Index statement : statements(index)) {
+				visit(statement);
+			}
+			break;
+		case ASTKind::Conditional:
+			for (std::size_t i = 0, n = conditionCount(index); i < n; i++) {
+				visit(condition(index, i));
+				visit(branch(index, i));
+			}
+			visit(elseBranch(index));
+			break;
+		case ASTKind::FunctionDefinition:
+			visit(body(index));
+			break;
+		case ASTKind::FunctionReturn:
+			visit(returned(index));
+			break;
+		default:
+			break;
+	}
+}
+
+/**
+* Lets the parser emit a FlatAST, see BasicParser.
+*/
+class FlatASTBuilder {
+public:
+	using Node = FlatAST::Index;
+
+	static constexpr Node NONE = FlatAST::NO_NODE;
+
+	// A body parsed later would come after its function, and children
+	// must come first
+	static constexpr bool LAZY_BODIES = false;
+
+	FlatASTBuilder(FlatAST& ast) : m_ast(ast) {}
+
+	Node integer(const Token& tok, std::int64_t value) {
+		std::uint64_t raw = static_cast<std::uint64_t>(value);
+		return add(ASTKind::Int64, 0, tok, static_cast<std::uint32_t>(raw), static_cast<std::uint32_t>(raw >> 32));
+	}
+
+	Node floating(const Token& tok, double value) {
+		std::uint64_t raw;
+		std::memcpy(&raw, &value, sizeof(raw));
+		return add(ASTKind::Float64, 0, tok, static_cast<std::uint32_t>(raw), static_cast<std::uint32_t>(raw >> 32));
+	}
+
+	Node boolean(const Token& tok, bool value) {
+		return add(ASTKind::Bool, value ? 1 : 0, tok, 0, 0);
+	}
+
+	Node character(const Token& tok, char value) {
+		return add(ASTKind::Char, 0, tok, static_cast<unsigned char>(value), 0);
+	}
+
+	Node string(const Token& tok) {
+		return add(ASTKind::String, 0, tok, static_cast<std::uint32_t>(tok.lexeme.size()), tok.symbol);
+	}
+
+	Node nil(const Token& tok) {
+		return add(ASTKind::Nil, 0, tok, 0, 0);
+	}
+
+	Node binary(const Token& tok, ASTNodeBinary::Type type, Node lhs, Node rhs) {
+		return add(ASTKind::Binary, static_cast<std::uint8_t>(type), tok, lhs, rhs);
+	}
+
+	Node unary(const Token& tok, ASTNodeUnary::Type type, Node operand) {
+		return add(ASTKind::Unary, static_cast<std::uint8_t>(type), tok, operand, 0);
+	}
+
+	Node variableInvokation(const Token& tok, const Node* args, std::size_t count, bool call) {
+		std::uint32_t extra = name(tok);
+		m_ast.m_extra.push_back(static_cast<std::uint32_t>(count));
+		m_ast.m_extra.insert(m_ast.m_extra.end(), args, args + count);
+		return add(ASTKind::VariableInvokation, call ? 1 : 0, tok, extra, 0);
+	}
+
+	Node variableDeclaration(const Token& identifier, Node assign) {
+		return add(ASTKind::VariableDeclaration, 0, identifier, name(identifier), assign);
+	}
+
+	Node statementSet(const Token& tok, const Node* statements, std::size_t count) {
+		std::uint32_t extra = static_cast<std::uint32_t>(m_ast.m_extra.size());
+		m_ast.m_extra.insert(m_ast.m_extra.end(), statements, statements + count);
+		return add(ASTKind::StatementSet, 0, tok, extra, static_cast<std::uint32_t>(count));
+	}
+
+	Node conditional(const Token& tok, const std::pair<Node, Node>* conditions, std::size_t count, Node Else) {
+		std::uint32_t extra = static_cast<std::uint32_t>(m_ast.m_extra.size());
+		m_ast.m_extra.push_back(static_cast<std::uint32_t>(count));
+		for (std::size_t i = 0; i < count; i++) {
+			m_ast.m_extra.push_back(conditions[i].first);
+			m_ast.m_extra.push_back(conditions[i].second);
+		}
+		m_ast.m_extra.push_back(Else);
+		return add(ASTKind::Conditional, 0, tok, extra, 0);
+	}
+
+	Node functionDefinition(const Token& identifier, const std::string_view* args, const Symbol* arg_symbols,
+		std::size_t count, Node contents) {
+		std::uint32_t extra = name(identifier);
+		m_ast.m_extra.push_back(static_cast<std::uint32_t>(count));
+		for (std::size_t i = 0; i < count; i++) {
+			m_ast.m_extra.push_back(offset(args[i]));
+			m_ast.m_extra.push_back(static_cast<std::uint32_t>(args[i].size()));
+			m_ast.m_extra.push_back(arg_symbols[i]);
+		}
+		return add(ASTKind::FunctionDefinition, 0, identifier, extra, contents);
+	}
+
+	Node functionReturn(const Token& tok, Node expr) {
+		return add(ASTKind::FunctionReturn, 0, tok, expr, 0);
+	}
+
+private:
+	/**
+	* Where text starts in the source. Error messages are not part of the
+	* source and are placed at its end.
+	*/
+	std::uint32_t offset(std::string_view text) const {
+		std::string_view source = m_ast.m_source;
+		if (text.data() < source.data() || text.data() > source.data() + source.size()) {
+			return static_cast<std::uint32_t>(source.size());
+		}
+		return static_cast<std::uint32_t>(text.data() - source.data());
+	}
+
+	/**
+	* Appends the length and symbol of a name to the extra data.
+	*/
+	std::uint32_t name(const Token& tok) {
+		std::uint32_t extra = static_cast<std::uint32_t>(m_ast.m_extra.size());
+		m_ast.m_extra.push_back(static_cast<std::uint32_t>(tok.lexeme.size()));
+		m_ast.m_extra.push_back(tok.symbol);
+		return extra;
+	}
+
+	Node add(ASTKind kind, std::uint8_t op, const Token& tok, std::uint32_t a, std::uint32_t b) {
+		m_ast.m_nodes.push_back(FlatAST::Node{ kind, op, offset(tok.lexeme), a, b });
+		return static_cast<Node>(m_ast.m_nodes.size() - 1);
+	}
+
+	FlatAST& m_ast;
+};
+
+} // namespace Nitro
@@ -0,0 +1,132 @@
+#include "IncrementalLexer.hpp"
+
+#include <algorithm>
+#include <utility>
+
+namespace Nitro {
+
+IncrementalLexer::IncrementalLexer(const SourceBuffer& source, StringInterner* interner)
+	: m_interner(interner), m_tokens(source.view()) {
+	Lexer lexer(source);
+	lexer.setInterner(m_interner);
+
+	for (;;) {
+		if (lexer.atLineBegin()) {
+			m_checkpoints.push_back(LineCheckpoint{
+				static_cast<std::uint32_t>(lexer.offset()),
+				static_cast<std::uint32_t>(m_tokens.size()),
+				lexer.indentLevels()
+			});
+		}
+
+		Token token = lexer.next();
+		m_tokens.push(token);
+
+		if (token.type == Token::Type::Error) {
+			m_tokens.pushEof();
+			break;
+		} else if (token.type == Token::Type::Eof) {
+			break;
+		}
+	}
+}
+
+std::size_t IncrementalLexer::checkpointBefore(std::size_t offset) const {
+	auto it = std::upper_bound(m_checkpoints.begin(), m_checkpoints.end(), offset,
+		[](std::size_t value, const LineCheckpoint& checkpoint) {
+			return value < checkpoint.offset;
+		});
+	return static_cast<std::size_t>(it - m_checkpoints.begin()) - 1;
+}
+
+std::size_t IncrementalLexer::checkpointAt(std::size_t offset) const {
+	std::size_t index = checkpointBefore(offset);
+	return m_checkpoints[index].offset == offset ? index : m_checkpoints.size();
+}
+
+TokenDelta IncrementalLexer::update(const SourceBuffer& source, const Edit& edit) {
+	std::size_t restart = checkpointBefore(edit.begin);
+	const LineCheckpoint& from = m_checkpoints[restart];
+
+	Lexer lexer(source, Lexer::Checkpoint{
+		from.offset,
+		restart + 1,
+		from.indent_levels,
+		0,
+		true
+	});
+	lexer.setInterner(m_interner);
+
+	TokenDelta delta{
+		from.token,
+		0,
+		TokenBuffer(source.view()),
+		static_cast<std::int64_t>(edit.new_end) - static_cast<std::int64_t>(edit.old_end)
+	};
+
+	std::vector<LineCheckpoint> lines;
+	std::size_t resync = m_checkpoints.size();
+
+	for (;;) {
+		if (lexer.atLineBegin()) {
+			std::size_t offset = lexer.offset();
+
+			// Past the edit, a line start that the old text had too, with
+			// the same indentation, lexes exactly as before. Strictly past
+			// it, as indentation tokens take in the preceding newline.
+			if (offset > edit.new_end) {
+				std::size_t old = checkpointAt(offset - edit.new_end + edit.old_end);
+				if (old < m_checkpoints.size() && m_checkpoints[old].indent_levels == lexer.indentLevels()) {
+					resync = old;
+					break;
+				}
+			}
+
+			lines.push_back(LineCheckpoint{
+				static_cast<std::uint32_t>(offset),
+				static_cast<std::uint32_t>(from.token + delta.inserted.size()),
+				lexer.indentLevels()
+			});
+		}
+
+		Token token = lexer.next();
+
+		if (token.type == Token::Type::Error) {
+			// Placed like TokenBuffer::push() would in a full buffer
+			const TokenBuffer& previous = delta.inserted.size() > 0 ? delta.inserted : m_tokens;
+			std::size_t last = delta.inserted.size() > 0 ? delta.inserted.size() : delta.first;
+			std::uint32_t offset = last > 0 ? previous.offset(last - 1) + previous.length(last - 1) : 0;
+
+			delta.inserted.pushError(token.lexeme, offset);
+			delta.inserted.pushEof();
+			break;
+		}
+
+		delta.inserted.push(token);
+		if (token.type == Token::Type::Eof) {
+			break;
+		}
+	}
+
+	std::size_t old_end_token = resync < m_checkpoints.size() ? m_checkpoints[resync].token : m_tokens.size();
+	delta.removed = old_end_token - delta.first;
+	m_relexed = delta.inserted.size();
+
+	// Checkpoints after the resync point move with the text
+	std::int64_t token_shift = static_cast<std::int64_t>(delta.inserted.size()) - static_cast<std::int64_t>(delta.removed);
+	for (std::size_t i = resync; i < m_checkpoints.size(); i++) {
+		m_checkpoints[i].offset = static_cast<std::uint32_t>(m_checkpoints[i].offset + delta.shift);
+		m_checkpoints[i].token = static_cast<std::uint32_t>(m_checkpoints[i].token + token_shift);
+	}
+
+	auto begin = m_checkpoints.begin();
+	m_checkpoints.erase(begin + static_cast<std::ptrdiff_t>(restart), begin + static_cast<std::ptrdiff_t>(resync));
+	m_checkpoints.insert(m_checkpoints.begin() + static_cast<std::ptrdiff_t>(restart),
+		std::make_move_iterator(lines.begin()), std::make_move_iterator(lines.end()));
+
+	m_tokens.apply(delta, source.view());
+
+	return delta;
+}
+
+} // namespace Nitro
@@ -0,0 +1,83 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "../global/defs.hpp"
+#include "../Source/SourceBuffer.hpp"
+#include "Lexer.hpp"
+#include "StringInterner.hpp"
+#include "TokenBuffer.hpp"
+
+namespace Nitro {
+
+/**
+* Keeps the tokens of a source that is being edited, re-lexing only what an
+* edit can have changed.
+*
+* The lexer state is checkpointed at every line start. After an edit, lexing
+* restarts from the last checkpoint before it and stops as soon as it reaches
+* a line start past the edit whose offset and indentation stack match a
+* checkpoint of the previous text: from there on both token streams are the
+* same, only shifted.
+*/
+class IncrementalLexer {
+public:
+	NITRO_DISABLE_COPY_MOVE(IncrementalLexer)
+
+	/**
+	* A replacement of the old text [begin, old_end) by the new text
+	* [begin, new_end).
+	*/
+	struct Edit {
+		std::size_t begin;
+		std::size_t old_end;
+		std::size_t new_end;
+	};
+
+	/**
+	* Lexes source in full. The source must outlive this object, or the next
+	* call to update(). Identifiers and string literals are interned into
+	* interner, when given, which must outlive this object.
+	*/
+	explicit IncrementalLexer(const SourceBuffer& source, StringInterner* interner = nullptr);
+
+	/**
+	* Re-lexes source, the previous text with edit applied, and returns the
+	* change to the token stream. The delta has already been applied to
+	* tokens().
+	*/
+	TokenDelta update(const SourceBuffer& source, const Edit& edit);
+
+	const TokenBuffer& tokens() const { return m_tokens; }
+
+	/**
+	* Number of tokens produced by the last update, for diagnostics.
+	*/
+	std::size_t relexed() const { return m_relexed; }
+
+private:
+	struct LineCheckpoint {
+		std::uint32_t offset;
+		std::uint32_t token; // Index of the first token of the line
+		std::vector<unsigned> indent_levels;
+	};
+
+	/**
+	* Index of the checkpoint at offset, or of the last one before it.
+	*/
+	std::size_t checkpointBefore(std::size_t offset) const;
+
+	/**
+	* Index of the checkpoint exactly at offset, or m_checkpoints.size().
+	*/
+	std::size_t checkpointAt(std::size_t offset) const;
+
+	StringInterner* m_interner;
+	TokenBuffer m_tokens;
+	std::vector<LineCheckpoint> m_checkpoints; // Line n starts at m_checkpoints[n - 1]
+	std::size_t m_relexed = 0;
+};
+
+} // namespace Nitro
@@ -0,0 +1,119 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+#include "Lexer.hpp"
+
+namespace Nitro {
+
+/**
+* Keyword recognition through a perfect hash that is generated at compile
+* time. Adding a keyword only takes a new entry in KEYWORDS; the hash seed and
+* table are searched for and laid out by the compiler.
+*/
+namespace Keywords {
+
+struct Keyword {
+	std::string_view spelling;
+	Token::Type type;
+};
+
+inline constexpr Keyword KEYWORDS[] = {
+	{ "if",       Token::Type::IfKeyword },
+	{ "else",     Token::Type::ElseKeyword },
+	{ "while",    Token::Type::WhileKeyword },
+	{ "for",      Token::Type::ForKeyword },
+	{ "continue", Token::Type::ContinueKeyword },
+	{ "break",    Token::Type::BreakKeyword },
+	{ "return",   Token::Type::ReturnKeyword },
+	{ "func",     Token::Type::FuncKeyword },
+	{ "let",      Token::Type::LetKeyword },
+	{ "true",     Token::Type::TrueKeyword },
+	{ "false",    Token::Type::FalseKeyword },
+	{ "nil",      Token::Type::NilKeyword },
+};
+
+inline constexpr std::size_t TABLE_SIZE = 32; // Power of two
+
+constexpr std::size_t hash(std::string_view word, std::uint32_t seed) {
+	std::uint32_t first = static_cast<unsigned char>(word.front());
+	std::uint32_t last = static_cast<unsigned char>(word.back());
+	return (((first * seed) ^ last) + static_cast<std::uint32_t>(word.size())) & (TABLE_SIZE - 1);
+}
+
+constexpr bool collisionFree(std::uint32_t seed) {
+	bool used[TABLE_SIZE] = {};
+	for (const Keyword& keyword : KEYWORDS) {
+		std::size_t slot = hash(keyword.spelling, seed);
+		if (used[slot]) {
+			return false;
+		}
+		used[slot] = true;
+	}
+	return true;
+}
+
+constexpr std::uint32_t findSeed() {
+	for (std::uint32_t seed = 1; seed < 65536; seed++) {
+		if (collisionFree(seed)) {
+			return seed;
+		}
+	}
+	return 0;
+}
+
+inline constexpr std::uint32_t SEED = findSeed();
+static_assert(SEED != 0, "No perfect hash seed for the keyword set, grow TABLE_SIZE");
+
+constexpr std::size_t shortest() {
+	std::size_t length = KEYWORDS[0].spelling.size();
+	for (const Keyword& keyword : KEYWORDS) {
+		length = keyword.spelling.size() < length ? keyword.spelling.size() : length;
+	}
+	return length;
+}
+
+constexpr std::size_t longest() {
+	std::size_t length = 0;
+	for (const Keyword& keyword : KEYWORDS) {
+		length = keyword.spelling.size() > length ? keyword.spelling.size() : length;
+	}
+	return length;
+}
+
+inline constexpr std::size_t MIN_LENGTH = shortest();
+inline constexpr std::size_t MAX_LENGTH = longest();
+
+constexpr std::array<Keyword, TABLE_SIZE> makeTable() {
+	// Empty slots can never match since no identifier is empty
+	std::array<Keyword, TABLE_SIZE> table{};
+	for (Keyword& slot : table) {
+		slot = Keyword{ std::string_view{}, Token::Type::Identifier };
+	}
+	for (const Keyword& keyword : KEYWORDS) {
+		table[hash(keyword.spelling, SEED)] = keyword;
+	}
+	return table;
+}
+
+inline constexpr std::array<Keyword, TABLE_SIZE> TABLE = makeTable();
+
+/**
+* Returns the keyword type for word, or Token::Type::Identifier. word must not
+* be empty.
+*/
+inline Token::Type lookup(std::string_view word) {
+	if (word.size() < MIN_LENGTH || word.size() > MAX_LENGTH) {
+		return Token::Type::Identifier;
+	}
+
+	const Keyword& candidate = TABLE[hash(word, SEED)];
+	return candidate.spelling == word ? candidate.type : Token::Type::Identifier;
+}
+
+} // namespace Keywords
+
+} // namespace Nitro
@@ -1,16 +1,45 @@
 #include "Lexer.hpp"
 
-#include <cctype>
+#include <algorithm>
+#include <cstdint>
+
+#include "Keywords.hpp"
+#include "LexerDfa.hpp"
+#include "TokenBuffer.hpp"
 
 namespace Nitro {
 
-Lexer::Lexer(std::string_view source)
-	: m_source(source), m_current(0), m_start(0), m_line(1), m_col(0) {}
+Lexer::Lexer(const SourceBuffer& source, Engine engine)
+	: m_scan(ScanKernels::select()), m_engine(engine), m_source(source.view()), m_current(0), m_start(0), m_line(1), m_col(0) {}
+
+Lexer::Lexer(const SourceBuffer& source, const Checkpoint& checkpoint, Engine engine)
+	: m_scan(ScanKernels::select()),
+	  m_engine(engine),
+	  m_line_begin(checkpoint.line_begin),
+	  m_indent_levels(checkpoint.indent_levels),
+	  m_dedent_emit_count(checkpoint.dedent_emit_count),
+	  m_source(source.view()),
+	  m_current(checkpoint.offset),
+	  // Indentation tokens span from the preceding newline
+	  m_start(checkpoint.offset > 0 ? checkpoint.offset - 1 : 0),
+	  m_line(checkpoint.line),
+	  m_col(checkpoint.col) {}
+
+Lexer::Checkpoint Lexer::checkpoint() const {
+	return Checkpoint{
+		m_current,
+		m_line,
+		m_indent_levels,
+		m_dedent_emit_count,
+		m_line_begin,
+		m_col
+	};
+}
 
 char Lexer::advance() {
-	// Since string view does not include the null byte by design, we will
-	// artificially emit it so the lexer can stop.
-	char c = (m_current < m_source.size()) ? m_source[m_current++] : '\0';
+	// The source buffer is NUL padded, so running off the end reads the
+	// terminator without any bounds check.
+	char c = m_source.data()[m_current++];
 
 	m_col++;
 
@@ -18,18 +47,16 @@ char Lexer::advance() {
 }
 
 char Lexer::getFirstNonWhitespace() {
-	char c;
-
-	do {
-		m_start = m_current;
-		c = advance();
-	} while (c == ' ' || c == '\t');
+	if (CharClass::is(peek(), CharClass::Blank)) {
+		consumeRun(m_scan.blanks);
+	}
 
-	return c;
+	m_start = m_current;
+	return advance();
 }
 
 char Lexer::peek() {
-	return (m_current < m_source.size()) ? m_source[m_current] : '\0';
+	return m_source.data()[m_current];
 }
 
 bool Lexer::match(char expected) {
@@ -40,6 +67,13 @@ bool Lexer::match(char expected) {
 	return false;
 }
 
+void Lexer::consumeRun(ScanKernels::Kernel kernel) {
+	std::size_t length = kernel(m_source.data() + m_current);
+
+	m_current += length;
+	m_col += length;
+}
+
 Token Lexer::simple(Token::Type type) {
 	return Token{
 		type,
@@ -49,6 +83,16 @@ Token Lexer::simple(Token::Type type) {
 	};
 }
 
+Token Lexer::endOfFile() {
+	// Helpers may have consumed the terminator already. Clamp back onto it
+	// so repeated calls keep returning Eof instead of walking the padding.
+	m_start = std::min(m_start, m_source.size());
+
+	Token token = simple(Token::Type::Eof);
+	m_current = m_start;
+	return token;
+}
+
 Token Lexer::endOfLine() {
 	Token token{
 		Token::Type::Eol,
@@ -104,9 +148,7 @@ Token Lexer::number() {
 	std::size_t line = m_line;
 	std::size_t col = m_col;
 
-	while (std::isdigit(peek())) {
-		advance();		
-	}
+	consumeRun(m_scan.digits);
 
 	if (!match('.')) {
 		return Token{
@@ -117,9 +159,7 @@ Token Lexer::number() {
 		};
 	}
 
-	while (std::isdigit(peek())) {
-		advance();	
-	}
+	consumeRun(m_scan.digits);
 
 	return Token{
 		Token::Type::FloatLiteral,
@@ -138,44 +178,12 @@ Token Lexer::error(std::string_view msg) {
 	};
 }
 
-Token::Type Lexer::checkKeyword(std::size_t start, std::size_t length, std::string_view rest, Token::Type type) {
-	if (m_current - m_start == start + length &&
-	    m_source.substr(m_start + start, length) == rest) {
-		return type;
-	}
-
-	return Token::Type::Identifier;
-}
-
 Token::Type Lexer::identifierOrKeywordType() {
-	switch (m_source[m_start]) {
-		case 'b': return checkKeyword(1, 4, "reak", Token::Type::BreakKeyword);
-		case 'c': return checkKeyword(1, 7, "ontinue", Token::Type::ContinueKeyword);
-		case 'e': return checkKeyword(1, 3, "lse", Token::Type::ElseKeyword);
-		case 'f': {
-			if (m_current - m_start > 1) {
-				switch (m_source[m_start + 1]) {
-					case 'a': return checkKeyword(2, 3, "lse", Token::Type::FalseKeyword);
-					case 'u': return checkKeyword(2, 2, "nc", Token::Type::FuncKeyword);
-					case 'o': return checkKeyword(2, 1, "r", Token::Type::ForKeyword);
-				}
-			}
-		} break;
-		case 'i': return checkKeyword(1, 1, "f", Token::Type::IfKeyword);
-		case 'l': return checkKeyword(1, 2, "et", Token::Type::LetKeyword);
-		case 'n': return checkKeyword(1, 2, "il", Token::Type::NilKeyword);
-		case 'r': return checkKeyword(1, 5, "eturn", Token::Type::ReturnKeyword);
-		case 't': return checkKeyword(1, 3, "rue", Token::Type::TrueKeyword);
-		case 'w': return checkKeyword(1, 4, "hile", Token::Type::WhileKeyword);
-	}
-
-	return Token::Type::Identifier;
+	return Keywords::lookup(m_source.substr(m_start, m_current - m_start));
 }
 
 Token Lexer::identifierOrKeyword() {
-	while (isalnum(peek()) || peek() == '_') {
-		advance();
-	}
+	consumeRun(m_scan.identifier);
 
 	return Token{
 		identifierOrKeywordType(),
@@ -207,7 +215,7 @@ Token Lexer::stringLiteral() {
 	while (true) {
 		c = peek();
 
-		if (std::isalnum(c) || std::isspace(c)) {
+		if (CharClass::is(c, CharClass::Digit | CharClass::Alpha | CharClass::Space)) {
 			advance();
 		} else if (c == '\\') {
 			// Handle escape sequence
@@ -231,6 +239,16 @@ Token Lexer::stringLiteral() {
 }
 
 Token Lexer::next() {
+	Token token = scan();
+
+	if (m_interner && (token.type == Token::Type::Identifier || token.type == Token::Type::StringLiteral)) {
+		token.symbol = m_interner->intern(token.lexeme);
+	}
+
+	return token;
+}
+
+Token Lexer::scan() {
 	if (m_dedent_emit_count > 0) {
 		m_dedent_emit_count--;
 		return simple(Token::Type::Dedent);
@@ -244,6 +262,10 @@ Token Lexer::next() {
 		}
 	}
 
+	if (m_engine == Engine::Table) {
+		return tableToken();
+	}
+
 	char c = getFirstNonWhitespace();
 
 	switch(c) {
@@ -275,15 +297,15 @@ Token Lexer::next() {
 		case '?': return simple(Token::Type::Question);
 		case ',': return simple(Token::Type::Comma);
 		
-		case '\0': return simple(Token::Type::Eof);
+		case '\0': return endOfFile();
 		case '\n': return endOfLine();
 		case '\'': return characterLiteral();
 		case '"': return stringLiteral();
 
 		default: {
-		if (std::isdigit(c)) {
+		if (CharClass::is(c, CharClass::Digit)) {
 			return number();
-		} else if (std::isalpha(c) || c == '_') {
+		} else if (CharClass::is(c, CharClass::Alpha | CharClass::Underscore)) {
 			return identifierOrKeyword();
 		} else {
 			return error("Unknown character");
@@ -292,5 +314,98 @@ Token Lexer::next() {
 		}
 	}
 }
+
+Token Lexer::tableToken() {
+	using namespace LexerDfa;
+
+	if (CharClass::is(peek(), CharClass::Blank)) {
+		consumeRun(m_scan.blanks);
+	}
+	m_start = m_current;
+
+	const char* text = m_source.data() + m_start;
+	std::size_t row = START * MAX_CLASSES;
+	std::size_t length = 0;
+	for (;;) {
+		std::size_t next = TABLES.transitions[row + TABLES.classes[static_cast<unsigned char>(text[length])]];
+		if (next == DEAD) {
+			break;
+		}
+		row = next;
+		length++;
+	}
+	std::size_t state = row / MAX_CLASSES;
+
+	m_current += length;
+	m_col += length;
+
+	// Literals report the column they start at, everything else the one it
+	// ends at, like the direct engine does
+	std::size_t first_col = m_col - (length - 1);
+
+	switch (TABLES.actions[state]) {
+		case Action::Fixed: return simple(TABLES.types[state]);
+		case Action::Identifier: return Token{
+			identifierOrKeywordType(),
+			m_source.substr(m_start, length),
+			m_line,
+			first_col
+		};
+		case Action::Integer: return Token{
+			Token::Type::IntegerLiteral,
+			m_source.substr(m_start, length),
+			m_line,
+			first_col
+		};
+		case Action::Float: return Token{
+			Token::Type::FloatLiteral,
+			m_source.substr(m_start, length),
+			m_line,
+			first_col
+		};
+		case Action::Char: return Token{
+			Token::Type::CharLiteral,
+			m_source.substr(m_start + 1, length - 2),
+			m_line,
+			first_col
+		};
+		case Action::String: return Token{
+			Token::Type::StringLiteral,
+			m_source.substr(m_start + 1, length - 2),
+			m_line,
+			first_col
+		};
+		case Action::Eol: return endOfLine();
+		case Action::Eof: return endOfFile();
+		case Action::UnknownCharacter: return error("Unknown character");
+		case Action::UnterminatedChar: return error("Expected \"'\" after character literal");
+		case Action::UnterminatedString: return error("Expected '\"' after string literal");
+		case Action::None: break;
+	}
+
+	return error("Unknown character");
+}
+
+TokenBuffer Lexer::tokenizeAll() {
+	TokenBuffer buffer(m_source);
+
+	if (m_source.size() > UINT32_MAX) {
+		buffer.push(error("Source is too large to tokenize into a buffer"));
+	} else {
+		Token token;
+		do {
+			token = next();
+			buffer.push(token);
+		} while (token.type != Token::Type::Eof && token.type != Token::Type::Error);
+	}
+
+	// Lexing stops at the first error, but consumers still expect the
+	// stream to end in Eof
+	if (buffer.type(buffer.size() - 1) == Token::Type::Error) {
+		buffer.pushEof();
+	}
+
+	return buffer;
+}
 	
 } // namespace Nitro
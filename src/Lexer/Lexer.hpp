@@ -4,6 +4,9 @@
 #include <vector>
 
 #include "../global/defs.hpp"
+#include "../Source/SourceBuffer.hpp"
+#include "Scanner.hpp"
+#include "StringInterner.hpp"
 
 namespace Nitro {
 
@@ -44,19 +47,99 @@ struct Token {
 
 	std::size_t line;
 	std::size_t col;
+
+	// Identifiers and string literals, when lexed with a StringInterner
+	Symbol symbol = NO_SYMBOL;
 };
 
+class TokenBuffer;
+
 class Lexer {
 public:
 	NITRO_DISABLE_COPY_MOVE(Lexer)
 
-	explicit Lexer(std::string_view source);
+	/**
+	* How tokens are recognized once indentation has been dealt with. Both
+	* engines produce exactly the same tokens.
+	*
+	* Direct is the hand written code: a switch on the first character and a
+	* helper per kind of token, with vectorized scans for long runs. Table
+	* runs the compile time generated automaton from LexerDfa.hpp, one table
+	* lookup per character.
+	*/
+	enum class Engine {
+		Direct,
+		Table
+	};
+
+	/**
+	* The lexer relies on the buffer's NUL padding instead of bounds checks,
+	* so it only lexes from a SourceBuffer, which must outlive it.
+	*/
+	explicit Lexer(const SourceBuffer& source, Engine engine = Engine::Direct);
+
+	/**
+	* Everything needed to resume lexing at the start of a line, or between
+	* two tokens of one. Only the indentation stack carries over from one
+	* line to the next.
+	*/
+	struct Checkpoint {
+		std::size_t offset;
+		std::size_t line;
+		std::vector<unsigned> indent_levels;
+		unsigned dedent_emit_count;
+		bool line_begin;
+		std::size_t col = 0; // Within the line, 0 at its start
+	};
+
+	/**
+	* Resumes lexing source from a checkpoint.
+	*/
+	Lexer(const SourceBuffer& source, const Checkpoint& checkpoint, Engine engine = Engine::Direct);
 
 	Token next();
 
+	/**
+	* Interns every identifier and string literal into interner from now on,
+	* and sets the tokens' symbols. nullptr turns interning off. The interner
+	* must outlive the lexer.
+	*/
+	void setInterner(StringInterner* interner) { m_interner = interner; }
+
+	/**
+	* True between lines: the previous line's Eol has been returned and the
+	* next line's indentation has not been looked at yet.
+	*/
+	bool atLineBegin() const { return m_line_begin && m_dedent_emit_count == 0; }
+
+	Checkpoint checkpoint() const;
+
+	const std::vector<unsigned>& indentLevels() const { return m_indent_levels; }
+
+	std::size_t offset() const { return m_current; }
+	std::size_t line() const { return m_line; }
+	std::size_t column() const { return m_col; }
+
+	/**
+	* True while the next token may still be one of the current line's
+	* Indent and Dedent tokens, which a checkpoint taken at the line start
+	* leads back to.
+	*/
+	bool inIndentation() const { return m_line_begin || m_dedent_emit_count > 0; }
+
+	/**
+	* Lexes everything up to and including the Eof token into a compact
+	* TokenBuffer. Lexing stops at the first Error token, which is then
+	* followed by Eof.
+	*/
+	TokenBuffer tokenizeAll();
+
 private:
 	static constexpr std::size_t TAB_WIDTH = 4; // Spaces
 
+	const ScanKernels& m_scan;
+	Engine m_engine;
+	StringInterner* m_interner = nullptr;
 	bool m_line_begin = true;
 	std::vector<unsigned> m_indent_levels = { 0 };
 	unsigned m_dedent_emit_count = 0;
@@ -67,6 +150,11 @@ private:
 	std::size_t m_col;
 
 	// lexing helpers
+
+	/**
+	* Lexes the next token, without interning.
+	*/
+	Token scan();
 	
 	/**
 	* Skips all spaces. Does not skip tabs, since those control indent and
@@ -77,7 +165,14 @@ private:
 	char peek();
 	bool match(char expected);
 
+	/**
+	* Consumes the run of characters accepted by kernel, starting at the
+	* current position.
+	*/
+	void consumeRun(ScanKernels::Kernel kernel);
+
 	Token simple(Token::Type type);
+	Token endOfFile();
 	Token endOfLine();
 	unsigned getCurrentIndentLevel();
 	unsigned determineLevelsOfDedent(unsigned current);
@@ -85,12 +180,16 @@ private:
 	Token number();
 	Token error(std::string_view msg);
 
-	Token::Type checkKeyword(std::size_t start, std::size_t length, std::string_view rest, Token::Type type);
 	Token::Type identifierOrKeywordType();
 
 	Token identifierOrKeyword();
 	Token characterLiteral();
 	Token stringLiteral();
+
+	/**
+	* Lexes the token after the indentation with the table engine.
+	*/
+	Token tableToken();
 };
 	
 } // namespace Nitro
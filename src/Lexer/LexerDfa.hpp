@@ -0,0 +1,256 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+#include "Lexer.hpp"
+#include "Scanner.hpp"
+
+namespace Nitro {
+
+/**
+* The tables of the table driven lexer engine, built by the compiler.
+*
+* The automaton recognizes one token starting at a non-blank character. It
+* takes transitions until the next one would be to DEAD, and the state it
+* stops in says what was read. Every state on the way to an accepting state
+* is accepting itself (each prefix of an operator is an operator), so there
+* is never anything to back out of.
+*
+* Bytes are first mapped to character classes: bytes that every state treats
+* the same share a class, which keeps the transition table at a few
+* kilobytes.
+*/
+namespace LexerDfa {
+
+/**
+* What a final state stands for.
+*/
+enum class Action : std::uint8_t {
+	None,
+	Fixed, // A token with a fixed spelling, Tables::types holds which
+	Identifier,
+	Integer,
+	Float,
+	Char,
+	String,
+	Eol,
+	Eof,
+	UnknownCharacter,
+	UnterminatedChar,
+	UnterminatedString
+};
+
+struct Spelling {
+	std::string_view text;
+	Token::Type type;
+};
+
+/**
+* The tokens that are always spelled the same.
+*/
+inline constexpr Spelling SPELLINGS[] = {
+	{ "(",  Token::Type::OpenParen },
+	{ ")",  Token::Type::CloseParen },
+	{ "[",  Token::Type::OpenBracket },
+	{ "]",  Token::Type::CloseBracket },
+	{ "+",  Token::Type::Plus },
+	{ "-",  Token::Type::Minus },
+	{ "*",  Token::Type::Star },
+	{ "**", Token::Type::StarStar },
+	{ "/",  Token::Type::Slash },
+	{ ">",  Token::Type::Greater },
+	{ ">>", Token::Type::GreaterGreater },
+	{ ">=", Token::Type::GreaterEqual },
+	{ "<",  Token::Type::Less },
+	{ "<<", Token::Type::LessLess },
+	{ "<=", Token::Type::LessEqual },
+	{ "=",  Token::Type::Equal },
+	{ "==", Token::Type::EqualEqual },
+	{ "!",  Token::Type::Not },
+	{ "!=", Token::Type::NotEqual },
+	{ "&",  Token::Type::And },
+	{ "&&", Token::Type::AndAnd },
+	{ "|",  Token::Type::Pipe },
+	{ "||", Token::Type::PipePipe },
+	{ "~",  Token::Type::Tilde },
+	{ "^",  Token::Type::Carat },
+	{ ":",  Token::Type::Colon },
+	{ "?",  Token::Type::Question },
+	{ ",",  Token::Type::Comma },
+};
+
+inline constexpr std::size_t MAX_STATES = 64;
+inline constexpr std::size_t MAX_CLASSES = 32; // Power of two
+
+inline constexpr std::uint8_t DEAD = 0;
+inline constexpr std::uint8_t START = 1;
+
+/**
+* transitions has a row of MAX_CLASSES entries per state. Entries hold the
+* offset of the next state's row rather than its number, which saves the
+* hot loop a multiplication; row / MAX_CLASSES gives the state back.
+*/
+struct Tables {
+	std::array<std::uint8_t, 256> classes;
+	std::array<std::uint16_t, MAX_STATES * MAX_CLASSES> transitions;
+	std::array<Action, MAX_STATES> actions;
+	std::array<Token::Type, MAX_STATES> types;
+	std::size_t state_count;
+	std::size_t class_count;
+};
+
+/**
+* The automaton over raw bytes, before classes are formed.
+*/
+struct ByteAutomaton {
+	std::uint8_t next[MAX_STATES][256] = {};
+	Action actions[MAX_STATES] = {};
+	Token::Type types[MAX_STATES] = {};
+	std::size_t count = START + 1;
+
+	constexpr std::uint8_t add(Action action, Token::Type type = Token::Type::Error) {
+		actions[count] = action;
+		types[count] = type;
+		return static_cast<std::uint8_t>(count++);
+	}
+
+	constexpr void onClass(std::uint8_t from, std::uint8_t mask, std::uint8_t to) {
+		for (unsigned c = 0; c < 256; c++) {
+			if (CharClass::TABLE[c] & mask) {
+				next[from][c] = to;
+			}
+		}
+	}
+
+	constexpr void onAny(std::uint8_t from, std::uint8_t to) {
+		for (unsigned c = 0; c < 256; c++) {
+			next[from][c] = to;
+		}
+	}
+
+	constexpr void on(std::uint8_t from, char c, std::uint8_t to) {
+		next[from][static_cast<unsigned char>(c)] = to;
+	}
+};
+
+constexpr ByteAutomaton buildAutomaton() {
+	ByteAutomaton dfa{};
+
+	// A trie of the fixed spellings
+	for (const Spelling& spelling : SPELLINGS) {
+		std::uint8_t state = START;
+		for (char c : spelling.text) {
+			std::uint8_t& next = dfa.next[state][static_cast<unsigned char>(c)];
+			if (next == DEAD) {
+				next = dfa.add(Action::None);
+			}
+			state = next;
+		}
+		dfa.actions[state] = Action::Fixed;
+		dfa.types[state] = spelling.type;
+	}
+
+	std::uint8_t identifier = dfa.add(Action::Identifier);
+	dfa.onClass(START, CharClass::Alpha | CharClass::Underscore, identifier);
+	dfa.onClass(identifier, CharClass::Identifier, identifier);
+
+	std::uint8_t integer = dfa.add(Action::Integer);
+	std::uint8_t floating = dfa.add(Action::Float);
+	dfa.onClass(START, CharClass::Digit, integer);
+	dfa.onClass(integer, CharClass::Digit, integer);
+	dfa.on(integer, '.', floating);
+	dfa.onClass(floating, CharClass::Digit, floating);
+
+	std::uint8_t string_body = dfa.add(Action::UnterminatedString);
+	std::uint8_t string_escape = dfa.add(Action::UnterminatedString);
+	std::uint8_t string_end = dfa.add(Action::String);
+	dfa.on(START, '"', string_body);
+	dfa.onClass(string_body, CharClass::Digit | CharClass::Alpha | CharClass::Space, string_body);
+	dfa.on(string_body, '\\', string_escape);
+	dfa.on(string_body, '"', string_end);
+	dfa.onAny(string_escape, string_body);
+
+	std::uint8_t char_open = dfa.add(Action::UnterminatedChar);
+	std::uint8_t char_body = dfa.add(Action::UnterminatedChar);
+	std::uint8_t char_end = dfa.add(Action::Char);
+	dfa.on(START, '\'', char_open);
+	dfa.onAny(char_open, char_body);
+	dfa.on(char_body, '\'', char_end);
+
+	dfa.on(START, '\n', dfa.add(Action::Eol));
+	dfa.on(START, '\0', dfa.add(Action::Eof));
+
+	// Everything else is a one character error
+	std::uint8_t unknown = dfa.add(Action::UnknownCharacter);
+	for (unsigned c = 0; c < 256; c++) {
+		if (dfa.next[START][c] == DEAD) {
+			dfa.next[START][c] = unknown;
+		}
+	}
+
+	return dfa;
+}
+
+constexpr bool sameColumn(const ByteAutomaton& dfa, unsigned a, unsigned b) {
+	for (std::size_t state = 0; state < dfa.count; state++) {
+		if (dfa.next[state][a] != dfa.next[state][b]) {
+			return false;
+		}
+	}
+	return true;
+}
+
+constexpr Tables buildTables() {
+	ByteAutomaton dfa = buildAutomaton();
+	Tables tables{};
+
+	// Bytes with identical columns share a class
+	unsigned representatives[MAX_CLASSES] = {};
+	for (unsigned c = 0; c < 256; c++) {
+		std::size_t klass = 0;
+		while (klass < tables.class_count && !sameColumn(dfa, representatives[klass], c)) {
+			klass++;
+		}
+		if (klass == tables.class_count) {
+			if (tables.class_count == MAX_CLASSES) {
+				return Tables{}; // Caught by the assertions below
+			}
+			representatives[tables.class_count++] = c;
+		}
+		tables.classes[c] = static_cast<std::uint8_t>(klass);
+	}
+
+	for (std::size_t state = 0; state < dfa.count; state++) {
+		for (std::size_t klass = 0; klass < tables.class_count; klass++) {
+			std::size_t next = dfa.next[state][representatives[klass]];
+			tables.transitions[state * MAX_CLASSES + klass] = static_cast<std::uint16_t>(next * MAX_CLASSES);
+		}
+		tables.actions[state] = dfa.actions[state];
+		tables.types[state] = dfa.types[state];
+	}
+	tables.state_count = dfa.count;
+
+	return tables;
+}
+
+inline constexpr Tables TABLES = buildTables();
+
+static_assert(TABLES.class_count > 0, "Too many character classes, grow MAX_CLASSES");
+
+constexpr bool everyStateDecides() {
+	for (std::size_t state = START + 1; state < TABLES.state_count; state++) {
+		if (TABLES.actions[state] == Action::None) {
+			return false;
+		}
+	}
+	return true;
+}
+
+static_assert(everyStateDecides(), "A token prefix does not decide a token, the engine cannot back out of it");
+
+} // namespace LexerDfa
+
+} // namespace Nitro
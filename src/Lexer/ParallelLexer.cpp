@@ -0,0 +1,170 @@
+#include "ParallelLexer.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <string_view>
+#include <thread>
+
+namespace Nitro {
+
+ParallelLexer::ParallelLexer(const SourceBuffer& source, unsigned threads)
+	: m_source(source),
+	  m_threads(threads > 0 ? threads : std::max(1u, std::thread::hardware_concurrency())) {}
+
+std::vector<std::size_t> ParallelLexer::split() const {
+	std::string_view text = m_source.view();
+	std::size_t count = std::min<std::size_t>(m_threads, text.size() / MIN_CHUNK_SIZE);
+
+	std::vector<std::size_t> bounds = { 0 };
+	for (std::size_t i = 1; i < count; i++) {
+		std::size_t at = std::max(text.size() / count * i, bounds.back());
+
+		// Cut after the next newline that starts an unindented line
+		while (at < text.size()) {
+			const void* newline = std::memchr(text.data() + at, '\n', text.size() - at);
+			if (!newline) {
+				at = text.size();
+				break;
+			}
+
+			at = static_cast<std::size_t>(static_cast<const char*>(newline) - text.data()) + 1;
+			if (at < text.size() && text[at] != '\t') {
+				break;
+			}
+		}
+
+		if (at >= text.size()) {
+			break;
+		}
+		bounds.push_back(at);
+	}
+
+	return bounds;
+}
+
+void ParallelLexer::lex(Chunk& chunk, std::size_t begin, const std::vector<unsigned>& indent_levels) const {
+	Lexer lexer(m_source, Lexer::Checkpoint{ begin, 1, indent_levels, 0, true });
+	chunk.tokens = TokenBuffer(m_source.view());
+	chunk.finished = false;
+
+	if (m_interner) {
+		chunk.interner = StringInterner();
+		lexer.setInterner(&chunk.interner);
+	}
+
+	for (;;) {
+		if (lexer.atLineBegin() && lexer.offset() >= chunk.end) {
+			chunk.stopped_at = lexer.offset();
+			chunk.indent_levels = lexer.indentLevels();
+			return;
+		}
+
+		Token token = lexer.next();
+
+		if (token.type == Token::Type::Error) {
+			// Placed at the end of the previous token, which for the first
+			// token of a chunk is the newline before it
+			std::size_t size = chunk.tokens.size();
+			std::size_t offset = size > 0 ? chunk.tokens.offset(size - 1) + chunk.tokens.length(size - 1) : begin;
+
+			chunk.tokens.pushError(token.lexeme, static_cast<std::uint32_t>(offset));
+			chunk.tokens.pushEof();
+			chunk.finished = true;
+			return;
+		}
+
+		chunk.tokens.push(token);
+		if (token.type == Token::Type::Eof) {
+			chunk.finished = true;
+			return;
+		}
+	}
+}
+
+TokenBuffer ParallelLexer::tokenizeAll() {
+	std::vector<std::size_t> bounds = split();
+
+	if (bounds.size() == 1 || m_source.size() > UINT32_MAX) {
+		Lexer lexer(m_source);
+		lexer.setInterner(m_interner);
+		return lexer.tokenizeAll();
+	}
+
+	std::vector<Chunk> chunks;
+	chunks.reserve(bounds.size());
+	for (std::size_t i = 0; i < bounds.size(); i++) {
+		chunks.push_back(Chunk{
+			bounds[i],
+			// The last chunk runs up to Eof
+			i + 1 < bounds.size() ? bounds[i + 1] : std::numeric_limits<std::size_t>::max(),
+			TokenBuffer(m_source.view()),
+			0,
+			{},
+			false,
+			StringInterner()
+		});
+	}
+
+	// Every chunk starts at an unindented line
+	const std::vector<unsigned> unindented = { 0 };
+
+	std::vector<std::thread> workers;
+	for (std::size_t i = 1; i < chunks.size(); i++) {
+		workers.emplace_back([this, &chunks, &unindented, i] {
+			lex(chunks[i], chunks[i].begin, unindented);
+		});
+	}
+	lex(chunks[0], 0, unindented);
+	for (std::thread& worker : workers) {
+		worker.join();
+	}
+
+	// Local symbols are numbered by first appearance in the chunk, so
+	// interning them in that order, chunk after chunk, numbers them by first
+	// appearance in the source
+	TokenBuffer tokens(m_source.view());
+	std::vector<Symbol> renumbered;
+	auto appendChunk = [&](Chunk& chunk) {
+		if (m_interner) {
+			renumbered.resize(chunk.interner.size());
+			for (Symbol local = 0; local < chunk.interner.size(); local++) {
+				renumbered[local] = m_interner->intern(chunk.interner.name(local));
+			}
+			chunk.tokens.renumberSymbols(renumbered);
+		}
+		tokens.append(chunk.tokens);
+	};
+
+	appendChunk(chunks[0]);
+
+	const Chunk* previous = &chunks[0];
+	for (std::size_t i = 1; i < chunks.size() && !previous->finished; i++) {
+		Chunk& chunk = chunks[i];
+
+		if (previous->stopped_at == chunk.begin) {
+			// The serial lexer would close the previous chunk's blocks here,
+			// with Dedents spanning the newline before the chunk
+			for (std::size_t level = 1; level < previous->indent_levels.size(); level++) {
+				tokens.push(Token{
+					Token::Type::Dedent,
+					m_source.view().substr(chunk.begin - 1, 1),
+					0,
+					0
+				});
+			}
+		} else {
+			// The previous chunk ended inside a multi-line string that ran
+			// past the cut, so this chunk was lexed from the wrong place
+			lex(chunk, previous->stopped_at, previous->indent_levels);
+		}
+
+		appendChunk(chunk);
+		previous = &chunk;
+	}
+
+	return tokens;
+}
+
+} // namespace Nitro
@@ -0,0 +1,85 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+#include "../global/defs.hpp"
+#include "../Source/SourceBuffer.hpp"
+#include "Lexer.hpp"
+#include "StringInterner.hpp"
+#include "TokenBuffer.hpp"
+
+namespace Nitro {
+
+/**
+* Tokenizes a large source on several threads. The result is identical to
+* Lexer::tokenizeAll().
+*
+* The source is cut into chunks right after newlines that are followed by an
+* unindented line. Every line start is a place where the lexer's only state
+* is its indentation stack, and at an unindented line that stack collapses to
+* { 0 } no matter what came before, so each chunk can be lexed on its own.
+* All a chunk misses is the Dedent tokens that close the previous chunk's
+* blocks, and those are inserted when the chunks are joined.
+*
+* A cut can land inside a string literal that spans lines. The chunk before
+* it then ends past the cut, and the next chunk is lexed again, serially,
+* from where the previous one really ended.
+*/
+class ParallelLexer {
+public:
+	NITRO_DISABLE_COPY_MOVE(ParallelLexer)
+
+	/**
+	* Sources are not split into chunks smaller than this.
+	*/
+	static constexpr std::size_t MIN_CHUNK_SIZE = 256 * 1024;
+
+	/**
+	* threads is the most threads to lex on, 0 picks the number of hardware
+	* threads. The source must outlive the lexer.
+	*/
+	explicit ParallelLexer(const SourceBuffer& source, unsigned threads = 0);
+
+	/**
+	* Interns identifiers and string literals like Lexer::setInterner(). The
+	* symbols come out the same as from a serial lexer: every chunk interns
+	* on its own, and the chunks' symbols are renumbered in order when they
+	* are joined.
+	*/
+	void setInterner(StringInterner* interner) { m_interner = interner; }
+
+	TokenBuffer tokenizeAll();
+
+private:
+	struct Chunk {
+		std::size_t begin;
+		std::size_t end;
+
+		TokenBuffer tokens;
+		std::size_t stopped_at = 0; // Line start the lexer stopped at
+		std::vector<unsigned> indent_levels; // Indentation stack there
+		bool finished = false; // Reached Eof or an Error
+
+		// Symbols of the chunk's tokens are local to the chunk until the
+		// chunks are joined
+		StringInterner interner;
+	};
+
+	/**
+	* Picks the chunk boundaries, at most one chunk per thread.
+	*/
+	std::vector<std::size_t> split() const;
+
+	/**
+	* Lexes from begin, with the given indentation stack, up to the first
+	* line start at or after end.
+	*/
+	void lex(Chunk& chunk, std::size_t begin, const std::vector<unsigned>& indent_levels) const;
+
+	const SourceBuffer& m_source;
+	unsigned m_threads;
+	StringInterner* m_interner = nullptr;
+};
+
+} // namespace Nitro
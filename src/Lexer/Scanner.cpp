@@ -0,0 +1,181 @@
+#include "Scanner.hpp"
+
+#include "../Source/SourceBuffer.hpp"
+
+#if defined(__x86_64__) || defined(_M_X64)
+#define NITRO_SCAN_X86 1
+#include <immintrin.h>
+#else
+#define NITRO_SCAN_X86 0
+#endif
+
+#if NITRO_SCAN_X86 && (defined(__GNUC__) || defined(__clang__))
+#define NITRO_SCAN_AVX2 1
+#define NITRO_TARGET_AVX2 __attribute__((target("avx2")))
+#else
+#define NITRO_SCAN_AVX2 0
+#endif
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+namespace Nitro {
+
+namespace {
+
+template <std::uint8_t Mask>
+std::size_t scanScalar(const char* begin) {
+	std::size_t i = 0;
+	while (CharClass::is(begin[i], Mask)) {
+		i++;
+	}
+	return i;
+}
+
+#if NITRO_SCAN_X86
+
+inline unsigned countTrailingZeros(std::uint32_t mask) {
+#if defined(_MSC_VER)
+	unsigned long index;
+	_BitScanForward(&index, mask);
+	return static_cast<unsigned>(index);
+#else
+	return static_cast<unsigned>(__builtin_ctz(mask));
+#endif
+}
+
+// Unsigned "lo <= v - base <= lo + range" test on every byte lane.
+inline __m128i inRange(__m128i v, char base, char range) {
+	__m128i shifted = _mm_sub_epi8(v, _mm_set1_epi8(base));
+	return _mm_cmpeq_epi8(_mm_min_epu8(shifted, _mm_set1_epi8(range)), shifted);
+}
+
+struct BlanksSSE2 {
+	static __m128i classify(__m128i v) {
+		return _mm_or_si128(
+			_mm_cmpeq_epi8(v, _mm_set1_epi8(' ')),
+			_mm_cmpeq_epi8(v, _mm_set1_epi8('\t'))
+		);
+	}
+};
+
+struct DigitsSSE2 {
+	static __m128i classify(__m128i v) {
+		return inRange(v, '0', 9);
+	}
+};
+
+struct IdentifierSSE2 {
+	static __m128i classify(__m128i v) {
+		__m128i alpha = inRange(_mm_or_si128(v, _mm_set1_epi8(0x20)), 'a', 25);
+		__m128i underscore = _mm_cmpeq_epi8(v, _mm_set1_epi8('_'));
+		return _mm_or_si128(_mm_or_si128(alpha, underscore), inRange(v, '0', 9));
+	}
+};
+
+template <typename Class>
+std::size_t scanSSE2(const char* begin) {
+	for (std::size_t i = 0;; i += 16) {
+		__m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(begin + i));
+		std::uint32_t miss = ~static_cast<std::uint32_t>(_mm_movemask_epi8(Class::classify(v))) & 0xFFFFu;
+		if (miss) {
+			return i + countTrailingZeros(miss);
+		}
+	}
+}
+
+#endif // NITRO_SCAN_X86
+
+#if NITRO_SCAN_AVX2
+
+NITRO_TARGET_AVX2 inline __m256i inRange256(__m256i v, char base, char range) {
+	__m256i shifted = _mm256_sub_epi8(v, _mm256_set1_epi8(base));
+	return _mm256_cmpeq_epi8(_mm256_min_epu8(shifted, _mm256_set1_epi8(range)), shifted);
+}
+
+struct BlanksAVX2 {
+	NITRO_TARGET_AVX2 static __m256i classify(__m256i v) {
+		return _mm256_or_si256(
+			_mm256_cmpeq_epi8(v, _mm256_set1_epi8(' ')),
+			_mm256_cmpeq_epi8(v, _mm256_set1_epi8('\t'))
+		);
+	}
+};
+
+struct DigitsAVX2 {
+	NITRO_TARGET_AVX2 static __m256i classify(__m256i v) {
+		return inRange256(v, '0', 9);
+	}
+};
+
+struct IdentifierAVX2 {
+	NITRO_TARGET_AVX2 static __m256i classify(__m256i v) {
+		__m256i alpha = inRange256(_mm256_or_si256(v, _mm256_set1_epi8(0x20)), 'a', 25);
+		__m256i underscore = _mm256_cmpeq_epi8(v, _mm256_set1_epi8('_'));
+		return _mm256_or_si256(_mm256_or_si256(alpha, underscore), inRange256(v, '0', 9));
+	}
+};
+
+template <typename Class>
+NITRO_TARGET_AVX2 std::size_t scanAVX2(const char* begin) {
+	for (std::size_t i = 0;; i += 32) {
+		__m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(begin + i));
+		std::uint32_t miss = ~static_cast<std::uint32_t>(_mm256_movemask_epi8(Class::classify(v)));
+		if (miss) {
+			return i + countTrailingZeros(miss);
+		}
+	}
+}
+
+bool cpuHasAVX2() {
+	__builtin_cpu_init();
+	return __builtin_cpu_supports("avx2");
+}
+
+#endif // NITRO_SCAN_AVX2
+
+} // namespace
+
+static_assert(SourceBuffer::PADDING >= 32, "Vector kernels load 32 bytes past the terminator");
+
+const ScanKernels& ScanKernels::scalar() {
+	static const ScanKernels kernels{
+		scanScalar<CharClass::Blank>,
+		scanScalar<CharClass::Identifier>,
+		scanScalar<CharClass::Digit>,
+		"scalar"
+	};
+	return kernels;
+}
+
+const ScanKernels& ScanKernels::select() {
+	static const ScanKernels& selected = []() -> const ScanKernels& {
+#if NITRO_SCAN_AVX2
+		static const ScanKernels avx2{
+			scanAVX2<BlanksAVX2>,
+			scanAVX2<IdentifierAVX2>,
+			scanAVX2<DigitsAVX2>,
+			"avx2"
+		};
+		if (cpuHasAVX2()) {
+			return avx2;
+		}
+#endif
+#if NITRO_SCAN_X86
+		static const ScanKernels sse2{
+			scanSSE2<BlanksSSE2>,
+			scanSSE2<IdentifierSSE2>,
+			scanSSE2<DigitsSSE2>,
+			"sse2"
+		};
+		return sse2;
+#else
+		return scalar();
+#endif
+	}();
+
+	return selected;
+}
+
+} // namespace Nitro
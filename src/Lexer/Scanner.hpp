@@ -0,0 +1,81 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+
+namespace Nitro {
+
+/**
+* Locale independent character classes used by the lexer. They agree with
+* <cctype> in the "C" locale, which is the only locale the lexer ever
+* supported, but are a single table lookup instead of a library call.
+*/
+namespace CharClass {
+
+enum : std::uint8_t {
+	Blank      = 1 << 0, // ' ' and '\t'
+	Digit      = 1 << 1, // 0-9
+	Alpha      = 1 << 2, // a-z and A-Z
+	Underscore = 1 << 3,
+	Space      = 1 << 4, // What isspace() accepts: ' ', '\t', '\n', '\v', '\f' and '\r'
+
+	Identifier = Digit | Alpha | Underscore
+};
+
+constexpr std::array<std::uint8_t, 256> makeTable() {
+	std::array<std::uint8_t, 256> table{};
+
+	for (char c : { ' ', '\t', '\n', '\v', '\f', '\r' }) {
+		table[static_cast<unsigned char>(c)] = Space;
+	}
+	table[static_cast<unsigned char>(' ')] |= Blank;
+	table[static_cast<unsigned char>('\t')] |= Blank;
+	table[static_cast<unsigned char>('_')] = Underscore;
+	for (unsigned c = '0'; c <= '9'; c++) {
+		table[c] = Digit;
+	}
+	for (unsigned c = 'a'; c <= 'z'; c++) {
+		table[c] = Alpha;
+		table[c - 'a' + 'A'] = Alpha;
+	}
+
+	return table;
+}
+
+inline constexpr std::array<std::uint8_t, 256> TABLE = makeTable();
+
+inline bool is(char c, std::uint8_t mask) {
+	return (TABLE[static_cast<unsigned char>(c)] & mask) != 0;
+}
+
+} // namespace CharClass
+
+/**
+* Bulk character scanners. Each kernel returns the length of the run of
+* characters starting at begin that belong to its character class, so the
+* lexer can jump over a whole run at once instead of advancing one byte at a
+* time.
+*
+* begin must point into a SourceBuffer. Kernels do not check bounds: the NUL
+* terminator ends every run, and the vector kernels may load a full vector
+* past it, into the buffer's padding.
+*
+* The vector kernels classify 16 (SSE2) or 32 (AVX2) bytes per step. The
+* widest variant supported by the running CPU is picked once, on first use.
+*/
+struct ScanKernels {
+	using Kernel = std::size_t (*)(const char* begin);
+
+	Kernel blanks;
+	Kernel identifier;
+	Kernel digits;
+
+	const char* name;
+
+	static const ScanKernels& scalar();
+	static const ScanKernels& select();
+};
+
+} // namespace Nitro
@@ -0,0 +1,128 @@
+#include "StreamLexer.hpp"
+
+#include <algorithm>
+#include <utility>
+
+namespace Nitro {
+
+StreamLexer::StreamLexer(ReadFunction read, std::size_t chunk_size)
+	: m_read(std::move(read)),
+	  m_chunk_size(std::max<std::size_t>(chunk_size, 1)),
+	  m_window(SourceBuffer::withCapacity(2 * m_chunk_size)),
+	  m_line_start{ 0, 1, { 0 }, 0, true } {}
+
+StreamLexer::StreamLexer(std::istream& in, std::size_t chunk_size)
+	: StreamLexer([&in](char* buffer, std::size_t size) {
+		in.read(buffer, static_cast<std::streamsize>(size));
+		return static_cast<std::size_t>(in.gcount());
+	}, chunk_size) {}
+
+void StreamLexer::refill(Lexer::Checkpoint resume, std::size_t replay) {
+	// Keep the newline before a line start, Indent and Dedent tokens start
+	// there
+	std::size_t keep = resume.line_begin && resume.offset > 0 ? resume.offset - 1 : resume.offset;
+	std::size_t rest = m_window.size() - keep;
+
+	if (m_window.spareCapacity() < m_chunk_size) {
+		// Room for more than what is kept, so a long token is copied a
+		// number of times logarithmic in its length
+		std::size_t capacity = std::max(2 * m_chunk_size, 2 * rest + m_chunk_size);
+
+		if (m_retaining && m_lexer) {
+			// The text of tokens already returned must not move
+			SourceBuffer window = SourceBuffer::withCapacity(capacity);
+			std::copy_n(m_window.data() + keep, rest, window.spare());
+			window.commit(rest);
+
+			m_retired.push_back(Retired{ std::move(m_window), m_returned });
+			m_window = std::move(window);
+		} else {
+			m_window.discard(keep);
+			if (m_window.capacity() < capacity) {
+				m_window.reserve(std::max(2 * m_window.capacity(), capacity));
+			}
+		}
+		resume.offset -= keep;
+	}
+
+	// The cut off token is lexed again from its start, so at least as much
+	// as there is of it is read, and a long one is lexed again a number of
+	// times logarithmic in its length too
+	std::size_t wanted = std::max(rest, m_chunk_size);
+	std::size_t read = 0;
+	do {
+		std::size_t chunk = m_read(m_window.spare(), m_chunk_size);
+		m_window.commit(chunk);
+		m_exhausted = chunk == 0;
+		read += chunk;
+	} while (!m_exhausted && read < wanted && m_window.spareCapacity() >= m_chunk_size);
+
+	if (resume.line_begin) {
+		m_line_start = resume;
+	}
+	m_lexer.emplace(m_window, resume);
+	for (std::size_t i = 0; i < replay; i++) {
+		m_lexer->next();
+	}
+}
+
+Token StreamLexer::next() {
+	if (!m_lexer) {
+		refill(m_line_start, 0);
+	}
+
+	for (;;) {
+		if (m_lexer->atLineBegin()) {
+			m_line_start = m_lexer->checkpoint();
+			m_line_tokens = 0;
+		}
+
+		// Where the token starts, to resume there if it is cut off
+		bool indentation = m_lexer->inIndentation();
+		std::size_t offset = m_lexer->offset();
+		std::size_t line = m_lexer->line();
+		std::size_t col = m_lexer->column();
+
+		Token token = m_lexer->next();
+
+		// A token that reaches the end of the window might go on in the
+		// next chunk
+		if (m_lexer->offset() < m_window.size() || m_exhausted) {
+			m_line_tokens++;
+			m_returned++;
+
+			// Interned here rather than by the lexer, which also sees the
+			// cut off tokens that are lexed again after a refill
+			if (m_interner && (token.type == Token::Type::Identifier || token.type == Token::Type::StringLiteral)) {
+				token.symbol = m_interner->intern(token.lexeme);
+			}
+			return token;
+		}
+
+		// Indentation is lexed again from the line start, where the indent
+		// levels it changes were saved
+		if (indentation) {
+			refill(m_line_start, m_line_tokens);
+		} else {
+			refill(Lexer::Checkpoint{ offset, line, m_lexer->indentLevels(), 0, false, col }, 0);
+		}
+	}
+}
+
+void StreamLexer::release(std::size_t keep) {
+	// Every token lexed from a retired window was returned before it was
+	// retired
+	while (!m_retired.empty() && m_retired.front().returned + keep <= m_returned) {
+		m_retired.pop_front();
+	}
+}
+
+std::size_t StreamLexer::retainedCapacity() const {
+	std::size_t capacity = 0;
+	for (const Retired& retired : m_retired) {
+		capacity += retired.window.capacity();
+	}
+	return capacity;
+}
+
+} // namespace Nitro
@@ -0,0 +1,114 @@
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <deque>
+#include <istream>
+#include <optional>
+
+#include "../global/defs.hpp"
+#include "../Source/SourceBuffer.hpp"
+#include "Lexer.hpp"
+#include "StringInterner.hpp"
+
+namespace Nitro {
+
+/**
+* Lexes input that arrives in chunks, from a pipe or stdin, without waiting
+* for the end of it. Produces the same tokens as Lexer over the whole input.
+*
+* Only a window of the input is kept: the token being lexed and what has
+* been read after it. When a token runs into the end of the window, the next
+* chunk is read in behind it and lexing resumes at the start of the token,
+* so only that token is lexed again. Once the window is full, the text
+* before the token is dropped, and the window doubles when the token takes
+* more than half of it. A refill reads at least as much as the cut off token
+* already holds. Memory use is therefore bounded by a few times the chunk
+* size plus the longest token (a multi-line string literal, say), not by
+* the size of the input, and a long line or token is read in linear time.
+*
+* Lexemes point into the window, so they are only valid until the next call
+* to next(), unless retain() is used.
+*/
+class StreamLexer {
+public:
+	NITRO_DISABLE_COPY_MOVE(StreamLexer)
+
+	/**
+	* Reads at most size characters into buffer and returns how many were
+	* read. Returning 0 ends the input.
+	*/
+	using ReadFunction = std::function<std::size_t(char* buffer, std::size_t size)>;
+
+	static constexpr std::size_t DEFAULT_CHUNK_SIZE = 64 * 1024;
+
+	explicit StreamLexer(ReadFunction read, std::size_t chunk_size = DEFAULT_CHUNK_SIZE);
+
+	/**
+	* Reads in chunks of chunk_size from in, which must outlive the lexer.
+	*/
+	explicit StreamLexer(std::istream& in, std::size_t chunk_size = DEFAULT_CHUNK_SIZE);
+
+	Token next();
+
+	/**
+	* See Lexer::setInterner(). Symbols outlive the window, unlike lexemes.
+	*/
+	void setInterner(StringInterner* interner) { m_interner = interner; }
+
+	/**
+	* Keeps lexemes valid from now on until they are released. Instead of
+	* moving the text in a full window, a refill then starts a new window
+	* with the cut off token, and the old one is kept until release() lets
+	* go of every token lexed from it.
+	*/
+	void retain() { m_retaining = true; }
+
+	/**
+	* Lets go of the text of every token returned so far but the last keep.
+	*/
+	void release(std::size_t keep);
+
+	/**
+	* Current size of the window, for diagnostics.
+	*/
+	std::size_t windowCapacity() const { return m_window.capacity(); }
+
+	/**
+	* Bytes of old windows still kept by retain(), for diagnostics.
+	*/
+	std::size_t retainedCapacity() const;
+
+private:
+	/**
+	* Reads the next chunk, or as many as the text from resume takes, first
+	* dropping the text before resume if the window is full, and starts a
+	* new lexer at resume. The lexer then skips
+	* replay tokens, the Indent and Dedent tokens of the line already
+	* returned when resuming at its start.
+	*/
+	void refill(Lexer::Checkpoint resume, std::size_t replay);
+
+	ReadFunction m_read;
+	std::size_t m_chunk_size;
+	SourceBuffer m_window;
+	std::optional<Lexer> m_lexer;
+	StringInterner* m_interner = nullptr;
+
+	// Where the current line starts in the window, while its indentation is
+	// being lexed
+	Lexer::Checkpoint m_line_start;
+	std::size_t m_line_tokens = 0; // Tokens of the current line returned so far
+	bool m_exhausted = false;
+
+	struct Retired {
+		SourceBuffer window;
+		std::size_t returned; // Tokens returned before it was replaced
+	};
+
+	bool m_retaining = false;
+	std::size_t m_returned = 0; // Tokens returned so far
+	std::deque<Retired> m_retired;
+};
+
+} // namespace Nitro
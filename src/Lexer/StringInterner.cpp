@@ -0,0 +1,104 @@
+#include "StringInterner.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+namespace Nitro {
+
+namespace {
+
+constexpr std::size_t INITIAL_SLOTS = 256;
+constexpr std::size_t BLOCK_SIZE = 16 * 1024;
+
+} // namespace
+
+StringInterner::StringInterner() : m_slots(INITIAL_SLOTS, Slot{ 0, NO_SYMBOL }) {}
+
+std::uint32_t StringInterner::hash(std::string_view text) {
+	// FNV-1a
+	std::uint32_t hash = 2166136261u;
+	for (char c : text) {
+		hash ^= static_cast<unsigned char>(c);
+		hash *= 16777619u;
+	}
+	return hash;
+}
+
+std::size_t StringInterner::probe(std::string_view text, std::uint32_t hash) const {
+	std::size_t mask = m_slots.size() - 1;
+	std::size_t index = hash & mask;
+
+	for (;;) {
+		const Slot& slot = m_slots[index];
+		if (slot.symbol == NO_SYMBOL || (slot.hash == hash && m_names[slot.symbol] == text)) {
+			return index;
+		}
+		index = (index + 1) & mask;
+	}
+}
+
+Symbol StringInterner::intern(std::string_view text) {
+	std::uint32_t text_hash = hash(text);
+	std::size_t index = probe(text, text_hash);
+
+	if (m_slots[index].symbol != NO_SYMBOL) {
+		return m_slots[index].symbol;
+	}
+
+	Symbol symbol = static_cast<Symbol>(m_names.size());
+	m_names.push_back(store(text));
+	m_slots[index] = Slot{ text_hash, symbol };
+
+	// Keep the load factor under one half
+	if (m_names.size() * 2 > m_slots.size()) {
+		grow();
+	}
+
+	return symbol;
+}
+
+std::optional<Symbol> StringInterner::find(std::string_view text) const {
+	const Slot& slot = m_slots[probe(text, hash(text))];
+	if (slot.symbol == NO_SYMBOL) {
+		return std::nullopt;
+	}
+	return slot.symbol;
+}
+
+void StringInterner::grow() {
+	std::vector<Slot> old = std::move(m_slots);
+	m_slots.assign(old.size() * 2, Slot{ 0, NO_SYMBOL });
+
+	std::size_t mask = m_slots.size() - 1;
+	for (const Slot& slot : old) {
+		if (slot.symbol == NO_SYMBOL) {
+			continue;
+		}
+
+		std::size_t index = slot.hash & mask;
+		while (m_slots[index].symbol != NO_SYMBOL) {
+			index = (index + 1) & mask;
+		}
+		m_slots[index] = slot;
+	}
+}
+
+std::string_view StringInterner::store(std::string_view text) {
+	if (text.size() > m_block_left) {
+		std::size_t size = std::max(BLOCK_SIZE, text.size());
+		m_blocks.push_back(std::make_unique<char[]>(size));
+		m_block_free = m_blocks.back().get();
+		m_block_left = size;
+	}
+
+	if (!text.empty()) {
+		std::memcpy(m_block_free, text.data(), text.size());
+	}
+	std::string_view stored(m_block_free, text.size());
+	m_block_free += text.size();
+	m_block_left -= text.size();
+
+	return stored;
+}
+
+} // namespace Nitro
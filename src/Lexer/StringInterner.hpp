@@ -0,0 +1,72 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string_view>
+#include <vector>
+
+#include "../global/defs.hpp"
+
+namespace Nitro {
+
+/**
+* Dense id of an interned string. Equal strings get equal symbols, so names
+* compare in O(1), and symbols can index tables directly.
+*/
+using Symbol = std::uint32_t;
+
+inline constexpr Symbol NO_SYMBOL = UINT32_MAX;
+
+/**
+* Maps strings to symbols, numbered from 0 in order of first appearance.
+*
+* The interner keeps its own copy of every string, so names stay valid after
+* the source they came from is gone.
+*/
+class StringInterner {
+public:
+	NITRO_DISABLE_COPY(StringInterner)
+	NITRO_DEFAULT_MOVE(StringInterner)
+
+	StringInterner();
+
+	Symbol intern(std::string_view text);
+
+	/**
+	* The symbol of text, if it has been interned.
+	*/
+	std::optional<Symbol> find(std::string_view text) const;
+
+	std::string_view name(Symbol symbol) const { return m_names[symbol]; }
+
+	std::size_t size() const { return m_names.size(); }
+
+private:
+	struct Slot {
+		std::uint32_t hash;
+		Symbol symbol; // NO_SYMBOL when empty
+	};
+
+	static std::uint32_t hash(std::string_view text);
+
+	/**
+	* Index of the slot holding text, or of the empty slot it would go in.
+	*/
+	std::size_t probe(std::string_view text, std::uint32_t hash) const;
+
+	void grow();
+
+	std::string_view store(std::string_view text);
+
+	std::vector<Slot> m_slots; // Open addressing, power of two size
+	std::vector<std::string_view> m_names;
+
+	// Strings are copied into blocks that never move
+	std::vector<std::unique_ptr<char[]>> m_blocks;
+	char* m_block_free = nullptr;
+	std::size_t m_block_left = 0;
+};
+
+} // namespace Nitro
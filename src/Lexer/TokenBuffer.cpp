@@ -0,0 +1,214 @@
+#include "TokenBuffer.hpp"
+
+#include <algorithm>
+
+namespace Nitro {
+
+static_assert(static_cast<unsigned>(Token::Type::Error) <= UINT8_MAX, "Token::Type does not fit in 8 bits");
+
+TokenBuffer::Reader::Reader(const TokenBuffer& buffer, std::size_t index)
+	: m_buffer(&buffer), m_index(index) {
+	if (index > 0 && index < buffer.size()) {
+		m_line = buffer.locate(buffer.anchor(index)).line - 1;
+	}
+}
+
+TokenBuffer::Reader::Reader(const TokenBuffer& buffer, std::size_t index, std::size_t end)
+	: Reader(buffer, index) {
+	m_end = end;
+}
+
+void TokenBuffer::Reader::seek(std::size_t index) {
+	m_index = std::min(index, m_buffer->size() - 1);
+}
+
+Token TokenBuffer::Reader::next() {
+	std::size_t index = m_index;
+	bool cut = index >= m_end && index + 1 < m_buffer->size();
+
+	if (!cut && m_index + 1 < m_buffer->size()) {
+		m_index++;
+	}
+
+	Token token{
+		m_buffer->type(index),
+		m_buffer->lexeme(index),
+		0,
+		0,
+		m_buffer->symbol(index)
+	};
+
+	// An Eof in place of the token at the end, which nodes that take the
+	// token after them still see as it is
+	if (cut) {
+		token.type = Token::Type::Eof;
+	}
+
+	// Tokens are read in order, so the line only ever moves forward
+	std::uint32_t offset = m_buffer->anchor(index);
+	const auto& line_starts = m_buffer->m_line_starts;
+	while (m_line + 1 < line_starts.size() && line_starts[m_line + 1] <= offset) {
+		m_line++;
+	}
+
+	Location location = m_buffer->locateFrom(m_line, offset);
+	token.line = location.line;
+	token.col = location.col;
+
+	return token;
+}
+
+TokenBuffer::TokenBuffer(std::string_view source) : m_source(source) {}
+
+void TokenBuffer::push(const Token& token) {
+	if (token.type == Token::Type::Error) {
+		pushError(token.lexeme, m_offsets.empty() ? 0 : m_offsets.back() + m_lengths.back());
+		return;
+	}
+
+	std::uint32_t offset = static_cast<std::uint32_t>(token.lexeme.data() - m_source.data());
+	std::uint32_t length = static_cast<std::uint32_t>(token.lexeme.size());
+
+	m_types.push_back(static_cast<std::uint8_t>(token.type));
+	m_offsets.push_back(offset);
+	m_lengths.push_back(length);
+	m_symbols.push_back(token.symbol);
+
+	if (token.type == Token::Type::Eol) {
+		m_line_starts.push_back(offset + length);
+	}
+}
+
+void TokenBuffer::pushError(std::string_view message, std::uint32_t offset) {
+	// Error messages do not live in the source
+	m_error = message;
+	m_types.push_back(static_cast<std::uint8_t>(Token::Type::Error));
+	m_offsets.push_back(offset);
+	m_lengths.push_back(0);
+	m_symbols.push_back(NO_SYMBOL);
+}
+
+void TokenBuffer::pushEof() {
+	push(Token{
+		Token::Type::Eof,
+		m_source.substr(m_source.size()),
+		0,
+		0
+	});
+}
+
+void TokenBuffer::append(const TokenBuffer& other) {
+	m_types.insert(m_types.end(), other.m_types.begin(), other.m_types.end());
+	m_offsets.insert(m_offsets.end(), other.m_offsets.begin(), other.m_offsets.end());
+	m_lengths.insert(m_lengths.end(), other.m_lengths.begin(), other.m_lengths.end());
+	m_symbols.insert(m_symbols.end(), other.m_symbols.begin(), other.m_symbols.end());
+	m_line_starts.insert(m_line_starts.end(), other.m_line_starts.begin() + 1, other.m_line_starts.end());
+
+	if (!other.m_error.empty()) {
+		m_error = other.m_error;
+	}
+}
+
+void TokenBuffer::renumberSymbols(const std::vector<Symbol>& renumbered) {
+	for (Symbol& symbol : m_symbols) {
+		if (symbol != NO_SYMBOL) {
+			symbol = renumbered[symbol];
+		}
+	}
+}
+
+std::string_view TokenBuffer::lexeme(std::size_t index) const {
+	if (type(index) == Token::Type::Error) {
+		return m_error;
+	}
+
+	return std::string_view(m_source.data() + m_offsets[index], m_lengths[index]);
+}
+
+Token TokenBuffer::token(std::size_t index) const {
+	Location location = locate(anchor(index));
+
+	return Token{
+		type(index),
+		lexeme(index),
+		location.line,
+		location.col,
+		symbol(index)
+	};
+}
+
+std::uint32_t TokenBuffer::anchor(std::size_t index) const {
+	// Indentation tokens start at the newline that precedes them, but they
+	// belong to the line they indent.
+	if (type(index) == Token::Type::Indent || type(index) == Token::Type::Dedent) {
+		return m_offsets[index] + m_lengths[index];
+	}
+
+	return m_offsets[index];
+}
+
+TokenBuffer::Location TokenBuffer::locate(std::uint32_t offset) const {
+	auto it = std::upper_bound(m_line_starts.begin(), m_line_starts.end(), offset);
+	return locateFrom(static_cast<std::size_t>(it - m_line_starts.begin()) - 1, offset);
+}
+
+TokenBuffer::Location TokenBuffer::locateFrom(std::size_t line, std::uint32_t offset) const {
+	return Location{
+		line + 1,
+		offset - m_line_starts[line] + 1
+	};
+}
+
+void TokenBuffer::apply(const TokenDelta& delta, std::string_view source) {
+	const TokenBuffer& inserted = delta.inserted;
+	std::size_t first = delta.first;
+	std::size_t last = delta.first + delta.removed;
+
+	// Line starts are made by Eol tokens, so the ones inside the removed run
+	// go away with it. The run is measured from the anchor of its first token,
+	// since an Indent or Dedent starts before the line it opens.
+	if (delta.removed > 0) {
+		std::uint32_t begin = anchor(first);
+		std::uint32_t end = m_offsets[last - 1] + m_lengths[last - 1];
+		auto lower = std::upper_bound(m_line_starts.begin(), m_line_starts.end(), begin);
+		auto upper = std::upper_bound(lower, m_line_starts.end(), end);
+		std::size_t position = static_cast<std::size_t>(lower - m_line_starts.begin());
+
+		m_line_starts.erase(lower, upper);
+		for (std::size_t i = position; i < m_line_starts.size(); i++) {
+			m_line_starts[i] = static_cast<std::uint32_t>(m_line_starts[i] + delta.shift);
+		}
+		m_line_starts.insert(m_line_starts.begin() + static_cast<std::ptrdiff_t>(position),
+			inserted.m_line_starts.begin() + 1, inserted.m_line_starts.end());
+	} else {
+		std::uint32_t at = first < size() ? anchor(first) : static_cast<std::uint32_t>(m_source.size());
+		auto lower = std::upper_bound(m_line_starts.begin(), m_line_starts.end(), at);
+		std::size_t position = static_cast<std::size_t>(lower - m_line_starts.begin());
+
+		for (std::size_t i = position; i < m_line_starts.size(); i++) {
+			m_line_starts[i] = static_cast<std::uint32_t>(m_line_starts[i] + delta.shift);
+		}
+		m_line_starts.insert(lower, inserted.m_line_starts.begin() + 1, inserted.m_line_starts.end());
+	}
+
+	for (std::size_t i = last; i < size(); i++) {
+		m_offsets[i] = static_cast<std::uint32_t>(m_offsets[i] + delta.shift);
+	}
+
+	auto splice = [&](auto& column, const auto& replacement) {
+		auto begin = column.begin() + static_cast<std::ptrdiff_t>(first);
+		column.erase(begin, begin + static_cast<std::ptrdiff_t>(delta.removed));
+		column.insert(column.begin() + static_cast<std::ptrdiff_t>(first), replacement.begin(), replacement.end());
+	};
+	splice(m_types, inserted.m_types);
+	splice(m_offsets, inserted.m_offsets);
+	splice(m_lengths, inserted.m_lengths);
+	splice(m_symbols, inserted.m_symbols);
+
+	if (!inserted.m_error.empty()) {
+		m_error = inserted.m_error;
+	}
+	m_source = source;
+}
+
+} // namespace Nitro
@@ -0,0 +1,154 @@
+#pragma once
+
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+#include "../global/defs.hpp"
+#include "Lexer.hpp"
+
+namespace Nitro {
+
+struct TokenDelta;
+
+/**
+* A fully tokenized source, stored as parallel arrays: an 8 bit type, a 32 bit
+* offset, a 32 bit length and a 32 bit symbol per token. That is 13 bytes per
+* token instead of the 56 of a Token.
+*
+* Line and column are not stored per token. The buffer only records where
+* every line starts, and positions are resolved from that index when they are
+* actually needed. Columns are 1-based byte columns of the token's first
+* character.
+*/
+class TokenBuffer {
+public:
+	NITRO_DEFAULT_COPY_MOVE(TokenBuffer)
+
+	struct Location {
+		std::size_t line;
+		std::size_t col;
+	};
+
+	/**
+	* Reads tokens front to back, tracking the current line as it goes so
+	* materialized tokens get their position without a search.
+	*/
+	class Reader {
+	public:
+		Reader() = default;
+		explicit Reader(const TokenBuffer& buffer, std::size_t index = 0);
+
+		/**
+		* Reads the tokens from index up to end only. The token at end
+		* is read as an Eof, with its text and position, which is returned
+		* again on every call.
+		*/
+		Reader(const TokenBuffer& buffer, std::size_t index, std::size_t end);
+
+		/**
+		* Returns the next token. Once the end is reached, the final Eof
+		* token is returned again on every call.
+		*/
+		Token next();
+
+		std::size_t index() const { return m_index; }
+
+		/**
+		* Moves on to the token at index, which must not be before the
+		* current one. The end stays where it was.
+		*/
+		void seek(std::size_t index);
+
+	private:
+		const TokenBuffer* m_buffer = nullptr;
+		std::size_t m_index = 0;
+		std::size_t m_end = SIZE_MAX;
+		std::size_t m_line = 0;
+	};
+
+	explicit TokenBuffer(std::string_view source);
+
+	void push(const Token& token);
+
+	/**
+	* Appends an Eof token at the end of the source.
+	*/
+	void pushEof();
+
+	/**
+	* Appends an Error token placed at offset. push() places errors at the end
+	* of the previous token.
+	*/
+	void pushError(std::string_view message, std::uint32_t offset);
+
+	/**
+	* Appends the tokens of other, which must lex the same source starting
+	* where this buffer ends.
+	*/
+	void append(const TokenBuffer& other);
+
+	/**
+	* Replaces every symbol s in the buffer with renumbered[s].
+	*/
+	void renumberSymbols(const std::vector<Symbol>& renumbered);
+
+	std::size_t size() const { return m_types.size(); }
+
+	Token::Type type(std::size_t index) const {
+		return static_cast<Token::Type>(m_types[index]);
+	}
+
+	std::uint32_t offset(std::size_t index) const { return m_offsets[index]; }
+
+	std::uint32_t length(std::size_t index) const { return m_lengths[index]; }
+
+	Symbol symbol(std::size_t index) const { return m_symbols[index]; }
+
+	std::string_view lexeme(std::size_t index) const;
+
+	std::string_view source() const { return m_source; }
+
+	/**
+	* Materializes the token at index. This resolves its location with a
+	* binary search, prefer a Reader for sequential access.
+	*/
+	Token token(std::size_t index) const;
+
+	Location locate(std::uint32_t offset) const;
+
+	/**
+	* Replaces a run of tokens after an edit. source is the edited text the
+	* buffer refers to from now on.
+	*/
+	void apply(const TokenDelta& delta, std::string_view source);
+
+private:
+	std::uint32_t anchor(std::size_t index) const;
+
+	Location locateFrom(std::size_t line, std::uint32_t offset) const;
+
+	std::string_view m_source;
+	std::string_view m_error; // Message of the Error token, if any
+
+	std::vector<std::uint8_t> m_types;
+	std::vector<std::uint32_t> m_offsets;
+	std::vector<std::uint32_t> m_lengths;
+	std::vector<Symbol> m_symbols;
+
+	std::vector<std::uint32_t> m_line_starts = { 0 };
+};
+
+/**
+* The difference between the tokens of a source before and after an edit:
+* removed tokens starting at first are replaced by inserted, and every token
+* after them moves by shift bytes.
+*/
+struct TokenDelta {
+	std::size_t first;
+	std::size_t removed;
+	TokenBuffer inserted;
+	std::int64_t shift;
+};
+
+} // namespace Nitro
@@ -0,0 +1,414 @@
+#include "ConstantFolder.hpp"
+
+#include <cmath>
+#include <cstdint>
+#include <limits>
+
+#include "../VM/Operators.hpp"
+
+namespace Nitro {
+
+namespace {
+
+using BinaryType = ASTNodeBinary::Type;
+using UnaryType = ASTNodeUnary::Type;
+
+struct NodeCounter : ASTWalker<NodeCounter> {
+	template <typename Node>
+	bool enter(Node&) {
+		count++;
+		return true;
+	}
+
+	std::size_t count = 0;
+};
+
+std::size_t countNodes(ASTNode* node) {
+	NodeCounter counter;
+	counter.walk(node);
+	return counter.count;
+}
+
+bool is(const ASTNode* node, ASTKind kind) {
+	return node && node->m_kind == kind;
+}
+
+bool isNumber(const ASTNode* node) {
+	return is(node, ASTKind::Int64) || is(node, ASTKind::Float64);
+}
+
+bool isConstant(const ASTNode* node) {
+	return node && node->m_kind <= ASTKind::Nil;
+}
+
+std::int64_t intOf(const ASTNode* node) {
+	return static_cast<const ASTNodeInt64*>(node)->m_value;
+}
+
+double floatOf(const ASTNode* node) {
+	if (node->m_kind == ASTKind::Int64) {
+		return static_cast<double>(intOf(node));
+	}
+	return static_cast<const ASTNodeFloat64*>(node)->m_value;
+}
+
+bool boolOf(const ASTNode* node) {
+	return static_cast<const ASTNodeBool*>(node)->m_value;
+}
+
+bool isInt(const ASTNode* node, std::int64_t value) {
+	return is(node, ASTKind::Int64) && intOf(node) == value;
+}
+
+/**
+* Whether node always evaluates to an integer, if it evaluates at all.
+*/
+bool isInteger(const ASTNode* node) {
+	if (is(node, ASTKind::Int64)) {
+		return true;
+	}
+
+	if (is(node, ASTKind::Unary)) {
+		auto* unary = static_cast<const ASTNodeUnary*>(node);
+		switch (unary->m_type) {
+			case UnaryType::BitwiseNot: return true;
+			case UnaryType::Plus:
+			case UnaryType::Negate: return isInteger(unary->m_branch);
+			case UnaryType::Not: return false;
+		}
+	}
+
+	if (is(node, ASTKind::Binary)) {
+		auto* binary = static_cast<const ASTNodeBinary*>(node);
+		switch (binary->m_type) {
+			case BinaryType::BitwiseAnd:
+			case BinaryType::BitwiseOr:
+			case BinaryType::BitwiseXor:
+			case BinaryType::LShift:
+			case BinaryType::RShift:
+				return true;
+			case BinaryType::Add:
+			case BinaryType::Sub:
+			case BinaryType::Mult:
+			case BinaryType::Div:
+				return isInteger(binary->m_left) && isInteger(binary->m_right);
+			default:
+				return false;
+		}
+	}
+
+	return false;
+}
+
+using Operators::power;
+using Operators::wrap;
+
+/**
+* Whether two constants are equal: numbers by value whatever their type,
+* other constants only to one of the same type.
+*/
+bool constantsEqual(const ASTNode* left, const ASTNode* right) {
+	if (isNumber(left) && isNumber(right)) {
+		if (left->m_kind == ASTKind::Int64 && right->m_kind == ASTKind::Int64) {
+			return intOf(left) == intOf(right);
+		}
+		return floatOf(left) == floatOf(right);
+	}
+
+	if (left->m_kind != right->m_kind) {
+		return false;
+	}
+
+	switch (left->m_kind) {
+		case ASTKind::Bool: return boolOf(left) == boolOf(right);
+		case ASTKind::Char:
+			return static_cast<const ASTNodeChar*>(left)->m_value == static_cast<const ASTNodeChar*>(right)->m_value;
+		case ASTKind::String:
+			return static_cast<const ASTNodeString*>(left)->m_value == static_cast<const ASTNodeString*>(right)->m_value;
+		default: return true; // Nil
+	}
+}
+
+} // namespace
+
+ASTNode* ConstantFolder::fold(ASTNode* root) {
+	foldInto(root);
+	return root;
+}
+
+void ConstantFolder::foldInto(ASTNode*& slot) {
+	m_replaced = false;
+	walk(slot);
+	if (m_replaced) {
+		slot = m_replacement;
+		m_replaced = false;
+	}
+}
+
+void ConstantFolder::replace(ASTNode* by, std::size_t removed) {
+	m_replacement = by;
+	m_replaced = true;
+	m_eliminated += removed;
+}
+
+void ConstantFolder::visit(ASTNodeBinary& node) {
+	foldInto(node.m_left);
+	foldInto(node.m_right);
+
+	ASTNode* left = node.m_left;
+	ASTNode* right = node.m_right;
+	const Token& tok = node.m_tok;
+
+	// x && y and x || y need only a constant x
+	if (node.m_type == BinaryType::And || node.m_type == BinaryType::Or) {
+		if (!is(left, ASTKind::Bool)) {
+			return;
+		}
+
+		bool decides = node.m_type == BinaryType::And ? !boolOf(left) : boolOf(left);
+		if (decides) {
+			replace(left, 1 + countNodes(right));
+		} else if (is(right, ASTKind::Bool)) {
+			replace(right, 2);
+		}
+		return;
+	}
+
+	// Identities that hold for any integer x
+	switch (node.m_type) {
+		case BinaryType::Add:
+		case BinaryType::BitwiseOr:
+		case BinaryType::BitwiseXor:
+			if (isInt(right, 0) && isInteger(left)) {
+				replace(left, 2);
+				return;
+			}
+			if (isInt(left, 0) && isInteger(right)) {
+				replace(right, 2);
+				return;
+			}
+			break;
+		case BinaryType::Mult:
+			if (isInt(right, 1) && isInteger(left)) {
+				replace(left, 2);
+				return;
+			}
+			if (isInt(left, 1) && isInteger(right)) {
+				replace(right, 2);
+				return;
+			}
+			break;
+		case BinaryType::BitwiseAnd:
+			if (isInt(right, -1) && isInteger(left)) {
+				replace(left, 2);
+				return;
+			}
+			if (isInt(left, -1) && isInteger(right)) {
+				replace(right, 2);
+				return;
+			}
+			break;
+		case BinaryType::Sub:
+		case BinaryType::LShift:
+		case BinaryType::RShift:
+			if (isInt(right, 0) && isInteger(left)) {
+				replace(left, 2);
+				return;
+			}
+			break;
+		case BinaryType::Div:
+			if (isInt(right, 1) && isInteger(left)) {
+				replace(left, 2);
+				return;
+			}
+			break;
+		default:
+			break;
+	}
+
+	if (!isConstant(left) || !isConstant(right)) {
+		return;
+	}
+
+	if (node.m_type == BinaryType::Equality || node.m_type == BinaryType::NonEquality) {
+		bool equal = constantsEqual(left, right);
+		replace(m_arena.make<ASTNodeBool>(tok, node.m_type == BinaryType::Equality ? equal : !equal), 2);
+		return;
+	}
+
+	if (!isNumber(left) || !isNumber(right)) {
+		return;
+	}
+
+	bool integers = left->m_kind == ASTKind::Int64 && right->m_kind == ASTKind::Int64;
+	ASTNode* result = nullptr;
+
+	if (integers) {
+		std::int64_t a = intOf(left);
+		std::int64_t b = intOf(right);
+		auto ua = static_cast<std::uint64_t>(a);
+		auto ub = static_cast<std::uint64_t>(b);
+
+		switch (node.m_type) {
+			case BinaryType::Add: result = m_arena.make<ASTNodeInt64>(tok, wrap(ua + ub)); break;
+			case BinaryType::Sub: result = m_arena.make<ASTNodeInt64>(tok, wrap(ua - ub)); break;
+			case BinaryType::Mult: result = m_arena.make<ASTNodeInt64>(tok, wrap(ua * ub)); break;
+			case BinaryType::Div:
+				if (b != 0 && !(a == std::numeric_limits<std::int64_t>::min() && b == -1)) {
+					result = m_arena.make<ASTNodeInt64>(tok, a / b);
+				}
+				break;
+			case BinaryType::Pow:
+				if (b >= 0) {
+					result = m_arena.make<ASTNodeInt64>(tok, power(a, b));
+				} else {
+					result = m_arena.make<ASTNodeFloat64>(tok, std::pow(static_cast<double>(a), static_cast<double>(b)));
+				}
+				break;
+			case BinaryType::Greater: result = m_arena.make<ASTNodeBool>(tok, a > b); break;
+			case BinaryType::GreaterEqual: result = m_arena.make<ASTNodeBool>(tok, a >= b); break;
+			case BinaryType::Less: result = m_arena.make<ASTNodeBool>(tok, a < b); break;
+			case BinaryType::LessEqual: result = m_arena.make<ASTNodeBool>(tok, a <= b); break;
+			case BinaryType::LShift:
+				if (b >= 0 && b < 64) {
+					result = m_arena.make<ASTNodeInt64>(tok, wrap(ua << b));
+				}
+				break;
+			case BinaryType::RShift:
+				if (b >= 0 && b < 64) {
+					result = m_arena.make<ASTNodeInt64>(tok, a >> b);
+				}
+				break;
+			case BinaryType::BitwiseAnd: result = m_arena.make<ASTNodeInt64>(tok, a & b); break;
+			case BinaryType::BitwiseOr: result = m_arena.make<ASTNodeInt64>(tok, a | b); break;
+			case BinaryType::BitwiseXor: result = m_arena.make<ASTNodeInt64>(tok, a ^ b); break;
+			default: break;
+		}
+	} else {
+		double a = floatOf(left);
+		double b = floatOf(right);
+
+		switch (node.m_type) {
+			case BinaryType::Add: result = m_arena.make<ASTNodeFloat64>(tok, a + b); break;
+			case BinaryType::Sub: result = m_arena.make<ASTNodeFloat64>(tok, a - b); break;
+			case BinaryType::Mult: result = m_arena.make<ASTNodeFloat64>(tok, a * b); break;
+			case BinaryType::Div: result = m_arena.make<ASTNodeFloat64>(tok, a / b); break;
+			case BinaryType::Pow: result = m_arena.make<ASTNodeFloat64>(tok, std::pow(a, b)); break;
+			case BinaryType::Greater: result = m_arena.make<ASTNodeBool>(tok, a > b); break;
+			case BinaryType::GreaterEqual: result = m_arena.make<ASTNodeBool>(tok, a >= b); break;
+			case BinaryType::Less: result = m_arena.make<ASTNodeBool>(tok, a < b); break;
+			case BinaryType::LessEqual: result = m_arena.make<ASTNodeBool>(tok, a <= b); break;
+			default: break; // Shifts and bitwise operators take integers only
+		}
+	}
+
+	if (result) {
+		replace(result, 2);
+	}
+}
+
+void ConstantFolder::visit(ASTNodeUnary& node) {
+	foldInto(node.m_branch);
+
+	ASTNode* branch = node.m_branch;
+	const Token& tok = node.m_tok;
+
+	switch (node.m_type) {
+		case UnaryType::Plus:
+			if (isNumber(branch)) {
+				replace(branch, 1);
+			}
+			break;
+		case UnaryType::Negate:
+			if (is(branch, ASTKind::Int64)) {
+				replace(m_arena.make<ASTNodeInt64>(tok, wrap(0 - static_cast<std::uint64_t>(intOf(branch)))), 1);
+			} else if (is(branch, ASTKind::Float64)) {
+				replace(m_arena.make<ASTNodeFloat64>(tok, -floatOf(branch)), 1);
+			}
+			break;
+		case UnaryType::Not:
+			if (is(branch, ASTKind::Bool)) {
+				replace(m_arena.make<ASTNodeBool>(tok, !boolOf(branch)), 1);
+			}
+			break;
+		case UnaryType::BitwiseNot:
+			if (is(branch, ASTKind::Int64)) {
+				replace(m_arena.make<ASTNodeInt64>(tok, ~intOf(branch)), 1);
+			}
+			break;
+	}
+}
+
+void ConstantFolder::visit(ASTNodeVariableInvokation& node) {
+	for (ASTNode*& arg : node.m_args) {
+		foldInto(arg);
+	}
+}
+
+void ConstantFolder::visit(ASTNodeVariableDeclaration& node) {
+	foldInto(node.m_assign);
+}
+
+void ConstantFolder::visit(ASTNodeStatementSet& node) {
+	std::size_t kept = 0;
+	for (ASTNode* statement : node.m_statements) {
+		bool was_null = statement == nullptr;
+		foldInto(statement);
+
+		// Statements that fold away, like an if (false), are dropped
+		if (statement || was_null) {
+			node.m_statements[kept++] = statement;
+		}
+	}
+	node.m_statements = ASTList<ASTNode*>(node.m_statements.begin(), kept);
+}
+
+void ConstantFolder::visit(ASTNodeConditional& node) {
+	std::size_t removed = 0;
+	std::size_t kept = 0;
+	bool always = false;
+
+	for (auto& condition : node.m_conditions) {
+		if (always) {
+			// After a branch that is always taken
+			removed += countNodes(condition.first) + countNodes(condition.second);
+			continue;
+		}
+
+		foldInto(condition.first);
+		foldInto(condition.second);
+
+		if (!is(condition.first, ASTKind::Bool)) {
+			node.m_conditions[kept++] = condition;
+		} else if (boolOf(condition.first)) {
+			// Becomes the else branch
+			removed += 1 + countNodes(node.m_else_statement);
+			node.m_else_statement = condition.second;
+			always = true;
+		} else {
+			removed += countNodes(condition.first) + countNodes(condition.second);
+		}
+	}
+	node.m_conditions = ASTList<ASTNodeConditional::Conditional>(node.m_conditions.begin(), kept);
+
+	if (!always) {
+		foldInto(node.m_else_statement);
+	}
+
+	if (kept == 0) {
+		// Nothing left to test, so only the else branch remains, if any
+		replace(node.m_else_statement, removed + 1);
+	} else {
+		m_eliminated += removed;
+	}
+}
+
+void ConstantFolder::visit(ASTNodeFunctionDefinition& node) {
+	foldInto(node.m_contents);
+}
+
+void ConstantFolder::visit(ASTNodeFunctionReturn& node) {
+	foldInto(node.m_expr);
+}
+
+} // namespace Nitro
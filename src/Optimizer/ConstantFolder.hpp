@@ -0,0 +1,83 @@
+#pragma once
+
+#include <cstddef>
+
+#include "../global/defs.hpp"
+#include "../AST/ASTArena.hpp"
+#include "../AST/ASTWalker.hpp"
+
+namespace Nitro {
+
+/**
+* Simplifies a tree before it is run:
+*
+*  - operators over constants become the constant they evaluate to,
+*  - identities like x + 0 and x * 1 are dropped when x is known to be an
+*    integer,
+*  - branches of a conditional whose condition is a constant false are
+*    removed, and a branch whose condition is a constant true ends the
+*    conditional.
+*
+* Values follow the language's rules, those of Operators: integers are 64
+* bit and wrap around, an operator with a float operand works on floats,
+* and comparisons and logical operators give bools. Anything that would fail at run time, like
+* an integer division by zero or an operand of the wrong type, is left as
+* it is for the error to be raised then.
+*
+* Nodes are rewritten in place, new constants go in the arena the tree was
+* parsed into.
+*/
+class ConstantFolder : public ASTWalker<ConstantFolder> {
+public:
+	NITRO_DISABLE_COPY_MOVE(ConstantFolder)
+
+	ConstantFolder(ASTArena& arena) : m_arena(arena) {}
+
+	/**
+	* Folds the tree under root and returns what replaces root, which is
+	* null if nothing is left of it.
+	*/
+	ASTNode* fold(ASTNode* root);
+
+	/**
+	* Nodes taken out of the trees folded so far.
+	*/
+	std::size_t eliminated() const { return m_eliminated; }
+
+	using ASTWalker<ConstantFolder>::visit;
+
+	void visit(ASTNodeBinary& node);
+
+	void visit(ASTNodeUnary& node);
+
+	void visit(ASTNodeVariableInvokation& node);
+
+	void visit(ASTNodeVariableDeclaration& node);
+
+	void visit(ASTNodeStatementSet& node);
+
+	void visit(ASTNodeConditional& node);
+
+	void visit(ASTNodeFunctionDefinition& node);
+
+	void visit(ASTNodeFunctionReturn& node);
+
+private:
+	/**
+	* Folds the node in slot, replacing it.
+	*/
+	void foldInto(ASTNode*& slot);
+
+	/**
+	* Replaces the node being visited by by, which is null to remove it.
+	* removed is the number of nodes this takes out of the tree.
+	*/
+	void replace(ASTNode* by, std::size_t removed);
+
+	ASTArena& m_arena;
+	ASTNode* m_replacement = nullptr;
+	bool m_replaced = false;
+	std::size_t m_eliminated = 0;
+};
+
+} // namespace Nitro
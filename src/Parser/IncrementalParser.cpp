@@ -0,0 +1,290 @@
+#include "IncrementalParser.hpp"
+
+#include <algorithm>
+#include <iterator>
+#include <string_view>
+#include <utility>
+
+#include "../Lexer/Lexer.hpp"
+#include "Parser.hpp"
+
+namespace Nitro {
+
+namespace {
+
+// The lowest bit set in i, the span of a Fenwick tree entry
+std::size_t lowBit(std::size_t i) {
+	return i & (~i + 1);
+}
+
+/**
+* Replaces count elements of list from at with those from begin to end,
+* moving the elements after them only when the count changes.
+*/
+template <typename T, typename Iterator>
+void replace(std::vector<T>& list, std::size_t at, std::size_t count, Iterator begin, Iterator end) {
+	std::size_t added = static_cast<std::size_t>(std::distance(begin, end));
+	auto out = list.begin() + static_cast<std::ptrdiff_t>(at);
+	if (added > count) {
+		Iterator rest = std::next(begin, static_cast<std::ptrdiff_t>(count));
+		out = std::copy(begin, rest, out);
+		list.insert(out, rest, end);
+	} else {
+		out = std::copy(begin, end, out);
+		list.erase(out, out + static_cast<std::ptrdiff_t>(count - added));
+	}
+}
+
+} // namespace
+
+IncrementalParser::Totals& IncrementalParser::Totals::operator+=(const Totals& other) {
+	bytes += other.bytes;
+	lines += other.lines;
+	nodes += other.nodes;
+	return *this;
+}
+
+IncrementalParser::Totals& IncrementalParser::Totals::operator-=(const Totals& other) {
+	bytes -= other.bytes;
+	lines -= other.lines;
+	nodes -= other.nodes;
+	return *this;
+}
+
+IncrementalParser::IncrementalParser(const SourceBuffer& source, StringInterner* interner, std::ostream& diagnostics)
+	: m_interner(interner),
+	  m_diagnostics(&diagnostics) {
+	std::size_t old_item = 0;
+	m_items = split(source, 0, source.size(), 0, old_item);
+
+	std::size_t line = 1;
+	for (Item& item : m_items) {
+		parse(item, line, *m_diagnostics, m_nodes);
+		line += item.lines;
+	}
+	m_reparsed = source.size();
+
+	buildSums();
+	finish();
+}
+
+std::vector<IncrementalParser::Item> IncrementalParser::split(const SourceBuffer& source, std::size_t begin,
+	std::size_t edit_end, std::int64_t shift, std::size_t& old_item) const {
+	std::string_view text = source.view();
+
+	// Where old_item started in the old text, before the edit and so the
+	// same as in the new one
+	std::size_t old_start = begin;
+	std::size_t stop = text.size();
+
+	std::vector<std::size_t> starts = { begin };
+	Lexer lexer(source, Lexer::Checkpoint{ begin, 1, { 0 }, 0, true });
+	for (;;) {
+		Token token = lexer.next();
+		if (token.type == Token::Type::Eof || token.type == Token::Type::Error) {
+			old_item = m_items.size();
+			break;
+		}
+
+		std::size_t at = static_cast<std::size_t>(token.lexeme.data() - text.data());
+		if (token.type != Token::Type::FuncKeyword || at == begin || text[at - 1] != '\n') {
+			continue;
+		}
+
+		// Past the edit, an item start the old text had too begins the same
+		// text as before, and so do all the items after it
+		if (at > edit_end) {
+			std::size_t old_at = static_cast<std::size_t>(static_cast<std::int64_t>(at) - shift);
+			while (old_item < m_items.size() && old_start < old_at) {
+				old_start += m_items[old_item].text.size();
+				old_item++;
+			}
+			if (old_item < m_items.size() && old_start == old_at) {
+				stop = at;
+				break;
+			}
+		}
+
+		starts.push_back(at);
+	}
+	starts.push_back(stop);
+
+	std::vector<Item> items;
+	for (std::size_t i = 0; i + 1 < starts.size(); i++) {
+		std::string_view item_text = text.substr(starts[i], starts[i + 1] - starts[i]);
+		if (item_text.empty()) {
+			continue;
+		}
+
+		items.push_back(Item{
+			SourceBuffer::fromString(item_text),
+			static_cast<std::size_t>(std::count(item_text.begin(), item_text.end(), '\n')),
+			0,
+			0,
+			0
+		});
+	}
+
+	return items;
+}
+
+void IncrementalParser::parse(Item& item, std::size_t line, std::ostream& diagnostics, std::vector<ASTNode*>& nodes) {
+	std::size_t used = m_arena.bytesUsed();
+
+	// Every item starts on an unindented line
+	Lexer lexer(item.text, Lexer::Checkpoint{ 0, line, { 0 }, 0, true });
+	lexer.setInterner(m_interner);
+	Parser parser(lexer, m_arena);
+	parser.setDiagnostics(diagnostics);
+
+	const auto& statements = static_cast<ASTNodeStatementSet*>(parser.parse())->m_statements;
+	nodes.insert(nodes.end(), statements.begin(), statements.end());
+
+	item.parsed_line = line;
+	item.node_count = statements.size();
+	item.arena_bytes = m_arena.bytesUsed() - used;
+	m_live_bytes += item.arena_bytes;
+}
+
+ASTNode* IncrementalParser::update(const SourceBuffer& source, const Edit& edit) {
+	std::int64_t shift = static_cast<std::int64_t>(edit.new_end) - static_cast<std::int64_t>(edit.old_end);
+
+	// The item holding the start of the edit, the last one for an edit at
+	// the end. An edit right at the start of an item can join it to the one
+	// before, which is then re-parsed too.
+	Totals before;
+	std::size_t first = itemsUpTo(&Totals::bytes, edit.begin, before);
+	if (first == m_items.size() && first > 0) {
+		first--;
+		before -= totalsOf(m_items[first]);
+	}
+	if (first > 0 && before.bytes == edit.begin) {
+		first--;
+		before -= totalsOf(m_items[first]);
+	}
+
+	std::size_t last = first;
+	std::vector<Item> items = split(source, before.bytes, edit.new_end, shift, last);
+
+	std::size_t removed_nodes = 0;
+	for (std::size_t i = first; i < last; i++) {
+		removed_nodes += m_items[i].node_count;
+		m_live_bytes -= m_items[i].arena_bytes;
+	}
+
+	std::vector<ASTNode*> nodes;
+	std::size_t line = before.lines + 1;
+	m_reparsed = 0;
+	for (Item& item : items) {
+		parse(item, line, *m_diagnostics, nodes);
+		line += item.lines;
+		m_reparsed += item.text.size();
+	}
+
+	replace(m_nodes, before.nodes, removed_nodes, nodes.begin(), nodes.end());
+
+	// The sums after the edit only change when items are added or removed
+	bool same_count = items.size() == last - first;
+	if (same_count) {
+		for (std::size_t i = 0; i < items.size(); i++) {
+			Totals delta = totalsOf(items[i]);
+			delta -= totalsOf(m_items[first + i]);
+			addSums(first + i, delta);
+		}
+	}
+	replace(m_items, first, last - first, std::make_move_iterator(items.begin()), std::make_move_iterator(items.end()));
+	if (!same_count) {
+		buildSums();
+	}
+
+	finish();
+	return m_program;
+}
+
+void IncrementalParser::finish() {
+	// Nodes of replaced items are only freed with the whole arena, so once
+	// they take most of it every item is parsed again into a fresh one
+	if (m_arena.bytesUsed() > 2 * m_live_bytes + ASTArena::BLOCK_SIZE) {
+		m_arena.reset();
+		m_live_bytes = 0;
+		m_nodes.clear();
+
+		// Errors were reported when the items were first parsed
+		std::ostream discard(nullptr);
+		std::size_t line = 1;
+		for (Item& item : m_items) {
+			parse(item, line, discard, m_nodes);
+			line += item.lines;
+		}
+		m_program = nullptr;
+	}
+
+	if (!m_program) {
+		Token eof{ Token::Type::Eof, std::string_view{}, 1, 1 };
+		m_program = m_arena.make<ASTNodeStatementSet>(eof, ASTList<ASTNode*>());
+	}
+
+	// The statements are m_nodes itself, so an update moves no more of them
+	// than it has to
+	m_program->m_tok.line = sumsBefore(m_items.size()).lines + 1;
+	m_program->m_statements = ASTList<ASTNode*>(m_nodes.data(), m_nodes.size());
+}
+
+IncrementalParser::Totals IncrementalParser::totalsOf(const Item& item) {
+	return Totals{ item.text.size(), item.lines, item.node_count };
+}
+
+void IncrementalParser::buildSums() {
+	m_sums.assign(m_items.size() + 1, Totals{});
+	for (std::size_t i = 1; i < m_sums.size(); i++) {
+		m_sums[i] += totalsOf(m_items[i - 1]);
+		std::size_t parent = i + lowBit(i);
+		if (parent < m_sums.size()) {
+			m_sums[parent] += m_sums[i];
+		}
+	}
+}
+
+void IncrementalParser::addSums(std::size_t item, const Totals& delta) {
+	for (std::size_t i = item + 1; i < m_sums.size(); i += lowBit(i)) {
+		m_sums[i] += delta;
+	}
+}
+
+IncrementalParser::Totals IncrementalParser::sumsBefore(std::size_t item) const {
+	Totals sums;
+	for (std::size_t i = item; i > 0; i -= lowBit(i)) {
+		sums += m_sums[i];
+	}
+	return sums;
+}
+
+std::size_t IncrementalParser::itemsUpTo(std::size_t Totals::*field, std::size_t limit, Totals& sums) const {
+	sums = Totals{};
+	std::size_t count = 0;
+
+	std::size_t step = 1;
+	while (step * 2 < m_sums.size()) {
+		step *= 2;
+	}
+	for (; step > 0; step /= 2) {
+		std::size_t next = count + step;
+		if (next < m_sums.size() && sums.*field + m_sums[next].*field <= limit) {
+			count = next;
+			sums += m_sums[next];
+		}
+	}
+	return count;
+}
+
+std::size_t IncrementalParser::itemOf(std::size_t index) const {
+	Totals before;
+	return itemsUpTo(&Totals::nodes, index, before);
+}
+
+std::int64_t IncrementalParser::lineShift(std::size_t item) const {
+	std::size_t line = sumsBefore(item).lines + 1;
+	return static_cast<std::int64_t>(line) - static_cast<std::int64_t>(m_items[item].parsed_line);
+}
+
+} // namespace Nitro
@@ -0,0 +1,172 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <vector>
+
+#include "../global/defs.hpp"
+#include "../AST/ASTArena.hpp"
+#include "../AST/ASTNode.hpp"
+#include "../AST/ASTNodeStatementSet.hpp"
+#include "../Lexer/IncrementalLexer.hpp"
+#include "../Lexer/StringInterner.hpp"
+#include "../Source/SourceBuffer.hpp"
+
+namespace Nitro {
+
+/**
+* Keeps the AST of a source that is being edited, re-parsing only the
+* top-level items an edit touches.
+*
+* The source is cut into items right before every function definition on
+* an unindented line, like ParallelParser does. An item is the function and
+* the top-level statements after it, or the statements before the first
+* function. Each item is lexed and parsed on its own, from a copy of its
+* text, so its nodes depend on nothing outside it: after an edit, the items
+* it did not touch keep their nodes as they are.
+*
+* Re-parsing starts at the item holding the edit and stops at the first
+* item start past the edit that the old text had too. Nodes keep the line
+* numbers they were parsed with. An edit that adds or removes lines before
+* an item moves it without touching its nodes, lineShift() says by how much.
+*
+* The sizes of the items are kept as prefix sums, so finding the items an
+* edit touches, or where an item starts, takes O(log items). The items and
+* nodes after an edit only move when it changes how many there are.
+*
+* Unlike Parser, an error does not spill over into the next item: every
+* item reports its own first error. And a node that takes the token after
+* it, like a conditional, gets the item's Eof at the end of an item rather
+* than the next item's func.
+*/
+class IncrementalParser {
+public:
+	NITRO_DISABLE_COPY_MOVE(IncrementalParser)
+
+	using Edit = IncrementalLexer::Edit;
+
+	/**
+	* Parses source in full. Identifiers and string literals are interned
+	* into interner, when given, which must outlive this object. Errors are
+	* written to diagnostics, see setDiagnostics(). The source itself is not
+	* referred to after the call.
+	*/
+	explicit IncrementalParser(const SourceBuffer& source, StringInterner* interner = nullptr,
+		std::ostream& diagnostics = std::cerr);
+
+	/**
+	* Re-parses source, the previous text with edit applied, and returns the
+	* new program. Nodes of the items the edit did not touch are reused.
+	*/
+	ASTNode* update(const SourceBuffer& source, const Edit& edit);
+
+	/**
+	* The ASTNodeStatementSet of every item's top-level nodes. It is the same
+	* node after an update, with its statements changed, until the nodes are
+	* parsed into a fresh arena.
+	*/
+	ASTNode* program() const { return m_program; }
+
+	/**
+	* Where errors of later updates are written, the constructor's
+	* diagnostics until then. out must outlive this object.
+	*/
+	void setDiagnostics(std::ostream& out) { m_diagnostics = &out; }
+
+	std::size_t itemCount() const { return m_items.size(); }
+
+	/**
+	* Index of the item that top-level node index of program() belongs to.
+	*/
+	std::size_t itemOf(std::size_t index) const;
+
+	/**
+	* How many lines the item has moved since its nodes were parsed. A
+	* node's line in the current text is its token's line plus this.
+	*/
+	std::int64_t lineShift(std::size_t item) const;
+
+	/**
+	* Bytes of text parsed by the last update, for diagnostics.
+	*/
+	std::size_t reparsed() const { return m_reparsed; }
+
+private:
+	struct Item {
+		SourceBuffer text;
+		std::size_t lines;       // Newlines in text
+		std::size_t parsed_line; // First line of the item when it was parsed
+		std::size_t node_count;  // Top-level nodes it parsed to
+		std::size_t arena_bytes; // Arena bytes taken by its nodes
+	};
+
+	/**
+	* The sizes of an item, or of consecutive items together.
+	*/
+	struct Totals {
+		std::size_t bytes = 0;
+		std::size_t lines = 0;
+		std::size_t nodes = 0;
+
+		Totals& operator+=(const Totals& other);
+		Totals& operator-=(const Totals& other);
+	};
+
+	/**
+	* Cuts source into items from begin, where old_item started in the old
+	* text, up to the first item start past edit_end that the old text had
+	* too, or the end. old_item is left at the first old item kept.
+	*/
+	std::vector<Item> split(const SourceBuffer& source, std::size_t begin, std::size_t edit_end,
+		std::int64_t shift, std::size_t& old_item) const;
+
+	/**
+	* Parses item as starting on line, appending its top-level nodes to
+	* nodes.
+	*/
+	void parse(Item& item, std::size_t line, std::ostream& diagnostics, std::vector<ASTNode*>& nodes);
+
+	/**
+	* Points program() at m_nodes, after parsing every item again into a
+	* fresh arena once most of the old one is garbage.
+	*/
+	void finish();
+
+	static Totals totalsOf(const Item& item);
+
+	/**
+	* Makes m_sums anew from m_items.
+	*/
+	void buildSums();
+
+	/**
+	* Adds delta to the totals of item in m_sums.
+	*/
+	void addSums(std::size_t item, const Totals& delta);
+
+	/**
+	* Totals of the items before item.
+	*/
+	Totals sumsBefore(std::size_t item) const;
+
+	/**
+	* The most items from the first whose totals' field is at most limit,
+	* with those totals in sums. Every field of an item is at least 0, so
+	* the item after them is the one holding limit.
+	*/
+	std::size_t itemsUpTo(std::size_t Totals::*field, std::size_t limit, Totals& sums) const;
+
+	StringInterner* m_interner;
+	std::ostream* m_diagnostics;
+
+	ASTArena m_arena;
+	std::vector<Item> m_items;
+	std::vector<Totals> m_sums;    // A Fenwick tree of the items' Totals, from 1
+	std::vector<ASTNode*> m_nodes; // Top-level nodes of all items, in order
+	ASTNodeStatementSet* m_program = nullptr;
+	std::size_t m_live_bytes = 0;   // Arena bytes still referred to
+	std::size_t m_reparsed = 0;
+};
+
+} // namespace Nitro
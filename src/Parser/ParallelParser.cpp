@@ -0,0 +1,109 @@
+#include "ParallelParser.hpp"
+
+#include <algorithm>
+#include <string_view>
+#include <thread>
+
+#include "../AST/ASTNodeStatementSet.hpp"
+#include "Parser.hpp"
+
+namespace Nitro {
+
+ParallelParser::ParallelParser(const TokenBuffer& tokens, ASTArena& arena, unsigned threads)
+	: m_tokens(tokens),
+	  m_arena(arena),
+	  m_threads(threads > 0 ? threads : std::max(1u, std::thread::hardware_concurrency())) {}
+
+std::vector<std::size_t> ParallelParser::split() const {
+	std::string_view text = m_tokens.source();
+	std::size_t size = m_tokens.size();
+	std::size_t count = std::min<std::size_t>(m_threads, size / MIN_CHUNK_TOKENS);
+
+	std::vector<std::size_t> bounds = { 0 };
+	for (std::size_t i = 1; i < count; i++) {
+		std::size_t at = std::max(size / count * i, bounds.back() + 1);
+
+		// Cut before the next func that starts an unindented line
+		while (at < size) {
+			std::uint32_t offset = m_tokens.offset(at);
+			if (m_tokens.type(at) == Token::Type::FuncKeyword && (offset == 0 || text[offset - 1] == '\n')) {
+				break;
+			}
+			at++;
+		}
+
+		if (at >= size) {
+			break;
+		}
+		bounds.push_back(at);
+	}
+
+	return bounds;
+}
+
+void ParallelParser::parse(Chunk& chunk) const {
+	Parser parser(m_tokens, chunk.begin, chunk.end, chunk.arena);
+	parser.setDiagnostics(chunk.diagnostics);
+	chunk.program = parser.parse();
+	chunk.had_error = parser.hadError();
+}
+
+ASTNode* ParallelParser::parse() {
+	std::vector<std::size_t> bounds = split();
+
+	if (bounds.size() == 1) {
+		Parser parser(m_tokens, m_arena);
+		parser.setDiagnostics(*m_diagnostics);
+		ASTNode* program = parser.parse();
+		m_had_error = parser.hadError();
+		return program;
+	}
+
+	std::vector<Chunk> chunks(bounds.size());
+	for (std::size_t i = 0; i < bounds.size(); i++) {
+		chunks[i].begin = bounds[i];
+		chunks[i].end = i + 1 < bounds.size() ? bounds[i + 1] : m_tokens.size();
+	}
+
+	std::vector<std::thread> workers;
+	for (std::size_t i = 1; i < chunks.size(); i++) {
+		workers.emplace_back([this, &chunks, i] {
+			parse(chunks[i]);
+		});
+	}
+	parse(chunks[0]);
+	for (std::thread& worker : workers) {
+		worker.join();
+	}
+
+	std::vector<ASTNode*> items;
+	ASTNode* last = nullptr;
+	m_had_error = false;
+	for (Chunk& chunk : chunks) {
+		if (chunk.had_error) {
+			// Whatever comes after the error depends on how the parser
+			// recovered from it, so from here on parse like Parser would
+			Parser parser(m_tokens, chunk.begin, m_tokens.size(), m_arena);
+			parser.setDiagnostics(*m_diagnostics);
+			last = parser.parse();
+			m_had_error = parser.hadError();
+			const auto& statements = static_cast<ASTNodeStatementSet*>(last)->m_statements;
+			items.insert(items.end(), statements.begin(), statements.end());
+			break;
+		}
+
+		*m_diagnostics << chunk.diagnostics.str();
+		last = chunk.program;
+		const auto& statements = static_cast<ASTNodeStatementSet*>(last)->m_statements;
+		items.insert(items.end(), statements.begin(), statements.end());
+	}
+
+	for (Chunk& chunk : chunks) {
+		m_arena.adopt(std::move(chunk.arena));
+	}
+
+	// Parser places the program at the Eof token, as does the last chunk
+	return m_arena.make<ASTNodeStatementSet>(last->m_tok, m_arena.list(items.data(), items.size()));
+}
+
+} // namespace Nitro
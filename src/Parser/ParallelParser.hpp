@@ -0,0 +1,86 @@
+#pragma once
+
+#include <cstddef>
+#include <iostream>
+#include <sstream>
+#include <vector>
+
+#include "../global/defs.hpp"
+#include "../AST/ASTArena.hpp"
+#include "../AST/ASTNode.hpp"
+#include "../Lexer/TokenBuffer.hpp"
+
+namespace Nitro {
+
+/**
+* Parses a large token buffer on several threads. The tree and the
+* diagnostics are the same as Parser::parse()'s, but for one detail: a node
+* placed at the token after it, like a conditional, that ends a chunk holds
+* the next chunk's func typed as an Eof.
+*
+* The tokens are cut into chunks right before function definitions on an
+* unindented line. If the source parses, those are all places where the
+* parser is between two top-level items with nothing on its stacks, so each
+* chunk can be parsed on its own, into an arena of its own, and the items of
+* the chunks joined into one program.
+*
+* A chunk that does not parse is where a serial parser reports its error, or
+* after it. The diagnostics of the chunks before it are written out in order,
+* and the rest of the source is parsed serially from the chunk's start, so
+* the error and the nodes after it are exactly what Parser would give.
+*/
+class ParallelParser {
+public:
+	NITRO_DISABLE_COPY_MOVE(ParallelParser)
+
+	/**
+	* Buffers are not split into chunks of fewer tokens than this.
+	*/
+	static constexpr std::size_t MIN_CHUNK_TOKENS = 64 * 1024;
+
+	/**
+	* threads is the most threads to parse on, 0 picks the number of
+	* hardware threads. The nodes go in arena, which takes over the arenas of
+	* the chunks. The tokens must outlive the parser.
+	*/
+	ParallelParser(const TokenBuffer& tokens, ASTArena& arena, unsigned threads = 0);
+
+	ASTNode* parse();
+
+	/**
+	* Where errors and warnings are written, std::cerr by default. out must
+	* outlive the parser.
+	*/
+	void setDiagnostics(std::ostream& out) { m_diagnostics = &out; }
+
+	/**
+	* Whether the last parse() reported an error, as Parser::hadError().
+	*/
+	bool hadError() const { return m_had_error; }
+
+private:
+	struct Chunk {
+		std::size_t begin;
+		std::size_t end;
+
+		ASTArena arena;
+		ASTNode* program = nullptr;
+		std::ostringstream diagnostics;
+		bool had_error = false;
+	};
+
+	/**
+	* Picks the chunk boundaries, at most one chunk per thread.
+	*/
+	std::vector<std::size_t> split() const;
+
+	void parse(Chunk& chunk) const;
+
+	const TokenBuffer& m_tokens;
+	ASTArena& m_arena;
+	unsigned m_threads;
+	std::ostream* m_diagnostics = &std::cerr;
+	bool m_had_error = false;
+};
+
+} // namespace Nitro
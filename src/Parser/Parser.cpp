@@ -1,58 +1,176 @@
 #include "Parser.hpp"
 
+#include <array>
 #include <cctype>
 #include <sstream>
 
 #include "../AST/ASTNodeBinary.hpp"
 #include "../AST/ASTNodeUnary.hpp"
-#include "../AST/ASTNodeConstant.hpp"
-#include "../AST/ASTNodeNil.hpp"
-#include "../AST/ASTNodeVariableInvokation.hpp"
-#include "../AST/ASTNodeVariableDeclaration.hpp"
-#include "../AST/ASTNodeStatementSet.hpp"
-#include "../AST/ASTNodeConditional.hpp"
-#include "../AST/ASTNodeFunctionDefinition.hpp"
-#include "../AST/ASTNodeFunctionReturn.hpp"
 
 namespace Nitro {
 
-Parser::Parser(Lexer& lexer) : m_lexer(lexer) {
-	m_previous = m_current = m_lexer.next();
-	m_next = m_lexer.next();
-	m_ast      = nullptr;
+namespace {
+
+/**
+* How a token binds as a binary operator. Higher precedences bind tighter,
+* 0 is for tokens that are not binary operators and ends an expression.
+*/
+struct BinaryOperator {
+	unsigned precedence;
+	ASTNodeBinary::Type type;
+};
+
+constexpr std::size_t TOKEN_TYPE_COUNT = static_cast<std::size_t>(Token::Type::Error) + 1;
+
+constexpr std::array<BinaryOperator, TOKEN_TYPE_COUNT> makeBinaryOperators() {
+	using Type = ASTNodeBinary::Type;
+
+	std::array<BinaryOperator, TOKEN_TYPE_COUNT> table{};
+	auto set = [&table](Token::Type token, unsigned precedence, Type type) {
+		table[static_cast<std::size_t>(token)] = BinaryOperator{ precedence, type };
+	};
+
+	set(Token::Type::PipePipe, 1, Type::Or);
+	set(Token::Type::AndAnd, 1, Type::And);
+
+	set(Token::Type::Pipe, 2, Type::BitwiseOr);
+	set(Token::Type::And, 2, Type::BitwiseAnd);
+	set(Token::Type::Carat, 2, Type::BitwiseXor);
+
+	set(Token::Type::EqualEqual, 3, Type::Equality);
+	set(Token::Type::NotEqual, 3, Type::NonEquality);
+
+	set(Token::Type::Greater, 4, Type::Greater);
+	set(Token::Type::GreaterEqual, 4, Type::GreaterEqual);
+	set(Token::Type::Less, 4, Type::Less);
+	set(Token::Type::LessEqual, 4, Type::LessEqual);
+
+	set(Token::Type::GreaterGreater, 5, Type::RShift);
+	set(Token::Type::LessLess, 5, Type::LShift);
+
+	set(Token::Type::Plus, 6, Type::Add);
+	set(Token::Type::Minus, 6, Type::Sub);
+
+	set(Token::Type::Star, 7, Type::Mult);
+	set(Token::Type::Slash, 7, Type::Div);
+
+	set(Token::Type::StarStar, 8, Type::Pow);
+
+	return table;
+}
+
+constexpr std::array<BinaryOperator, TOKEN_TYPE_COUNT> BINARY_OPERATORS = makeBinaryOperators();
+
+static_assert(BINARY_OPERATORS[static_cast<std::size_t>(Token::Type::Eol)].precedence == 0,
+	"Eol must end an expression");
+
+} // namespace
+
+template <typename Builder>
+BasicParser<Builder>::BasicParser(Lexer& lexer, Builder builder) : m_lexer(&lexer), m_builder(builder) {
+	m_previous = m_current = pull();
+	m_next = pull();
 	m_had_error = false;
 	m_panic_mode = false;
 }
 
-std::unique_ptr<ASTNode> Parser::parse() {
+template <typename Builder>
+BasicParser<Builder>::BasicParser(const TokenBuffer& tokens, Builder builder)
+	: m_lexer(nullptr), m_tokens(&tokens), m_reader(tokens), m_builder(builder) {
+	m_previous = m_current = pull();
+	m_current_index = m_next_index;
+	m_next = pull();
+	m_had_error = false;
+	m_panic_mode = false;
+}
+
+template <typename Builder>
+BasicParser<Builder>::BasicParser(const TokenBuffer& tokens, std::size_t begin, std::size_t end, Builder builder)
+	: m_lexer(nullptr), m_tokens(&tokens), m_reader(tokens, begin, end), m_builder(builder) {
+	m_previous = m_current = pull();
+	m_current_index = m_next_index;
+	m_next = pull();
+	m_had_error = false;
+	m_panic_mode = false;
+}
+
+template <typename Builder>
+BasicParser<Builder>::BasicParser(StreamLexer& lexer, Builder builder)
+	: m_lexer(nullptr), m_stream(&lexer), m_builder(builder) {
+	lexer.retain();
+	m_previous = m_current = pull();
+	m_next = pull();
+	m_had_error = false;
+	m_panic_mode = false;
+}
+
+template <typename Builder>
+auto BasicParser<Builder>::parse() -> Node {
 	return parseTopLevel();
 }
 
-std::unique_ptr<ASTNode> Parser::parseTopLevel() {
-	std::vector<std::unique_ptr<ASTNode>> program;
+template <typename Builder>
+auto BasicParser<Builder>::parseNext() -> Node {
+	if (m_stream) {
+		// m_previous, m_current and m_next are the last tokens returned
+		m_stream->release(3);
+	}
+
+	while (!match(Token::Type::Eof)) {
+		if (match(Token::Type::Eol)) {
+			continue;
+		} else if (match(Token::Type::FuncKeyword)) {
+			return parseFunctionDefinition();
+		} else if (peek(Token::Type::Dedent)) {
+			errorCurrent("Unexpected lower indentation level");
+		} else if (Node node = parseStatement(); node != Builder::NONE) {
+			return node;
+		}
+	}
+
+	return Builder::NONE;
+}
+
+template <typename Builder>
+auto BasicParser<Builder>::parseBody(const TokenBuffer& tokens, std::size_t body, Builder builder) -> Node {
+	BasicParser parser(tokens, body, tokens.size(), builder);
+	return parser.parseStatements();
+}
+
+template <typename Builder>
+auto BasicParser<Builder>::parseTopLevel() -> Node {
+	std::size_t program = m_node_stack.size();
 
 	while (!match(Token::Type::Eof)) {
 		if (match(Token::Type::FuncKeyword)) {
-			program.push_back(parseFunctionDefinition());
+			m_node_stack.push_back(parseFunctionDefinition());
+		} else if (peek(Token::Type::Dedent)) {
+			// Left behind by a block that failed to parse. parseStatements()
+			// stops at it without taking it, so skip it here.
+			errorCurrent("Unexpected lower indentation level");
 		} else {
-			program.push_back(parseStatements());
+			m_node_stack.push_back(parseStatements());
 		}
 	}
 
-	return std::make_unique<ASTNodeStatementSet>(m_current, std::move(program));
+	Node node = m_builder.statementSet(m_current, m_node_stack.data() + program, m_node_stack.size() - program);
+	m_node_stack.resize(program);
+	return node;
 }
 
-std::unique_ptr<ASTNode> Parser::parseFunctionDefinition() {
+template <typename Builder>
+auto BasicParser<Builder>::parseFunctionDefinition() -> Node {
 	consume(Token::Type::Identifier, "Expected identifier for function definition");
 	Token identifier = m_previous;
 	consume(Token::Type::OpenParen, "Expected '(' after function identifier");
 
-	std::vector<std::string_view> args;
+	std::size_t args = m_arg_stack.size();
 	while (match(Token::Type::Eol) || match(Token::Type::Indent) || match(Token::Type::Dedent)) {}
 	if (peek(Token::Type::Identifier)) {
 		while (consume(Token::Type::Identifier, "Expected identifier for function argument")) {
 
-			args.push_back(m_previous.lexeme);
+			m_arg_stack.push_back(m_previous.lexeme);
+			m_arg_symbol_stack.push_back(m_previous.symbol);
 
 			while (match(Token::Type::Eol) || match(Token::Type::Indent) || match(Token::Type::Dedent)) {}
 			if (match(Token::Type::Comma)) {
@@ -69,20 +187,45 @@ std::unique_ptr<ASTNode> Parser::parseFunctionDefinition() {
 	consume(Token::Type::Eol, "Expected newline");
 	consume(Token::Type::Indent, "Expected new indentation level after function definition");
 
+	Node node;
+	if constexpr (Builder::LAZY_BODIES) {
+		if (m_lazy_bodies && m_tokens) {
+			std::size_t body = m_current_index;
+			skipBody();
+			consume(Token::Type::Dedent, "Expected lower indentation level after function definition");
+
+			node = m_builder.lazyFunctionDefinition(
+				identifier,
+				m_arg_stack.data() + args,
+				m_arg_symbol_stack.data() + args,
+				m_arg_stack.size() - args,
+				static_cast<std::uint32_t>(body)
+			);
+			m_arg_stack.resize(args);
+			m_arg_symbol_stack.resize(args);
+			return node;
+		}
+	}
+
 	auto contents = parseStatements();
 
 	consume(Token::Type::Dedent, "Expected lower indentation level after function definition");
 
-	return std::make_unique<ASTNodeFunctionDefinition>(
-		identifier, 
-		identifier.lexeme, 
-		std::move(args),
-		std::move(contents)
+	node = m_builder.functionDefinition(
+		identifier,
+		m_arg_stack.data() + args,
+		m_arg_symbol_stack.data() + args,
+		m_arg_stack.size() - args,
+		contents
 	);
+	m_arg_stack.resize(args);
+	m_arg_symbol_stack.resize(args);
+	return node;
 }
 
-std::unique_ptr<ASTNode> Parser::parseStatements() {
-	std::vector<std::unique_ptr<ASTNode>> statements;
+template <typename Builder>
+auto BasicParser<Builder>::parseStatements() -> Node {
+	std::size_t statements = m_node_stack.size();
 	Token beginning = m_current;
 
 	while (true) {
@@ -96,14 +239,48 @@ std::unique_ptr<ASTNode> Parser::parseStatements() {
 		} else if (peek(Token::Type::FuncKeyword)) {
 			break; // TODO: implement better fix
 		} else {
-			statements.push_back(parseStatement());
+			m_node_stack.push_back(parseStatement());
+		}
+	}
+
+	Node node = m_builder.statementSet(beginning, m_node_stack.data() + statements, m_node_stack.size() - statements);
+	m_node_stack.resize(statements);
+	return node;
+}
+
+template <typename Builder>
+void BasicParser<Builder>::skipBody() {
+	// Every block in the body opens with an Indent and closes with a
+	// Dedent, so the body ends at the first Dedent without an Indent
+	std::size_t index = m_current_index;
+	unsigned depth = 0;
+	for (; index < m_tokens->size(); index++) {
+		Token::Type type = m_tokens->type(index);
+		if (type == Token::Type::Indent) {
+			depth++;
+		} else if (type == Token::Type::Dedent) {
+			if (depth == 0) {
+				break;
+			}
+			depth--;
+		} else if (type == Token::Type::Eof || type == Token::Type::Error) {
+			break;
 		}
 	}
 
-	return std::make_unique<ASTNodeStatementSet>(beginning, std::move(statements));
+	if (index == m_current_index) {
+		return;
+	}
+
+	m_previous = m_current;
+	m_reader.seek(index);
+	m_current = pull();
+	m_current_index = m_next_index;
+	m_next = pull();
 }
 
-std::unique_ptr<ASTNode> Parser::parseStatement() {
+template <typename Builder>
+auto BasicParser<Builder>::parseStatement() -> Node {
 	if (match(Token::Type::LetKeyword)) {
 		return parseVariableDeclaration();
 	} else if (match(Token::Type::IfKeyword)) {
@@ -115,27 +292,27 @@ std::unique_ptr<ASTNode> Parser::parseStatement() {
 	}
 }
 
-std::unique_ptr<ASTNode> Parser::parseReturnStatement() {
-	std::unique_ptr<ASTNode> expr;
+template <typename Builder>
+auto BasicParser<Builder>::parseReturnStatement() -> Node {
+	Node expr;
 	Token start = m_previous;
 
 	if (peek(Token::Type::Eol)) {
 		/* Returns nothing */
-		expr = nullptr;
+		expr = Builder::NONE;
 	} else {
 		expr = parseExpression();
 	}
 
 	consume(Token::Type::Eol, "Expected newline after return statement");
 
-	return std::make_unique<ASTNodeFunctionReturn>(start, std::move(expr));
+	return m_builder.functionReturn(start, expr);
 }
 
-std::unique_ptr<ASTNode> Parser::parseConditional() {
-	using Conditional = ASTNodeConditional::Conditional;
-
-	std::vector<Conditional> conditions;
-	std::unique_ptr<ASTNode> else_condition = false;
+template <typename Builder>
+auto BasicParser<Builder>::parseConditional() -> Node {
+	std::size_t conditions = m_condition_stack.size();
+	Node else_condition = Builder::NONE;
 
 	bool has_else = false;
 	for (;;) {
@@ -152,7 +329,7 @@ std::unique_ptr<ASTNode> Parser::parseConditional() {
 
 		consume(Token::Type::Dedent, "Expected lower indentation level at end of conditional scope");
 
-		conditions.push_back(Conditional{ std::move(expr), std::move(statements) });
+		m_condition_stack.emplace_back(expr, statements);
 
 		if (match(Token::Type::ElseKeyword)) {
 			if (match(Token::Type::IfKeyword)) {
@@ -174,30 +351,35 @@ std::unique_ptr<ASTNode> Parser::parseConditional() {
 		consume(Token::Type::Dedent, "Expected lower indentation level at end of conditional scope");
 	}
 
-	return std::make_unique<ASTNodeConditional>(m_current, std::move(conditions), std::move(else_condition));
+	Node node = m_builder.conditional(
+		m_current,
+		m_condition_stack.data() + conditions,
+		m_condition_stack.size() - conditions,
+		else_condition
+	);
+	m_condition_stack.resize(conditions);
+	return node;
 }
 
-std::unique_ptr<ASTNode> Parser::parseVariableDeclaration() {
+template <typename Builder>
+auto BasicParser<Builder>::parseVariableDeclaration() -> Node {
 	Token identifier = m_current;
 	if (!match(Token::Type::Identifier)) {
 		errorCurrent("Expected identifier");
 	}
 
-	std::unique_ptr<ASTNode> expr;
+	Node expr;
 	if (match(Token::Type::Equal)) {
 		expr = parseExpression();
 	} else {
-		expr = std::make_unique<ASTNodeNil>(m_current);
+		expr = m_builder.nil(m_current);
 	}
 
-	return std::make_unique<ASTNodeVariableDeclaration>(
-		identifier, 
-		identifier.lexeme, 
-		std::move(expr)
-	);
+	return m_builder.variableDeclaration(identifier, expr);
 }
 
-std::unique_ptr<ASTNode> Parser::parseExpressionStatement() {
+template <typename Builder>
+auto BasicParser<Builder>::parseExpressionStatement() -> Node {
 	auto expr = parseExpression();
 
 	if (!match(Token::Type::Eol)) {
@@ -207,345 +389,169 @@ std::unique_ptr<ASTNode> Parser::parseExpressionStatement() {
 	return expr;
 }
 
-std::unique_ptr<ASTNode> Parser::parseExpression() {
-	return parseOrAnd();
-}
-
-std::unique_ptr<ASTNode> Parser::parseOrAnd() {
-	auto lhs = parseBitwiseOrAndXor();
+template <typename Builder>
+auto BasicParser<Builder>::parseExpression() -> Node {
+	// Parentheses, calls and operators waiting for their right hand side go
+	// on m_frames instead of the call stack, so nesting is only limited by
+	// memory. Frames below base belong to nobody here.
+	std::size_t base = m_frames.size();
+	Node operand;
 
 	for (;;) {
-		if (match(Token::Type::PipePipe)) {
-			auto rhs = parseBitwiseOrAndXor();
-			lhs = std::make_unique<ASTNodeBinary>(
-				m_previous,
-				ASTNodeBinary::Type::Or,
-				std::move(lhs),
-				std::move(rhs)
-				);
-		}
-		else if (match(Token::Type::AndAnd)) {
-			auto rhs = parseBitwiseOrAndXor();
-			lhs = std::make_unique<ASTNodeBinary>(
-				m_previous,
-				ASTNodeBinary::Type::And,
-				std::move(lhs),
-				std::move(rhs)
-				);
-		} else {
-			break;
-		}
-	}
-
-	return lhs;
-}
-
-std::unique_ptr<ASTNode> Parser::parseBitwiseOrAndXor() {
-	auto lhs = parseEqualNotEqual();
-
-	for (;;) {
-		if (match(Token::Type::Pipe)) {
-			auto rhs = parseEqualNotEqual();
-			lhs = std::make_unique<ASTNodeBinary>(
-				m_previous,
-				ASTNodeBinary::Type::BitwiseOr,
-				std::move(lhs),
-				std::move(rhs)
-				);
-		}
-		else if (match(Token::Type::And)) {
-			auto rhs = parseEqualNotEqual();
-			lhs = std::make_unique<ASTNodeBinary>(
-				m_previous,
-				ASTNodeBinary::Type::BitwiseAnd,
-				std::move(lhs),
-				std::move(rhs)
-				);
-		} else if (match(Token::Type::Carat)) {
-			auto rhs = parseEqualNotEqual();
-			lhs = std::make_unique<ASTNodeBinary>(
-				m_previous,
-				ASTNodeBinary::Type::BitwiseXor,
-				std::move(lhs),
-				std::move(rhs)
-			);
-		} else {
-			break;
-		}
-	}
-
-	return lhs;
-}
-
-std::unique_ptr<ASTNode> Parser::parseEqualNotEqual() {
-	auto lhs = parseGreaterLessAndEqual();
+		// Prefix operators and open parentheses, up to an operand
+		if (match(Token::Type::Plus)) {
+			// This one doesn't actually do anything
+			pushFrame(Frame::Kind::Prefix, m_previous, static_cast<std::uint8_t>(ASTNodeUnary::Type::Plus));
+			continue;
+		} else if (match(Token::Type::Minus)) {
+			pushFrame(Frame::Kind::Prefix, m_previous, static_cast<std::uint8_t>(ASTNodeUnary::Type::Negate));
+			continue;
+		} else if (match(Token::Type::Not)) {
+			pushFrame(Frame::Kind::Prefix, m_previous, static_cast<std::uint8_t>(ASTNodeUnary::Type::Not));
+			continue;
+		} else if (match(Token::Type::Tilde)) {
+			pushFrame(Frame::Kind::Prefix, m_previous, static_cast<std::uint8_t>(ASTNodeUnary::Type::BitwiseNot));
+			continue;
+		} else if (match(Token::Type::OpenParen)) {
+			pushFrame(Frame::Kind::Group, m_previous);
+			continue;
+		} else if (match(Token::Type::Identifier)) {
+			Token tok = m_previous;
 
-	for (;;) {
-		if (match(Token::Type::EqualEqual)) {
-			auto rhs = parseGreaterLessAndEqual();
-			lhs = std::make_unique<ASTNodeBinary>(
-				m_previous,
-				ASTNodeBinary::Type::Equality,
-				std::move(lhs),
-				std::move(rhs)
-				);
-		}
-		else if (match(Token::Type::NotEqual)) {
-			auto rhs = parseGreaterLessAndEqual();
-			lhs = std::make_unique<ASTNodeBinary>(
-				m_previous,
-				ASTNodeBinary::Type::NonEquality,
-				std::move(lhs),
-				std::move(rhs)
-				);
+			// TODO: implement system for no parenthesis function calls
+			if (!match(Token::Type::OpenParen)) {
+				operand = m_builder.variableInvokation(tok, nullptr, 0, false);
+			} else {
+				pushFrame(Frame::Kind::Call, tok);
+				m_frames.back().mark = m_node_stack.size();
+				if (!peek(Token::Type::CloseParen) && beginArgument()) {
+					continue;
+				}
+				operand = closeCall();
+			}
 		} else {
-			break;
+			operand = parseLiteral();
 		}
-	}
 
-	return lhs;
-}
-
-std::unique_ptr<ASTNode> Parser::parseGreaterLessAndEqual() {
-	auto lhs = parseLShiftRShift();
+		// The operand is complete, so are the frames it closes
+		for (;;) {
+			// Prefix operators bind tighter than any binary operator
+			while (m_frames.size() > base && m_frames.back().kind == Frame::Kind::Prefix) {
+				Frame& frame = m_frames.back();
+				operand = m_builder.unary(frame.tok, static_cast<ASTNodeUnary::Type>(frame.op), operand);
+				m_frames.pop_back();
+			}
 
-	for (;;) {
-		if (match(Token::Type::Greater)) {
-			auto rhs = parseLShiftRShift();
-			lhs = std::make_unique<ASTNodeBinary>(
-				m_previous,
-				ASTNodeBinary::Type::Greater,
-				std::move(lhs),
-				std::move(rhs)
-				);
-		} else if (match(Token::Type::GreaterEqual)) {
-			auto rhs = parseLShiftRShift();
-			lhs = std::make_unique<ASTNodeBinary>(
-				m_previous,
-				ASTNodeBinary::Type::GreaterEqual,
-				std::move(lhs),
-				std::move(rhs)
-				);
-		} else if (match(Token::Type::Less)) {
-			auto rhs = parseLShiftRShift();
-			lhs = std::make_unique<ASTNodeBinary>(
-				m_previous,
-				ASTNodeBinary::Type::Less,
-				std::move(lhs),
-				std::move(rhs)
-				);
-		} else if (match(Token::Type::LessEqual)) {
-			auto rhs = parseLShiftRShift();
-			lhs = std::make_unique<ASTNodeBinary>(
-				m_previous,
-				ASTNodeBinary::Type::LessEqual,
-				std::move(lhs),
-				std::move(rhs)
-				);
-		} else {
-			break;
-		}
-	}
+			BinaryOperator op = BINARY_OPERATORS[static_cast<std::size_t>(m_current.type)];
+			if (op.precedence > 0) {
+				// Every operator is left associative, so the operators
+				// waiting with the same or a higher precedence take the
+				// operand first
+				reduceBinary(base, op.precedence, operand);
+				advance();
+				pushFrame(Frame::Kind::Binary, m_previous, static_cast<std::uint8_t>(op.type));
+				m_frames.back().precedence = op.precedence;
+				m_frames.back().lhs = operand;
+				break;
+			}
 
-	return lhs;
-}
+			reduceBinary(base, 1, operand);
+			if (m_frames.size() == base) {
+				return operand;
+			}
 
-std::unique_ptr<ASTNode> Parser::parseLShiftRShift() {
-	auto lhs = parsePlusMinus();
+			if (m_frames.back().kind == Frame::Kind::Group) {
+				m_frames.pop_back();
+				if (!match(Token::Type::CloseParen)) {
+					errorCurrent("Expected ')' at end of expression");
+					operand = Builder::NONE;
+				}
+				continue;
+			}
 
-	for (;;) {
-		if (match(Token::Type::GreaterGreater)) {
-			auto rhs = parsePlusMinus();
-			lhs = std::make_unique<ASTNodeBinary>(
-				m_previous,
-				ASTNodeBinary::Type::RShift,
-				std::move(lhs),
-				std::move(rhs)
-				);
-		}
-		else if (match(Token::Type::LessLess)) {
-			auto rhs = parsePlusMinus();
-			lhs = std::make_unique<ASTNodeBinary>(
-				m_previous,
-				ASTNodeBinary::Type::LShift,
-				std::move(lhs),
-				std::move(rhs)
-				);
-		}
-		else {
-			break;
+			// The end of a call argument
+			m_node_stack.push_back(operand);
+			while (match(Token::Type::Eol) || match(Token::Type::Indent) || match(Token::Type::Dedent)) {}
+			if (match(Token::Type::Comma) && beginArgument()) {
+				break;
+			}
+			operand = closeCall();
 		}
 	}
-
-	return lhs;
 }
 
-std::unique_ptr<ASTNode> Parser::parsePlusMinus() {
-	auto lhs = parseMultiplyDivide();
-
-	for (;;) {
-		if (match(Token::Type::Plus)) {
-			auto rhs = parseMultiplyDivide();
-			lhs = std::make_unique<ASTNodeBinary>(
-				m_previous,
-				ASTNodeBinary::Type::Add,
-				std::move(lhs),
-				std::move(rhs)
-			);
-		} else if (match(Token::Type::Minus)) {
-			auto rhs = parseMultiplyDivide();
-			lhs = std::make_unique<ASTNodeBinary>(
-				m_previous,
-				ASTNodeBinary::Type::Sub,
-				std::move(lhs),
-				std::move(rhs)
-			);
-		} else {
+template <typename Builder>
+void BasicParser<Builder>::reduceBinary(std::size_t base, unsigned min_precedence, Node& operand) {
+	while (m_frames.size() > base) {
+		Frame& frame = m_frames.back();
+		if (frame.kind != Frame::Kind::Binary || frame.precedence < min_precedence) {
 			break;
 		}
-	}
-
-	return lhs;
-}
 
-std::unique_ptr<ASTNode> Parser::parseMultiplyDivide() {
-	auto lhs = parsePow();
-
-	for (;;) {
-		if (match(Token::Type::Star)) {
-			auto rhs = parsePow();
-			lhs = std::make_unique<ASTNodeBinary>(
-				m_previous,
-				ASTNodeBinary::Type::Mult,
-				std::move(lhs),
-				std::move(rhs)
-			);
-		} else if (match(Token::Type::Slash)) {
-			auto rhs = parsePow();
-			lhs = std::make_unique<ASTNodeBinary>(
-				m_previous,
-				ASTNodeBinary::Type::Div,
-				std::move(lhs),
-				std::move(rhs)
-			);
-		} else {
-			break;
-		}
+		operand = m_builder.binary(frame.tok, static_cast<ASTNodeBinary::Type>(frame.op), frame.lhs, operand);
+		m_frames.pop_back();
 	}
-
-	return lhs;
 }
 
-std::unique_ptr<ASTNode> Parser::parsePow() {
-	auto lhs = parsePrefix();
-
-	for (;;) {
-		if (match(Token::Type::StarStar)) {
-			auto rhs = parsePrefix();
-			lhs = std::make_unique<ASTNodeBinary>(
-				m_previous,
-				ASTNodeBinary::Type::Pow,
-				std::move(lhs),
-				std::move(rhs)
-			);
-		} else {
-			break;
-		} 
+template <typename Builder>
+bool BasicParser<Builder>::beginArgument() {
+	if (match(Token::Type::Eof)) {
+		return false;
 	}
 
-	return lhs;
+	// This is a bit of a hack
+	while (match(Token::Type::Eol) || match(Token::Type::Indent) || match(Token::Type::Dedent)) {}
+	return true;
 }
 
-std::unique_ptr<ASTNode> Parser::parsePrefix() {
-	if (match(Token::Type::Plus)) {
-		// This one doesn't actually do anything
-		return std::make_unique<ASTNodeUnary>(
-			m_previous,
-			ASTNodeUnary::Type::Plus,
-			parsePrefix()
-		);
-	} else if (match(Token::Type::Minus)) {
-		return std::make_unique<ASTNodeUnary>(
-			m_previous,
-			ASTNodeUnary::Type::Negate,
-			parsePrefix()		
-		);
-	} else if (match(Token::Type::Not)) {
-		return std::make_unique<ASTNodeUnary>(
-			m_previous,
-			ASTNodeUnary::Type::Not,
-			parsePrefix()
-		);
-	} else if (match(Token::Type::Tilde)) {
-		return std::make_unique<ASTNodeUnary>(
-			m_previous,
-			ASTNodeUnary::Type::BitwiseNot,
-			parsePrefix()
-		);
+template <typename Builder>
+auto BasicParser<Builder>::closeCall() -> Node {
+	if (!match(Token::Type::CloseParen)) {
+		errorCurrent("Expected ')' after function call");
 	}
 
-	return parsePrimary();
+	Frame& frame = m_frames.back();
+	std::size_t args = frame.mark;
+	Node node = m_builder.variableInvokation(frame.tok, m_node_stack.data() + args, m_node_stack.size() - args, true);
+	m_node_stack.resize(args);
+	m_frames.pop_back();
+	return node;
 }
 
-std::unique_ptr<ASTNode> Parser::parsePrimary() {
+template <typename Builder>
+auto BasicParser<Builder>::parseLiteral() -> Node {
 	if (match(Token::Type::FloatLiteral)) {
 		double value = std::strtod(m_previous.lexeme.data(), nullptr);
-		return std::make_unique<ASTNodeFloat64>(m_previous, value);		
+		return m_builder.floating(m_previous, value);
 	} else if (match(Token::Type::IntegerLiteral)) {
 		std::int64_t value = std::strtoll(m_previous.lexeme.data(), nullptr, 10);
-		return std::make_unique<ASTNodeInt64>(m_previous, value);
+		return m_builder.integer(m_previous, value);
 	} else if (match(Token::Type::TrueKeyword)) {
-		return std::make_unique<ASTNodeBool>(m_previous, true);
+		return m_builder.boolean(m_previous, true);
 	} else if (match(Token::Type::FalseKeyword)) {
-		return std::make_unique<ASTNodeBool>(m_previous, false);
+		return m_builder.boolean(m_previous, false);
 	} else if (match(Token::Type::NilKeyword)) {
-		return std::make_unique<ASTNodeNil>(m_previous);
+		return m_builder.nil(m_previous);
 	} else if (match(Token::Type::CharLiteral)) {
-		return std::make_unique<ASTNodeChar>(m_previous, m_previous.lexeme[0]);
+		return m_builder.character(m_previous, m_previous.lexeme[0]);
 	} else if (match(Token::Type::StringLiteral)) {
-		return std::make_unique<ASTNodeString>(m_previous, m_previous.lexeme);
-	} else if (match(Token::Type::OpenParen)) {
-		auto expr = parseExpression();
-		if (!match(Token::Type::CloseParen)) {
-			std::cerr << "Expected ')' at end of expression" << std::endl;
-			return nullptr;
-		}
-		return expr;
-	} else if (match(Token::Type::Identifier)) {
-		return parseVariableCall();
+		return m_builder.string(m_previous);
 	} else {
 		std::string msg = std::string{ "Unexpected '" } + std::string{ m_current.lexeme } + std::string{"'"};
 		errorCurrent(msg);
-		return nullptr;	
+		return Builder::NONE;
 	}
 }
 
-std::unique_ptr<ASTNode> Parser::parseVariableCall() {
-	std::vector<std::unique_ptr<ASTNode>> args{};
-	Token tok = m_previous;
-
-	// TODO: implement system for no parenthesis function calls
-	if (match(Token::Type::OpenParen)) {
-		while (!match(Token::Type::Eof)) {
-			// This is a bit of a hack
-			while (match(Token::Type::Eol) || match(Token::Type::Indent) || match(Token::Type::Dedent)) {}
-
-			args.push_back(parseExpression());
+template class BasicParser<ASTTreeBuilder>;
+template class BasicParser<FlatASTBuilder>;
 
-			while (match(Token::Type::Eol) || match(Token::Type::Indent) || match(Token::Type::Dedent)) {}
-
-			if (!match(Token::Type::Comma)) {
-				break;
-			}
-		}
-
-		if (!match(Token::Type::CloseParen)) {
-			errorCurrent("Expected ')' after function call");
-		}
+ASTNode* functionBody(ASTNodeFunctionDefinition& function, const TokenBuffer& tokens, ASTArena& arena) {
+	if (function.m_body != ASTNodeFunctionDefinition::PARSED) {
+		function.m_contents = Parser::parseBody(tokens, function.m_body, arena);
+		function.m_body = ASTNodeFunctionDefinition::PARSED;
 	}
-
-	return std::make_unique<ASTNodeVariableInvokation>(tok, std::move(args));
+	return function.m_contents;
 }
 
 } // namespace Nitro
-
@@ -1,18 +1,94 @@
 #pragma once
 
-#include <memory>
+#include <cstddef>
+#include <cstdint>
 #include <iostream>
+#include <string_view>
+#include <utility>
+#include <vector>
 
 #include "../Lexer/Lexer.hpp"
-#include "../AST/ASTNode.hpp"
+#include "../Lexer/StreamLexer.hpp"
+#include "../Lexer/TokenBuffer.hpp"
+#include "../AST/ASTTreeBuilder.hpp"
+#include "../AST/FlatAST.hpp"
 
 namespace Nitro {
 
-class Parser {
+/**
+* Recursive descent parser. What it builds is up to Builder, which gets a
+* call per node, children first, and hands back a Builder::Node to refer to
+* it by. Builder::NONE stands for a missing node.
+*
+* Parser builds a tree of ASTNodes in an ASTArena, FlatParser a FlatAST.
+*/
+template <typename Builder>
+class BasicParser {
 public:
-	explicit Parser(Lexer& lexer);
-
-	std::unique_ptr<ASTNode> parse();
+	using Node = typename Builder::Node;
+
+	/**
+	* builder is usually made from what it builds into, an ASTArena or a
+	* FlatAST, which owns the nodes parse() creates.
+	*/
+	BasicParser(Lexer& lexer, Builder builder);
+
+	/**
+	* Parses straight from a pre-tokenized buffer, which must outlive the
+	* parser.
+	*/
+	BasicParser(const TokenBuffer& tokens, Builder builder);
+
+	/**
+	* Parses the tokens from begin up to end only, as if the source ended
+	* there.
+	*/
+	BasicParser(const TokenBuffer& tokens, std::size_t begin, std::size_t end, Builder builder);
+
+	/**
+	* Parses from a stream, one top-level item at a time with parseNext().
+	* Turns on lexer.retain(), so that the lexemes of an item stay valid
+	* until the next call to parseNext().
+	*/
+	BasicParser(StreamLexer& lexer, Builder builder);
+
+	Node parse();
+
+	/**
+	* Parses the next top-level item, a function definition or a statement,
+	* Builder::NONE at the end of the source. Unlike parse(), top-level
+	* statements are not grouped into statement sets.
+	*
+	* Calling it again means the caller is done with the item before, so
+	* when reading a StreamLexer, the text of that item is let go of. Nodes
+	* are the builder's to free, an ASTArena can be reset between items.
+	*/
+	Node parseNext();
+
+	/**
+	* Where errors and warnings are written, std::cerr by default. out must
+	* outlive the parser.
+	*/
+	void setDiagnostics(std::ostream& out) { m_diagnostics = &out; }
+
+	bool hadError() const { return m_had_error; }
+
+	/**
+	* Leaves the body of every function unparsed, recording where it starts
+	* instead, to be parsed on first use by parseBody(). Bodies are skipped
+	* up to the Dedent that closes them by looking at token types only, so
+	* errors in a body are only reported once it is parsed.
+	*
+	* Only for parsers reading a TokenBuffer, and builders that can add a
+	* body after its function (Builder::LAZY_BODIES).
+	*/
+	void setLazyBodies(bool lazy) { m_lazy_bodies = lazy; }
+
+	/**
+	* Parses the function body that starts at token body of tokens, which
+	* must be the buffer the function was parsed from.
+	*/
+	static Node parseBody(const TokenBuffer& tokens, std::size_t body, Builder builder);
 
 private:
 	inline void errorCurrent(std::string_view msg) {
@@ -25,13 +101,25 @@ private:
 		m_had_error = true;
 		m_panic_mode = true;
 
-		std::cerr << "Error: " << m_previous.line << ":" << m_previous.col << ": " << msg << "\n";
+		*m_diagnostics << "Error: " << m_previous.line << ":" << m_previous.col << ": " << msg << "\n";
+	}
+
+	inline Token pull() {
+		if (m_lexer) {
+			return m_lexer->next();
+		}
+		if (m_stream) {
+			return m_stream->next();
+		}
+		m_next_index = m_reader.index();
+		return m_reader.next();
 	}
 
 	inline Token advance() {
 		m_previous = m_current;
 		m_current = m_next;
-		m_next = m_lexer.next();
+		m_current_index = m_next_index;
+		m_next = pull();
 		return m_current;
 	}
 
@@ -82,54 +170,109 @@ private:
 		return false;
 	}
 
-	std::unique_ptr<ASTNode> parseTopLevel();
-
-	std::unique_ptr<ASTNode> parseModuleDefinition();
+	Node parseTopLevel();
 
-	std::unique_ptr<ASTNode> parseFunctionDefinition();
+	Node parseModuleDefinition();
 
-	std::unique_ptr<ASTNode> parseStatements();
+	Node parseFunctionDefinition();
 
-	std::unique_ptr<ASTNode> parseStatement();
+	Node parseStatements();
 
-	std::unique_ptr<ASTNode> parseConditional();
-	std::unique_ptr<ASTNode> parseVariableDeclaration();
-	std::unique_ptr<ASTNode> parseReturnStatement();
-	std::unique_ptr<ASTNode> parseExpressionStatement();
+	/**
+	* Skips from the first token of a body to the Dedent that closes it.
+	*/
+	void skipBody();
 
+	Node parseStatement();
 
-	std::unique_ptr<ASTNode> parseExpression();
+	Node parseConditional();
+	Node parseVariableDeclaration();
+	Node parseReturnStatement();
+	Node parseExpressionStatement();
 
-	std::unique_ptr<ASTNode> parseOrAnd();
 
-	std::unique_ptr<ASTNode> parseBitwiseOrAndXor();
+	Node parseExpression();
 
-	std::unique_ptr<ASTNode> parseEqualNotEqual();
+	/**
+	* Builds the binary operators waiting on m_frames above base, with at
+	* least min_precedence, into operand.
+	*/
+	void reduceBinary(std::size_t base, unsigned min_precedence, Node& operand);
 
-	std::unique_ptr<ASTNode> parseGreaterLessAndEqual();
+	/**
+	* Skips to the next argument of the call on top of m_frames. Returns
+	* false at the end of the source.
+	*/
+	bool beginArgument();
 
-	std::unique_ptr<ASTNode> parseLShiftRShift();
+	/**
+	* Builds the call on top of m_frames from the arguments parsed so far.
+	*/
+	Node closeCall();
 
-	std::unique_ptr<ASTNode> parsePlusMinus();
+	Node parseLiteral();
 
-	std::unique_ptr<ASTNode> parseMultiplyDivide();
+	/**
+	* Something parseExpression() has started and will come back to.
+	*/
+	struct Frame {
+		enum class Kind : std::uint8_t {
+			Binary,  // An operator and its left hand side
+			Prefix,  // A prefix operator
+			Group,   // An open parenthesis
+			Call     // An open argument list
+		};
 
-	std::unique_ptr<ASTNode> parsePow();
+		Kind kind;
+		std::uint8_t op; // ASTNodeBinary::Type or ASTNodeUnary::Type
+		unsigned precedence;
+		Token tok;
+		Node lhs;
+		std::size_t mark; // Where the call's arguments start on m_node_stack
+	};
 
-	std::unique_ptr<ASTNode> parsePrefix();
-
-	std::unique_ptr<ASTNode> parsePrimary();
-
-	std::unique_ptr<ASTNode> parseVariableCall();
+	inline void pushFrame(typename Frame::Kind kind, const Token& tok, std::uint8_t op = 0) {
+		m_frames.push_back(Frame{ kind, op, 0, tok, Builder::NONE, 0 });
+	}
 
-	Lexer& m_lexer;
+	Lexer* m_lexer;
+	StreamLexer* m_stream = nullptr;
+	const TokenBuffer* m_tokens = nullptr;
+	TokenBuffer::Reader m_reader;
+	std::size_t m_current_index = 0; // Of m_current in m_tokens
+	std::size_t m_next_index = 0;
 	Token m_previous;
 	Token m_current;
 	Token m_next;
-	std::unique_ptr<ASTNode> m_ast;
+	Builder m_builder;
+
+	// Children of the lists being parsed. A nested list is pushed on top of
+	// the one around it and taken off before that one goes on, so a single
+	// stack serves every level without allocating per list
+	std::vector<Node> m_node_stack;
+	std::vector<std::pair<Node, Node>> m_condition_stack;
+	std::vector<std::string_view> m_arg_stack;
+	std::vector<Symbol> m_arg_symbol_stack;
+	std::vector<Frame> m_frames;
+
+	std::ostream* m_diagnostics = &std::cerr;
 	bool m_had_error;
 	bool m_panic_mode;
+	bool m_lazy_bodies = false;
 };
 
+using Parser = BasicParser<ASTTreeBuilder>;
+using FlatParser = BasicParser<FlatASTBuilder>;
+
+extern template class BasicParser<ASTTreeBuilder>;
+extern template class BasicParser<FlatASTBuilder>;
+
+/**
+* The body of function, parsed into arena the first time it is asked for
+* when the parser was lazy. tokens must be the buffer function was parsed
+* from.
+*/
+ASTNode* functionBody(ASTNodeFunctionDefinition& function, const TokenBuffer& tokens, ASTArena& arena);
+
 }// namespace Nitro
 
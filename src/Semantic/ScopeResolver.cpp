@@ -0,0 +1,173 @@
+#include "ScopeResolver.hpp"
+
+#include <algorithm>
+
+namespace Nitro {
+
+ScopeResolver::ScopeResolver(StringInterner* interner)
+	: m_interner(interner ? interner : &m_own_interner), m_node_symbols(interner != nullptr) {}
+
+std::uint32_t ScopeResolver::declareGlobal(std::string_view name) {
+	return declareGlobal(m_interner->intern(name));
+}
+
+std::uint32_t ScopeResolver::declareGlobal(Symbol symbol) {
+	if (symbol >= m_globals.size()) {
+		m_globals.resize(symbol + 1, NONE);
+	}
+	if (m_globals[symbol] == NONE) {
+		m_globals[symbol] = static_cast<std::uint32_t>(m_global_names.size());
+		m_global_names.push_back(m_interner->name(symbol));
+	}
+	return m_globals[symbol];
+}
+
+Symbol ScopeResolver::symbolOf(Symbol symbol, std::string_view name) {
+	return m_node_symbols && symbol != NO_SYMBOL ? symbol : m_interner->intern(name);
+}
+
+void ScopeResolver::resolve(ASTNode* program) {
+	if (!program || program->m_kind != ASTKind::StatementSet) {
+		return;
+	}
+
+	// Parser::parse() groups the statements between functions into
+	// statement sets, which are not blocks
+	const auto& items = static_cast<ASTNodeStatementSet*>(program)->m_statements;
+	for (ASTNode* item : items) {
+		if (item && item->m_kind == ASTKind::StatementSet) {
+			for (ASTNode* statement : static_cast<ASTNodeStatementSet*>(item)->m_statements) {
+				hoist(statement);
+			}
+		} else {
+			hoist(item);
+		}
+	}
+
+	beginFrame();
+	for (ASTNode* item : items) {
+		if (item && item->m_kind == ASTKind::StatementSet) {
+			for (ASTNode* statement : static_cast<ASTNodeStatementSet*>(item)->m_statements) {
+				resolveTopLevel(statement);
+			}
+		} else {
+			resolveTopLevel(item);
+		}
+	}
+	m_program_frame_size = std::max(m_program_frame_size, endFrame());
+}
+
+void ScopeResolver::resolveFunction(ASTNodeFunctionDefinition& function) {
+	visit(function);
+}
+
+void ScopeResolver::hoist(ASTNode* statement) {
+	if (!statement) {
+		return;
+	}
+
+	if (statement->m_kind == ASTKind::FunctionDefinition) {
+		auto& function = static_cast<ASTNodeFunctionDefinition&>(*statement);
+		function.m_slot = ASTSlot{ ASTSlot::Kind::Global, 0, declareGlobal(symbolOf(function.m_symbol, function.m_identifier)) };
+	} else if (statement->m_kind == ASTKind::VariableDeclaration) {
+		auto& declaration = static_cast<ASTNodeVariableDeclaration&>(*statement);
+		declaration.m_slot = ASTSlot{ ASTSlot::Kind::Global, 0,
+			declareGlobal(symbolOf(declaration.m_symbol, declaration.m_identifier)) };
+	}
+}
+
+void ScopeResolver::resolveTopLevel(ASTNode* statement) {
+	if (statement && statement->m_kind == ASTKind::VariableDeclaration) {
+		// Its slot was given by hoist()
+		walk(static_cast<ASTNodeVariableDeclaration*>(statement)->m_assign);
+	} else {
+		walk(statement);
+	}
+}
+
+void ScopeResolver::beginFrame() {
+	m_frames.push_back(Frame{ m_locals.size() });
+}
+
+std::uint32_t ScopeResolver::endFrame() {
+	std::uint32_t size = m_frames.back().size;
+	popLocals(m_frames.back().locals);
+	m_frames.pop_back();
+	return size;
+}
+
+std::uint32_t ScopeResolver::declareLocal(Symbol symbol) {
+	Frame& frame = m_frames.back();
+	std::uint32_t slot = frame.next++;
+	frame.size = std::max(frame.size, frame.next);
+
+	// It hides the local of the same name until it ends
+	if (symbol >= m_bindings.size()) {
+		m_bindings.resize(symbol + 1, NONE);
+	}
+	m_locals.push_back(Local{ symbol, slot, static_cast<std::uint32_t>(m_frames.size() - 1), m_bindings[symbol] });
+	m_bindings[symbol] = static_cast<std::uint32_t>(m_locals.size() - 1);
+	return slot;
+}
+
+void ScopeResolver::popLocals(std::size_t count) {
+	while (m_locals.size() > count) {
+		m_bindings[m_locals.back().symbol] = m_locals.back().shadowed;
+		m_locals.pop_back();
+	}
+}
+
+ASTSlot ScopeResolver::lookup(Symbol symbol) const {
+	if (symbol < m_bindings.size() && m_bindings[symbol] != NONE) {
+		const Local& local = m_locals[m_bindings[symbol]];
+		return ASTSlot{ ASTSlot::Kind::Local, static_cast<std::uint32_t>(m_frames.size() - 1 - local.frame), local.slot };
+	}
+
+	if (symbol < m_globals.size() && m_globals[symbol] != NONE) {
+		return ASTSlot{ ASTSlot::Kind::Global, 0, m_globals[symbol] };
+	}
+
+	return ASTSlot{};
+}
+
+void ScopeResolver::visit(ASTNodeVariableInvokation& node) {
+	node.m_slot = lookup(symbolOf(node.m_symbol, node.m_identifier));
+	if (node.m_slot.kind == ASTSlot::Kind::Unresolved) {
+		m_had_error = true;
+		*m_diagnostics << "Error: " << node.m_tok.line << ":" << node.m_tok.col << ": Undeclared variable '"
+			<< node.m_identifier << "'\n";
+	}
+
+	walkChildren(node);
+}
+
+void ScopeResolver::visit(ASTNodeVariableDeclaration& node) {
+	// The value is resolved first, so let x = x + 1 reads an outer x
+	walk(node.m_assign);
+	node.m_slot = ASTSlot{ ASTSlot::Kind::Local, 0, declareLocal(symbolOf(node.m_symbol, node.m_identifier)) };
+}
+
+void ScopeResolver::visit(ASTNodeStatementSet& node) {
+	std::size_t locals = m_locals.size();
+	std::uint32_t next = m_frames.back().next;
+
+	walkChildren(node);
+
+	popLocals(locals);
+	m_frames.back().next = next;
+}
+
+void ScopeResolver::visit(ASTNodeFunctionDefinition& node) {
+	if (!node.m_contents) {
+		return; // Body not parsed yet
+	}
+
+	beginFrame();
+	for (std::size_t i = 0; i < node.m_args.size(); i++) {
+		declareLocal(symbolOf(i < node.m_arg_symbols.size() ? node.m_arg_symbols[i] : NO_SYMBOL, node.m_args[i]));
+	}
+	walk(node.m_contents);
+	node.m_frame_size = endFrame();
+}
+
+} // namespace Nitro
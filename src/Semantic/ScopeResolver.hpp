@@ -0,0 +1,152 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <string_view>
+#include <vector>
+
+#include "../global/defs.hpp"
+#include "../AST/ASTWalker.hpp"
+#include "../Lexer/StringInterner.hpp"
+
+namespace Nitro {
+
+/**
+* Works out where every variable lives and writes it in the m_slot of each
+* declaration and use, reporting the names that are used but never
+* declared.
+*
+* Globals are the functions and the variables declared by top-level
+* statements outside any block, plus what declareGlobal() adds before.
+* They are visible everywhere, even above their declaration, so functions
+* can call each other in any order.
+*
+* Everything else is local to a frame: the arguments of a function take
+* its first slots, and each let takes the next one, visible from the
+* statement after it to the end of its block. Slots are reused once their
+* block ends. Statements in blocks at the top level get a frame of their
+* own, the size of which is programFrameSize().
+*
+* Functions only appear at the top level, so locals are always found in
+* the frame using them, at depth 0.
+*
+* Names are compared by Symbol: globals and the innermost local of each
+* name are found in tables indexed by symbol, in O(1).
+*/
+class ScopeResolver : public ASTWalker<ScopeResolver> {
+public:
+	NITRO_DISABLE_COPY_MOVE(ScopeResolver)
+
+	/**
+	* interner, when given, must be the one the program was lexed with, see
+	* Lexer::setInterner(), and must outlive the resolver. The symbols of
+	* the nodes are then used as they are. Without one, the resolver interns
+	* the names itself.
+	*/
+	explicit ScopeResolver(StringInterner* interner = nullptr);
+
+	/**
+	* Adds a global ahead of the program's, for a function provided by the
+	* host. Its name is interned. Returns its index.
+	*/
+	std::uint32_t declareGlobal(std::string_view name);
+
+	/**
+	* Resolves a program as returned by Parser::parse().
+	*/
+	void resolve(ASTNode* program);
+
+	/**
+	* Resolves the body of a function parsed after the rest of the program,
+	* see BasicParser::setLazyBodies().
+	*/
+	void resolveFunction(ASTNodeFunctionDefinition& function);
+
+	/**
+	* Names of the globals, by index.
+	*/
+	const std::vector<std::string_view>& globals() const { return m_global_names; }
+
+	std::uint32_t programFrameSize() const { return m_program_frame_size; }
+
+	/**
+	* Where errors are written, std::cerr by default. out must outlive the
+	* resolver.
+	*/
+	void setDiagnostics(std::ostream& out) { m_diagnostics = &out; }
+
+	bool hadError() const { return m_had_error; }
+
+	using ASTWalker<ScopeResolver>::visit;
+
+	void visit(ASTNodeVariableInvokation& node);
+
+	void visit(ASTNodeVariableDeclaration& node);
+
+	void visit(ASTNodeStatementSet& node);
+
+	void visit(ASTNodeFunctionDefinition& node);
+
+private:
+	static constexpr std::uint32_t NONE = UINT32_MAX;
+
+	struct Local {
+		Symbol symbol;
+		std::uint32_t slot;
+		std::uint32_t frame;    // Index in m_frames
+		std::uint32_t shadowed; // The local of the same name it hides, or NONE
+	};
+
+	struct Frame {
+		std::size_t locals;     // Where its locals start in m_locals
+		std::uint32_t next = 0; // Next free slot
+		std::uint32_t size = 0; // Most slots in use at once
+	};
+
+	/**
+	* Declares the globals of a top-level statement.
+	*/
+	void hoist(ASTNode* statement);
+
+	/**
+	* Resolves a top-level statement, whose lets declare globals.
+	*/
+	void resolveTopLevel(ASTNode* statement);
+
+	/**
+	* The symbol of a node's name, interned from name when the node's
+	* symbol is not from m_interner.
+	*/
+	Symbol symbolOf(Symbol symbol, std::string_view name);
+
+	std::uint32_t declareGlobal(Symbol symbol);
+
+	void beginFrame();
+	std::uint32_t endFrame();
+
+	std::uint32_t declareLocal(Symbol symbol);
+
+	/**
+	* Ends the locals from index count of m_locals on.
+	*/
+	void popLocals(std::size_t count);
+
+	ASTSlot lookup(Symbol symbol) const;
+
+	StringInterner m_own_interner; // Used when none is given
+	StringInterner* m_interner;
+	bool m_node_symbols; // Whether the symbols of the nodes are from m_interner
+
+	std::vector<std::uint32_t> m_globals; // Index of each symbol's global, or NONE
+	std::vector<std::string_view> m_global_names;
+	std::vector<Local> m_locals;
+	std::vector<std::uint32_t> m_bindings; // Innermost local of each symbol in m_locals, or NONE
+	std::vector<Frame> m_frames;
+	std::uint32_t m_program_frame_size = 0;
+
+	std::ostream* m_diagnostics = &std::cerr;
+	bool m_had_error = false;
+};
+
+} // namespace Nitro
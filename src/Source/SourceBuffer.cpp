@@ -0,0 +1,166 @@
+#include "SourceBuffer.hpp"
+
+#include <cstring>
+#include <fstream>
+#include <utility>
+
+#if defined(__unix__) || defined(__APPLE__)
+#define NITRO_SOURCE_MMAP 1
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#else
+#define NITRO_SOURCE_MMAP 0
+#endif
+
+namespace Nitro {
+
+SourceBuffer::SourceBuffer(SourceBuffer&& other) noexcept
+	: m_data(std::exchange(other.m_data, nullptr)),
+	  m_size(std::exchange(other.m_size, 0)),
+	  m_capacity(std::exchange(other.m_capacity, 0)),
+	  m_mapped_length(std::exchange(other.m_mapped_length, 0)) {}
+
+SourceBuffer& SourceBuffer::operator=(SourceBuffer&& other) noexcept {
+	if (this != &other) {
+		release();
+		m_data = std::exchange(other.m_data, nullptr);
+		m_size = std::exchange(other.m_size, 0);
+		m_capacity = std::exchange(other.m_capacity, 0);
+		m_mapped_length = std::exchange(other.m_mapped_length, 0);
+	}
+	return *this;
+}
+
+SourceBuffer::~SourceBuffer() {
+	release();
+}
+
+void SourceBuffer::release() {
+	if (!m_data) {
+		return;
+	}
+
+#if NITRO_SOURCE_MMAP
+	if (m_mapped_length) {
+		munmap(m_data, m_mapped_length);
+		m_data = nullptr;
+		return;
+	}
+#endif
+
+	delete[] m_data;
+	m_data = nullptr;
+}
+
+SourceBuffer SourceBuffer::allocate(std::size_t size) {
+	SourceBuffer buffer;
+	buffer.m_data = new char[size + PADDING]();
+	buffer.m_size = size;
+	buffer.m_capacity = size;
+	return buffer;
+}
+
+SourceBuffer SourceBuffer::withCapacity(std::size_t capacity) {
+	SourceBuffer buffer = allocate(capacity);
+	buffer.m_size = 0;
+	return buffer;
+}
+
+void SourceBuffer::commit(std::size_t count) {
+	m_size += count;
+}
+
+void SourceBuffer::discard(std::size_t count) {
+	std::memmove(m_data, m_data + count, m_size - count);
+	// Zero the vacated tail so the padding holds again
+	std::memset(m_data + m_size - count, 0, count);
+	m_size -= count;
+}
+
+void SourceBuffer::reserve(std::size_t capacity) {
+	if (capacity <= m_capacity) {
+		return;
+	}
+
+	SourceBuffer bigger = allocate(capacity);
+	std::memcpy(bigger.m_data, m_data, m_size);
+	bigger.m_size = m_size;
+	*this = std::move(bigger);
+}
+
+SourceBuffer SourceBuffer::fromString(std::string_view text) {
+	SourceBuffer buffer = allocate(text.size());
+	std::memcpy(buffer.m_data, text.data(), text.size());
+	return buffer;
+}
+
+SourceBuffer SourceBuffer::fromStream(std::istream& in) {
+	constexpr std::size_t initial_capacity = 64 * 1024;
+
+	SourceBuffer buffer = withCapacity(initial_capacity);
+
+	while (in) {
+		if (buffer.spareCapacity() == 0) {
+			buffer.reserve(buffer.m_capacity * 2);
+		}
+
+		in.read(buffer.spare(), static_cast<std::streamsize>(buffer.spareCapacity()));
+		buffer.commit(static_cast<std::size_t>(in.gcount()));
+	}
+
+	// The unused capacity is still zeroed, so the padding holds
+	return buffer;
+}
+
+std::optional<SourceBuffer> SourceBuffer::fromFile(const std::filesystem::path& path) {
+#if NITRO_SOURCE_MMAP
+	int fd = ::open(path.c_str(), O_RDONLY);
+	if (fd < 0) {
+		return std::nullopt;
+	}
+
+	struct stat info;
+	if (fstat(fd, &info) != 0) {
+		::close(fd);
+		return std::nullopt;
+	}
+
+	if (S_ISREG(info.st_mode) && info.st_size > 0) {
+		std::size_t size = static_cast<std::size_t>(info.st_size);
+		std::size_t page = static_cast<std::size_t>(sysconf(_SC_PAGESIZE));
+		std::size_t length = (size + PADDING + page - 1) / page * page;
+
+		// Reserve zeroed pages for the text plus padding, then map the file
+		// over the front. The kernel zero fills the tail of the last file
+		// page, and the pages after it stay anonymous zeroes.
+		void* base = mmap(nullptr, length, PROT_READ, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+		if (base != MAP_FAILED) {
+			void* text = mmap(base, size, PROT_READ, MAP_PRIVATE | MAP_FIXED, fd, 0);
+			if (text != MAP_FAILED) {
+				::close(fd);
+				madvise(base, length, MADV_SEQUENTIAL);
+
+				SourceBuffer buffer;
+				buffer.m_data = static_cast<char*>(base);
+				buffer.m_size = size;
+				buffer.m_mapped_length = length;
+				return buffer;
+			}
+			munmap(base, length);
+		}
+	}
+
+	::close(fd);
+#endif
+
+	// Pipes, character devices, empty files and platforms without mmap
+	std::ifstream in(path, std::ios::binary);
+	if (!in) {
+		return std::nullopt;
+	}
+	return fromStream(in);
+}
+
+} // namespace Nitro
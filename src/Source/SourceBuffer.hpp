@@ -0,0 +1,95 @@
+#pragma once
+
+#include <cstddef>
+#include <filesystem>
+#include <istream>
+#include <optional>
+#include <string_view>
+
+#include "../global/defs.hpp"
+
+namespace Nitro {
+
+/**
+* Owns the text of a script. Whatever the origin, the text is always followed
+* by at least PADDING NUL bytes, so a scanner may read past the last character
+* (and load whole vectors there) without checking bounds: the first byte after
+* the text acts as the terminator.
+*
+* Regular files are memory mapped instead of copied. Everything else (pipes,
+* stdin, in-memory strings) is copied once into a padded heap block.
+*/
+class SourceBuffer {
+public:
+	static constexpr std::size_t PADDING = 64;
+
+	NITRO_DISABLE_COPY(SourceBuffer)
+
+	SourceBuffer(SourceBuffer&& other) noexcept;
+	SourceBuffer& operator=(SourceBuffer&& other) noexcept;
+
+	~SourceBuffer();
+
+	/**
+	* Maps (or for non-regular files, reads) the file at path. Returns an
+	* empty optional if it cannot be opened.
+	*/
+	static std::optional<SourceBuffer> fromFile(const std::filesystem::path& path);
+
+	static SourceBuffer fromStream(std::istream& in);
+
+	static SourceBuffer fromString(std::string_view text);
+
+	const char* data() const { return m_data; }
+
+	std::size_t size() const { return m_size; }
+
+	std::string_view view() const { return std::string_view(m_data, m_size); }
+
+	bool isMapped() const { return m_mapped_length != 0; }
+
+	// Incremental filling, for heap buffers only
+
+	/**
+	* An empty buffer with room for capacity characters.
+	*/
+	static SourceBuffer withCapacity(std::size_t capacity);
+
+	std::size_t capacity() const { return m_capacity; }
+
+	/**
+	* The unused capacity after the text, and how large it is. Characters
+	* written there become part of the text once committed.
+	*/
+	char* spare() { return m_data + m_size; }
+	std::size_t spareCapacity() const { return m_capacity - m_size; }
+
+	void commit(std::size_t count);
+
+	/**
+	* Drops the first count characters, moving the rest to the front.
+	*/
+	void discard(std::size_t count);
+
+	/**
+	* Grows the capacity to at least capacity, keeping the text.
+	*/
+	void reserve(std::size_t capacity);
+
+private:
+	SourceBuffer() = default;
+
+	/**
+	* Allocates a zeroed heap block for size characters plus padding.
+	*/
+	static SourceBuffer allocate(std::size_t size);
+
+	void release();
+
+	char* m_data = nullptr;
+	std::size_t m_size = 0;
+	std::size_t m_capacity = 0;      // Heap blocks: bytes available for text
+	std::size_t m_mapped_length = 0; // Mappings: length of the whole mapping
+};
+
+} // namespace Nitro
@@ -0,0 +1,24 @@
+#include "Bytecode.hpp"
+
+#include <algorithm>
+
+namespace Nitro {
+
+void SourceMap::add(std::size_t offset, const Token& at) {
+	if (m_positions.empty() || m_positions.back().line != at.line || m_positions.back().col != at.col) {
+		m_positions.push_back(Position{
+			static_cast<std::uint32_t>(offset),
+			static_cast<std::uint32_t>(at.line),
+			static_cast<std::uint32_t>(at.col)
+		});
+	}
+}
+
+auto SourceMap::at(std::size_t offset) const -> const Position& {
+	// The last position starting at or before offset
+	auto after = std::upper_bound(m_positions.begin(), m_positions.end(), offset,
+		[](std::size_t at, const Position& position) { return at < position.offset; });
+	return after == m_positions.begin() ? m_positions.front() : *(after - 1);
+}
+
+} // namespace Nitro
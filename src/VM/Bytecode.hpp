@@ -0,0 +1,128 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <string_view>
+#include <vector>
+
+#include "../global/defs.hpp"
+#include "../Lexer/Lexer.hpp"
+#include "Value.hpp"
+
+namespace Nitro {
+
+/**
+* Instructions of the stack VM. Operands follow the opcode, 16 bit ones
+* little endian. The stack effect is given after the operands.
+*/
+enum class OpCode : std::uint8_t {
+	Constant,      // u16 constant          -> value
+	Nil,           //                       -> nil
+	True,          //                       -> true
+	False,         //                       -> false
+	Pop,           // value                 ->
+
+	GetLocal,      // u16 slot              -> value
+	SetLocal,      // u16 slot, value       ->
+	GetGlobal,     // u16 global            -> value
+	SetGlobal,     // u16 global, value     ->
+
+	// lhs, rhs -> result, in the order of ASTNodeBinary::Type
+	Add,
+	Sub,
+	Mult,
+	Div,
+	Pow,
+	Greater,
+	GreaterEqual,
+	RShift,
+	Less,
+	LessEqual,
+	LShift,
+	Equal,
+	NotEqual,
+	BitwiseAnd,
+	BitwiseOr,
+	BitwiseXor,
+
+	// operand -> result
+	Negate,
+	Not,
+	BitwiseNot,
+
+	Jump,          // u16 forward offset
+	JumpIfFalse,   // u16 forward offset, condition ->
+	JumpIfTrue,    // u16 forward offset, condition ->
+
+	Call,          // u8 count, function, count arguments -> result
+	Return         // value ->
+};
+
+/**
+* Where in the source the instructions of a function come from, for error
+* messages. Offsets are in whatever unit the code is indexed by.
+*/
+class SourceMap {
+public:
+	struct Position {
+		std::uint32_t offset; // Of the first instruction at this position
+		std::uint32_t line;
+		std::uint32_t col;
+	};
+
+	/**
+	* Records that the instruction at offset, and those after it, come from
+	* the token at.
+	*/
+	void add(std::size_t offset, const Token& at);
+
+	/**
+	* The position of the instruction holding offset.
+	*/
+	const Position& at(std::size_t offset) const;
+
+private:
+	std::vector<Position> m_positions;
+};
+
+/**
+* Bytecode of one function.
+*/
+struct Chunk {
+	std::vector<std::uint8_t> code;
+	std::vector<Value> constants;
+	SourceMap positions;
+};
+
+struct Function {
+	std::string_view name;
+	std::uint32_t arity = 0;
+	std::uint32_t frame_size = 0; // Slots for arguments and locals
+	std::uint32_t max_stack = 0;  // Most temporaries on the stack at once
+	Chunk chunk;
+};
+
+/**
+* A compiled script, see BytecodeCompiler. functions[0] is the top level.
+*/
+struct Program {
+	NITRO_DISABLE_COPY(Program)
+	NITRO_DEFAULT_MOVE(Program)
+
+	Program() = default;
+
+	std::vector<Function> functions;
+
+	// Values of the globals before the script runs: the functions and the
+	// natives, nil for the rest
+	std::vector<Value> globals;
+
+	// Text of the string constants. A deque, as values point to them.
+	std::deque<std::string_view> strings;
+
+	// Integer constants too wide for a Value
+	IntHeap ints;
+};
+
+} // namespace Nitro
@@ -0,0 +1,309 @@
+#include "BytecodeCompiler.hpp"
+
+#include <algorithm>
+#include <utility>
+#include <vector>
+
+#include "../AST/ASTNodeConstant.hpp"
+#include "../AST/ASTNodeNil.hpp"
+#include "../AST/ASTNodeBinary.hpp"
+#include "../AST/ASTNodeUnary.hpp"
+#include "../AST/ASTNodeVariableInvokation.hpp"
+#include "../AST/ASTNodeVariableDeclaration.hpp"
+#include "../AST/ASTNodeStatementSet.hpp"
+#include "../AST/ASTNodeConditional.hpp"
+#include "../AST/ASTNodeFunctionDefinition.hpp"
+#include "../AST/ASTNodeFunctionReturn.hpp"
+#include "../Semantic/ScopeResolver.hpp"
+#include "TopLevel.hpp"
+
+namespace Nitro {
+
+static_assert(static_cast<int>(OpCode::BitwiseXor) - static_cast<int>(OpCode::Add) ==
+	static_cast<int>(ASTNodeBinary::Type::BitwiseXor) - static_cast<int>(ASTNodeBinary::Type::Add),
+	"Binary opcodes must follow ASTNodeBinary::Type");
+
+Program BytecodeCompiler::compile(ASTNode* program, const ScopeResolver& resolver) {
+	Program result;
+	m_program = &result;
+	IntHeap::Scope ints(result.ints);
+
+	TopLevel top = TopLevel::of(program, resolver);
+	result.globals = std::move(top.globals);
+	result.functions.resize(1 + top.functions.size());
+
+	m_function = &result.functions[0];
+	m_function->name = "<script>";
+	m_function->frame_size = resolver.programFrameSize();
+	m_depth = 0;
+	for (ASTNode* statement : top.statements) {
+		this->statement(statement);
+	}
+	Token end = program ? program->m_tok : Token{};
+	emit(OpCode::Nil, end);
+	emit(OpCode::Return, end);
+
+	for (std::size_t i = 0; i < top.functions.size(); i++) {
+		m_function = &result.functions[i + 1];
+		m_depth = 0;
+		visit(*top.functions[i]);
+	}
+
+	m_program = nullptr;
+	m_function = nullptr;
+	return result;
+}
+
+void BytecodeCompiler::statement(ASTNode* node) {
+	if (!node) {
+		return;
+	}
+
+	switch (node->m_kind) {
+		case ASTKind::VariableDeclaration:
+		case ASTKind::StatementSet:
+		case ASTKind::Conditional:
+		case ASTKind::FunctionReturn:
+			node->visit(*this);
+			break;
+		case ASTKind::FunctionDefinition:
+			error(node->m_tok, "Functions can only be defined at the top level");
+			break;
+		default:
+			expression(node);
+			emit(OpCode::Pop, node->m_tok);
+			break;
+	}
+}
+
+void BytecodeCompiler::expression(ASTNode* node) {
+	if (!node) {
+		// Only left by a parse error
+		emit(OpCode::Nil, Token{});
+		return;
+	}
+	node->visit(*this);
+}
+
+void BytecodeCompiler::emit(OpCode op, const Token& at) {
+	Chunk& chunk = m_function->chunk;
+	chunk.positions.add(chunk.code.size(), at);
+	chunk.code.push_back(static_cast<std::uint8_t>(op));
+
+	switch (op) {
+		case OpCode::Constant:
+		case OpCode::Nil:
+		case OpCode::True:
+		case OpCode::False:
+		case OpCode::GetLocal:
+		case OpCode::GetGlobal:
+			adjust(1);
+			break;
+		case OpCode::Negate:
+		case OpCode::Not:
+		case OpCode::BitwiseNot:
+		case OpCode::Jump:
+		case OpCode::Call: // Adjusted by the caller, which knows the count
+			break;
+		default:
+			adjust(-1);
+			break;
+	}
+}
+
+void BytecodeCompiler::emit(OpCode op, std::uint32_t operand, const Token& at) {
+	if (operand > UINT16_MAX) {
+		error(at, "Too many constants or variables in one function");
+	}
+	emit(op, at);
+	m_function->chunk.code.push_back(static_cast<std::uint8_t>(operand & 0xff));
+	m_function->chunk.code.push_back(static_cast<std::uint8_t>(operand >> 8));
+}
+
+void BytecodeCompiler::emitConstant(Value value, const Token& at) {
+	m_function->chunk.constants.push_back(value);
+	emit(OpCode::Constant, static_cast<std::uint32_t>(m_function->chunk.constants.size() - 1), at);
+}
+
+std::size_t BytecodeCompiler::emitJump(OpCode op, const Token& at) {
+	emit(op, 0, at);
+	return m_function->chunk.code.size() - 2;
+}
+
+void BytecodeCompiler::patchJump(std::size_t operand, const Token& at) {
+	std::vector<std::uint8_t>& code = m_function->chunk.code;
+	std::size_t offset = code.size() - (operand + 2);
+	if (offset > UINT16_MAX) {
+		error(at, "Too much code to jump over");
+	}
+	code[operand] = static_cast<std::uint8_t>(offset & 0xff);
+	code[operand + 1] = static_cast<std::uint8_t>(offset >> 8);
+}
+
+void BytecodeCompiler::adjust(int delta) {
+	m_depth = static_cast<std::uint32_t>(static_cast<int>(m_depth) + delta);
+	m_function->max_stack = std::max(m_function->max_stack, m_depth);
+}
+
+void BytecodeCompiler::error(const Token& at, const char* msg) {
+	m_had_error = true;
+	*m_diagnostics << "Error: " << at.line << ":" << at.col << ": " << msg << "\n";
+}
+
+void BytecodeCompiler::visit(ASTNodeConstant<std::int64_t>& node) {
+	emitConstant(Value::integer(node.m_value), node.m_tok);
+}
+
+void BytecodeCompiler::visit(ASTNodeConstant<double>& node) {
+	emitConstant(Value::floating(node.m_value), node.m_tok);
+}
+
+void BytecodeCompiler::visit(ASTNodeConstant<bool>& node) {
+	emit(node.m_value ? OpCode::True : OpCode::False, node.m_tok);
+}
+
+void BytecodeCompiler::visit(ASTNodeConstant<std::string_view>& node) {
+	m_program->strings.push_back(node.m_value);
+	emitConstant(Value::string(&m_program->strings.back()), node.m_tok);
+}
+
+void BytecodeCompiler::visit(ASTNodeConstant<char>& node) {
+	emitConstant(Value::character(node.m_value), node.m_tok);
+}
+
+void BytecodeCompiler::visit(ASTNodeNil& node) {
+	emit(OpCode::Nil, node.m_tok);
+}
+
+void BytecodeCompiler::visit(ASTNodeBinary& node) {
+	if (node.m_type == ASTNodeBinary::Type::And || node.m_type == ASTNodeBinary::Type::Or) {
+		// Both give a bool: x && y is false as soon as x or y is
+		bool is_and = node.m_type == ASTNodeBinary::Type::And;
+		OpCode decide = is_and ? OpCode::JumpIfFalse : OpCode::JumpIfTrue;
+
+		expression(node.m_left);
+		std::size_t left = emitJump(decide, node.m_tok);
+		expression(node.m_right);
+		std::size_t right = emitJump(decide, node.m_tok);
+		emit(is_and ? OpCode::True : OpCode::False, node.m_tok);
+		std::size_t end = emitJump(OpCode::Jump, node.m_tok);
+
+		patchJump(left, node.m_tok);
+		patchJump(right, node.m_tok);
+		adjust(-1); // Only one of the two results is pushed
+		emit(is_and ? OpCode::False : OpCode::True, node.m_tok);
+		patchJump(end, node.m_tok);
+		return;
+	}
+
+	expression(node.m_left);
+	expression(node.m_right);
+	emit(static_cast<OpCode>(static_cast<int>(OpCode::Add) + static_cast<int>(node.m_type)), node.m_tok);
+}
+
+void BytecodeCompiler::visit(ASTNodeUnary& node) {
+	expression(node.m_branch);
+
+	switch (node.m_type) {
+		case ASTNodeUnary::Type::Plus: break;
+		case ASTNodeUnary::Type::Negate: emit(OpCode::Negate, node.m_tok); break;
+		case ASTNodeUnary::Type::Not: emit(OpCode::Not, node.m_tok); break;
+		case ASTNodeUnary::Type::BitwiseNot: emit(OpCode::BitwiseNot, node.m_tok); break;
+	}
+}
+
+void BytecodeCompiler::visit(ASTNodeVariableInvokation& node) {
+	switch (node.m_slot.kind) {
+		case ASTSlot::Kind::Local:
+			if (node.m_slot.depth != 0) {
+				error(node.m_tok, "Variables of an enclosing function cannot be used");
+			}
+			emit(OpCode::GetLocal, node.m_slot.index, node.m_tok);
+			break;
+		case ASTSlot::Kind::Global:
+			emit(OpCode::GetGlobal, node.m_slot.index, node.m_tok);
+			break;
+		case ASTSlot::Kind::Unresolved:
+			// Reported by the resolver
+			m_had_error = true;
+			emit(OpCode::Nil, node.m_tok);
+			break;
+	}
+
+	if (!node.m_call) {
+		return;
+	}
+
+	if (node.m_args.size() > UINT8_MAX) {
+		error(node.m_tok, "Too many arguments");
+	}
+	for (ASTNode* arg : node.m_args) {
+		expression(arg);
+	}
+	emit(OpCode::Call, node.m_tok);
+	m_function->chunk.code.push_back(static_cast<std::uint8_t>(node.m_args.size()));
+	adjust(-static_cast<int>(node.m_args.size()));
+}
+
+void BytecodeCompiler::visit(ASTNodeVariableDeclaration& node) {
+	expression(node.m_assign);
+
+	if (node.m_slot.kind == ASTSlot::Kind::Global) {
+		emit(OpCode::SetGlobal, node.m_slot.index, node.m_tok);
+	} else {
+		emit(OpCode::SetLocal, node.m_slot.index, node.m_tok);
+	}
+}
+
+void BytecodeCompiler::visit(ASTNodeStatementSet& node) {
+	for (ASTNode* statement : node.m_statements) {
+		this->statement(statement);
+	}
+}
+
+void BytecodeCompiler::visit(ASTNodeConditional& node) {
+	std::vector<std::size_t> ends;
+
+	for (std::size_t i = 0; i < node.m_conditions.size(); i++) {
+		auto& condition = node.m_conditions[i];
+		expression(condition.first);
+		std::size_t next = emitJump(OpCode::JumpIfFalse, node.m_tok);
+		statement(condition.second);
+
+		// The last branch without an else falls through to the end
+		if (i + 1 < node.m_conditions.size() || node.m_else_statement) {
+			ends.push_back(emitJump(OpCode::Jump, node.m_tok));
+		}
+		patchJump(next, node.m_tok);
+	}
+
+	statement(node.m_else_statement);
+	for (std::size_t end : ends) {
+		patchJump(end, node.m_tok);
+	}
+}
+
+void BytecodeCompiler::visit(ASTNodeFunctionDefinition& node) {
+	m_function->name = node.m_identifier;
+	m_function->arity = static_cast<std::uint32_t>(node.m_args.size());
+	m_function->frame_size = node.m_frame_size;
+
+	if (!node.m_contents) {
+		error(node.m_tok, "Function body was not parsed");
+	}
+	statement(node.m_contents);
+
+	emit(OpCode::Nil, node.m_tok);
+	emit(OpCode::Return, node.m_tok);
+}
+
+void BytecodeCompiler::visit(ASTNodeFunctionReturn& node) {
+	if (node.m_expr) {
+		expression(node.m_expr);
+	} else {
+		emit(OpCode::Nil, node.m_tok);
+	}
+	emit(OpCode::Return, node.m_tok);
+}
+
+} // namespace Nitro
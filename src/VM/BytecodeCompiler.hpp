@@ -0,0 +1,107 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+
+#include "../global/defs.hpp"
+#include "../AST/ASTNode.hpp"
+#include "../AST/ASTVisitor.hpp"
+#include "Bytecode.hpp"
+
+namespace Nitro {
+
+class ScopeResolver;
+
+/**
+* Lowers a tree to bytecode for the VM. The tree must have been resolved by
+* a ScopeResolver that declared the natives() first, which gives variables
+* the slots the bytecode reads them by.
+*
+* Every function becomes a Function of the Program. The statements outside
+* of them, in order, become functions[0], whose frame holds the locals of
+* blocks at the top level.
+*/
+class BytecodeCompiler : public ASTVisitor {
+public:
+	NITRO_DISABLE_COPY_MOVE(BytecodeCompiler)
+
+	BytecodeCompiler() = default;
+
+	Program compile(ASTNode* program, const ScopeResolver& resolver);
+
+	/**
+	* Where errors are written, std::cerr by default. out must outlive the
+	* compiler.
+	*/
+	void setDiagnostics(std::ostream& out) { m_diagnostics = &out; }
+
+	bool hadError() const { return m_had_error; }
+
+	void visit(ASTNodeConstant<std::int64_t>& node) override;
+
+	void visit(ASTNodeConstant<double>& node) override;
+
+	void visit(ASTNodeConstant<bool>& node) override;
+
+	void visit(ASTNodeConstant<std::string_view>& node) override;
+
+	void visit(ASTNodeConstant<char>& node) override;
+
+	void visit(ASTNodeNil& node) override;
+
+	void visit(ASTNodeBinary& node) override;
+
+	void visit(ASTNodeUnary& node) override;
+
+	void visit(ASTNodeVariableInvokation& node) override;
+
+	void visit(ASTNodeVariableDeclaration& node) override;
+
+	void visit(ASTNodeStatementSet& node) override;
+
+	void visit(ASTNodeConditional& node) override;
+
+	void visit(ASTNodeFunctionDefinition& node) override;
+
+	void visit(ASTNodeFunctionReturn& node) override;
+
+private:
+	void statement(ASTNode* node);
+
+	/**
+	* Compiles an expression, nil if it is missing.
+	*/
+	void expression(ASTNode* node);
+
+	void emit(OpCode op, const Token& at);
+	void emit(OpCode op, std::uint32_t operand, const Token& at);
+	void emitConstant(Value value, const Token& at);
+
+	/**
+	* Emits a jump to be patched, returns where its offset goes.
+	*/
+	std::size_t emitJump(OpCode op, const Token& at);
+
+	/**
+	* Makes the jump at operand land on the next instruction.
+	*/
+	void patchJump(std::size_t operand, const Token& at);
+
+	/**
+	* Changes the stack depth by delta, tracking the most the function
+	* needs.
+	*/
+	void adjust(int delta);
+
+	void error(const Token& at, const char* msg);
+
+	Program* m_program = nullptr;
+	Function* m_function = nullptr;
+	std::uint32_t m_depth = 0;
+
+	std::ostream* m_diagnostics = &std::cerr;
+	bool m_had_error = false;
+};
+
+} // namespace Nitro
@@ -0,0 +1,105 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <iostream>
+#include <string_view>
+#include <vector>
+
+#include "../global/defs.hpp"
+#include "Value.hpp"
+
+namespace Nitro {
+
+struct Closure;
+struct ClosureContext;
+
+/**
+* Runs a compiled node: gives the value of an expression, or carries out a
+* statement and gives nil.
+*/
+using Evaluate = Value (*)(const Closure* node, ClosureContext& context);
+
+/**
+* A node of a tree compiled by the ClosureCompiler: the function that runs
+* it, chosen for the kinds of its operands, and what that function needs.
+* Nodes call their children directly.
+*/
+struct Closure {
+	Evaluate evaluate = nullptr;
+
+	// Operands, or the callee of a call, or the value of a declaration or
+	// a return
+	const Closure* left = nullptr;
+	const Closure* right = nullptr;
+
+	// Statements, arguments, or the conditions of a conditional each
+	// followed by its branch
+	const Closure* const* children = nullptr;
+	std::uint32_t count = 0;
+
+	std::uint32_t index = 0; // A slot or a global
+	Value value;             // A constant
+
+	std::uint32_t line = 0;
+	std::uint32_t col = 0;
+};
+
+struct ClosureFunction {
+	std::string_view name;
+	std::uint32_t arity = 0;
+	std::uint32_t frame_size = 0; // Slots for arguments and locals
+	const Closure* body = nullptr;
+};
+
+/**
+* A script compiled to closures, see ClosureCompiler. functions[0] is the
+* top level.
+*/
+struct ClosureProgram {
+	NITRO_DISABLE_COPY(ClosureProgram)
+	NITRO_DEFAULT_MOVE(ClosureProgram)
+
+	ClosureProgram() = default;
+
+	std::vector<ClosureFunction> functions;
+	std::vector<Value> globals;
+	std::deque<std::string_view> strings;
+	IntHeap ints;
+
+	// Deques, as closures point to each other and to the lists
+	std::deque<Closure> closures;
+	std::deque<std::vector<const Closure*>> lists;
+};
+
+/**
+* The state of a running ClosureProgram, see ClosureEvaluator.
+*/
+struct ClosureContext {
+	const ClosureProgram* program = nullptr;
+	Value* globals = nullptr;
+
+	Value* stack = nullptr;
+	Value* base = nullptr; // The frame of the running function
+	Value* top = nullptr;  // Past the slots in use
+	Value* end = nullptr;
+	std::uint32_t frames = 0; // Calls running
+
+	// Calls recurse natively, and move to a new stack once this one reaches
+	// this address
+	std::uintptr_t stack_limit = 0;
+
+	// Where the run boxes integers, collected by calls, and installed on the
+	// threads of the new stacks
+	IntHeap* ints = nullptr;
+
+	std::ostream* output = &std::cout;
+	std::ostream* diagnostics = &std::cerr;
+
+	Value result;        // Of the last return
+	bool stop = false;   // Set by a return or an error, until the function ends
+	bool failed = false; // Set by an error
+};
+
+} // namespace Nitro
@@ -0,0 +1,639 @@
+#include "ClosureCompiler.hpp"
+
+#include <string>
+#include <string_view>
+#include <utility>
+
+#include "../AST/ASTNodeConstant.hpp"
+#include "../AST/ASTNodeNil.hpp"
+#include "../AST/ASTNodeBinary.hpp"
+#include "../AST/ASTNodeUnary.hpp"
+#include "../AST/ASTNodeVariableInvokation.hpp"
+#include "../AST/ASTNodeVariableDeclaration.hpp"
+#include "../AST/ASTNodeStatementSet.hpp"
+#include "../AST/ASTNodeConditional.hpp"
+#include "../AST/ASTNodeFunctionDefinition.hpp"
+#include "../AST/ASTNodeFunctionReturn.hpp"
+#include "../Semantic/ScopeResolver.hpp"
+#include "ClosureEvaluator.hpp"
+#include "NativeStack.hpp"
+#include "Natives.hpp"
+#include "Operators.hpp"
+#include "TopLevel.hpp"
+
+// Keeps error reporting out of the closures, whose frames pile up on the
+// native stack with every script call
+#if defined(__GNUC__)
+	#define NITRO_COLD __attribute__((cold, noinline))
+#else
+	#define NITRO_COLD
+#endif
+
+namespace Nitro {
+
+namespace {
+
+// What the closures run. Once an error stops the script, the expressions
+// left to finish give nil without side effects: calls check for it first.
+
+NITRO_COLD Value fail(const Closure* node, ClosureContext& context, std::string_view msg) {
+	if (!context.failed) {
+		*context.diagnostics << "Runtime error: " << node->line << ":" << node->col << ": " << msg << "\n";
+	}
+	context.failed = true;
+	context.stop = true;
+	return Value::nil();
+}
+
+NITRO_COLD Value arityError(const Closure* node, ClosureContext& context, std::uint32_t arity) {
+	return fail(node, context, "Expected " + std::to_string(arity) + " arguments but got " + std::to_string(node->count));
+}
+
+// Every live Value is on the stack or in a global when a call starts
+NITRO_COLD void collect(ClosureContext& context) {
+	context.ints->collect({ { context.stack, context.top },
+		{ context.globals, context.globals + context.program->globals.size() } });
+}
+
+/**
+* Runs body on a new thread, for a call that would take the native stack
+* past its limit.
+*/
+NITRO_COLD void evaluateOnNewStack(const Closure* node, const Closure* body, ClosureContext& context) {
+	struct Job {
+		const Closure* body;
+		ClosureContext* context;
+	};
+
+	Job job{ body, &context };
+	std::uintptr_t limit = context.stack_limit;
+	bool started = runOnNewStack(ClosureEvaluator::STACK_SEGMENT_SIZE, [](void* arg) {
+		Job& job = *static_cast<Job*>(arg);
+		IntHeap::Scope ints(*job.context->ints);
+		char probe;
+		job.context->stack_limit = reinterpret_cast<std::uintptr_t>(&probe) -
+			(ClosureEvaluator::STACK_SEGMENT_SIZE - ClosureEvaluator::STACK_MARGIN);
+		job.body->evaluate(job.body, *job.context);
+	}, &job);
+	context.stack_limit = limit;
+
+	if (!started) {
+		fail(node, context, "Stack overflow");
+	}
+}
+
+Value nothing(const Closure*, ClosureContext&) {
+	return Value::nil();
+}
+
+Value constant(const Closure* node, ClosureContext&) {
+	return node->value;
+}
+
+Value local(const Closure* node, ClosureContext& context) {
+	return context.base[node->index];
+}
+
+Value global(const Closure* node, ClosureContext& context) {
+	return context.globals[node->index];
+}
+
+// How a closure gets an operand: any closure is called, but a constant or
+// a variable is read in place
+
+struct AnyOperand {
+	static constexpr bool CALLS = true; // So may collect boxed ints
+	static Value get(const Closure* node, ClosureContext& context) { return node->evaluate(node, context); }
+};
+
+struct ConstantOperand {
+	static constexpr bool CALLS = false;
+	static Value get(const Closure* node, ClosureContext&) { return node->value; }
+};
+
+struct LocalOperand {
+	static constexpr bool CALLS = false;
+	static Value get(const Closure* node, ClosureContext& context) { return context.base[node->index]; }
+};
+
+struct GlobalOperand {
+	static constexpr bool CALLS = false;
+	static Value get(const Closure* node, ClosureContext& context) { return context.globals[node->index]; }
+};
+
+using BinaryOperator = const char* (*)(const Value&, const Value&, Value&);
+using UnaryOperator = const char* (*)(const Value&, Value&);
+
+template <BinaryOperator Op, typename Left, typename Right>
+Value binary(const Closure* node, ClosureContext& context) {
+	Value left = Left::get(node->left, context);
+	Value right;
+	if constexpr (Right::CALLS) {
+		// The left operand stays on the stack, where collections see it
+		if (context.top == context.end) {
+			return fail(node, context, "Stack overflow");
+		}
+		*context.top++ = left;
+		right = Right::get(node->right, context);
+		context.top--;
+	} else {
+		right = Right::get(node->right, context);
+	}
+	Value out;
+	if (const char* error = Op(left, right, out)) {
+		return fail(node, context, error);
+	}
+	return out;
+}
+
+// The operators that give a Value from two small Ints without overflowing,
+// for a right operand that is a small Int constant
+
+struct AddInt {
+	static constexpr BinaryOperator generic = Operators::add;
+	static Value apply(std::int64_t a, std::int64_t b) { return Value::integer(a + b); }
+};
+
+struct SubInt {
+	static constexpr BinaryOperator generic = Operators::sub;
+	static Value apply(std::int64_t a, std::int64_t b) { return Value::integer(a - b); }
+};
+
+#define NITRO_INT_COMPARISON(name, op, function) \
+	struct name { \
+		static constexpr BinaryOperator generic = Operators::function; \
+		static Value apply(std::int64_t a, std::int64_t b) { return Value::boolean(a op b); } \
+	};
+
+NITRO_INT_COMPARISON(GreaterInt, >, greater)
+NITRO_INT_COMPARISON(GreaterEqualInt, >=, greaterEqual)
+NITRO_INT_COMPARISON(LessInt, <, less)
+NITRO_INT_COMPARISON(LessEqualInt, <=, lessEqual)
+NITRO_INT_COMPARISON(EqualInt, ==, equal)
+NITRO_INT_COMPARISON(NotEqualInt, !=, notEqual)
+
+#undef NITRO_INT_COMPARISON
+
+template <typename Op, typename Left>
+Value binarySmallInt(const Closure* node, ClosureContext& context) {
+	Value left = Left::get(node->left, context);
+	if (left.isSmallInt()) {
+		return Op::apply(left.asSmallInt(), node->right->value.asSmallInt());
+	}
+	Value out;
+	if (const char* error = Op::generic(left, node->right->value, out)) {
+		return fail(node, context, error);
+	}
+	return out;
+}
+
+// Both give a bool: x && y is false as soon as x or y is
+template <bool IsAnd>
+Value logical(const Closure* node, ClosureContext& context) {
+	if (node->left->evaluate(node->left, context).truthy() != IsAnd) {
+		return Value::boolean(!IsAnd);
+	}
+	return Value::boolean(node->right->evaluate(node->right, context).truthy());
+}
+
+template <UnaryOperator Op>
+Value unary(const Closure* node, ClosureContext& context) {
+	Value value = node->left->evaluate(node->left, context);
+	Value out;
+	if (const char* error = Op(value, out)) {
+		return fail(node, context, error);
+	}
+	return out;
+}
+
+// Arguments are pushed above the slots in use, and become the first slots
+// of the callee's frame
+template <typename Callee>
+Value call(const Closure* node, ClosureContext& context) {
+	Value callee = Callee::get(node->left, context);
+
+	Value* args = context.top;
+	if (static_cast<std::size_t>(context.end - args) < node->count) {
+		return fail(node, context, "Stack overflow");
+	}
+	for (std::uint32_t i = 0; i < node->count; i++) {
+		const Closure* arg = node->children[i];
+		Value value = arg->evaluate(arg, context);
+		args[i] = value;
+		context.top = args + i + 1;
+	}
+	context.top = args;
+	if (context.failed) {
+		return Value::nil();
+	}
+
+	if (callee.isNative()) {
+		return natives()[callee.asIndex()].function(*context.output, args, node->count);
+	}
+	if (!callee.isFunction()) {
+		return fail(node, context, "Only functions can be called");
+	}
+
+	const ClosureFunction& function = context.program->functions[callee.asIndex()];
+	if (node->count != function.arity) {
+		return arityError(node, context, function.arity);
+	}
+	if (context.frames == ClosureEvaluator::MAX_FRAMES ||
+		static_cast<std::size_t>(context.end - args) < function.frame_size) {
+		return fail(node, context, "Stack overflow");
+	}
+
+	for (Value* slot = args + node->count; slot < args + function.frame_size; slot++) {
+		*slot = Value();
+	}
+	Value* caller = context.base;
+	context.base = args;
+	context.top = args + function.frame_size;
+	context.frames++;
+	if (context.ints->wantsCollection()) {
+		collect(context);
+	}
+
+	char probe;
+	if (reinterpret_cast<std::uintptr_t>(&probe) < context.stack_limit) {
+		evaluateOnNewStack(node, function.body, context);
+	} else {
+		function.body->evaluate(function.body, context);
+	}
+
+	context.frames--;
+	context.base = caller;
+	context.top = args;
+	if (context.failed) {
+		return Value::nil();
+	}
+	// Without a return, result is left from another function
+	Value result = context.stop ? context.result : Value();
+	context.stop = false;
+	return result;
+}
+
+Value declareLocal(const Closure* node, ClosureContext& context) {
+	context.base[node->index] = node->left->evaluate(node->left, context);
+	return Value::nil();
+}
+
+Value declareGlobal(const Closure* node, ClosureContext& context) {
+	context.globals[node->index] = node->left->evaluate(node->left, context);
+	return Value::nil();
+}
+
+Value statements(const Closure* node, ClosureContext& context) {
+	for (std::uint32_t i = 0; i < node->count && !context.stop; i++) {
+		const Closure* statement = node->children[i];
+		statement->evaluate(statement, context);
+	}
+	return Value::nil();
+}
+
+// Children are each condition followed by its branch, then the else branch
+// if there is one
+Value conditional(const Closure* node, ClosureContext& context) {
+	std::uint32_t i = 0;
+	for (; i + 1 < node->count; i += 2) {
+		const Closure* condition = node->children[i];
+		Value value = condition->evaluate(condition, context);
+		if (context.stop) {
+			return Value::nil();
+		}
+		if (value.truthy()) {
+			const Closure* branch = node->children[i + 1];
+			return branch->evaluate(branch, context);
+		}
+	}
+	if (i < node->count) {
+		const Closure* branch = node->children[i];
+		return branch->evaluate(branch, context);
+	}
+	return Value::nil();
+}
+
+Value functionReturn(const Closure* node, ClosureContext& context) {
+	Value value = node->left->evaluate(node->left, context);
+	if (!context.failed) {
+		context.result = value;
+		context.stop = true;
+	}
+	return Value::nil();
+}
+
+enum class Operand {
+	Any,
+	Constant,
+	Local
+};
+
+Operand operandOf(const Closure* node) {
+	if (node->evaluate == constant) {
+		return Operand::Constant;
+	}
+	if (node->evaluate == local) {
+		return Operand::Local;
+	}
+	return Operand::Any;
+}
+
+template <typename Left>
+Evaluate smallIntFor(ASTNodeBinary::Type type) {
+	using Type = ASTNodeBinary::Type;
+	switch (type) {
+		case Type::Add: return binarySmallInt<AddInt, Left>;
+		case Type::Sub: return binarySmallInt<SubInt, Left>;
+		case Type::Greater: return binarySmallInt<GreaterInt, Left>;
+		case Type::GreaterEqual: return binarySmallInt<GreaterEqualInt, Left>;
+		case Type::Less: return binarySmallInt<LessInt, Left>;
+		case Type::LessEqual: return binarySmallInt<LessEqualInt, Left>;
+		case Type::Equality: return binarySmallInt<EqualInt, Left>;
+		case Type::NonEquality: return binarySmallInt<NotEqualInt, Left>;
+		default: return nullptr;
+	}
+}
+
+template <typename Left, typename Right>
+Evaluate binaryFor(ASTNodeBinary::Type type) {
+	using Type = ASTNodeBinary::Type;
+	switch (type) {
+		case Type::Add: return binary<Operators::add, Left, Right>;
+		case Type::Sub: return binary<Operators::sub, Left, Right>;
+		case Type::Mult: return binary<Operators::mult, Left, Right>;
+		case Type::Div: return binary<Operators::div, Left, Right>;
+		case Type::Pow: return binary<Operators::pow, Left, Right>;
+		case Type::Greater: return binary<Operators::greater, Left, Right>;
+		case Type::GreaterEqual: return binary<Operators::greaterEqual, Left, Right>;
+		case Type::RShift: return binary<Operators::rshift, Left, Right>;
+		case Type::Less: return binary<Operators::less, Left, Right>;
+		case Type::LessEqual: return binary<Operators::lessEqual, Left, Right>;
+		case Type::LShift: return binary<Operators::lshift, Left, Right>;
+		case Type::Equality: return binary<Operators::equal, Left, Right>;
+		case Type::NonEquality: return binary<Operators::notEqual, Left, Right>;
+		case Type::BitwiseAnd: return binary<Operators::bitwiseAnd, Left, Right>;
+		case Type::BitwiseOr: return binary<Operators::bitwiseOr, Left, Right>;
+		case Type::BitwiseXor: return binary<Operators::bitwiseXor, Left, Right>;
+		case Type::And: return logical<true>;
+		case Type::Or: return logical<false>;
+	}
+	return nullptr;
+}
+
+template <typename Left>
+Evaluate binaryFor(ASTNodeBinary::Type type, Operand right) {
+	switch (right) {
+		case Operand::Any: return binaryFor<Left, AnyOperand>(type);
+		case Operand::Constant: return binaryFor<Left, ConstantOperand>(type);
+		case Operand::Local: return binaryFor<Left, LocalOperand>(type);
+	}
+	return nullptr;
+}
+
+/**
+* The function for a binary operator with operands left and right.
+*/
+Evaluate binaryFor(ASTNodeBinary::Type type, const Closure* left, const Closure* right) {
+	Operand left_kind = operandOf(left);
+	Operand right_kind = operandOf(right);
+
+	if (right_kind == Operand::Constant && right->value.isSmallInt() && left_kind != Operand::Constant) {
+		Evaluate evaluate = left_kind == Operand::Local ? smallIntFor<LocalOperand>(type) : smallIntFor<AnyOperand>(type);
+		if (evaluate) {
+			return evaluate;
+		}
+	}
+
+	switch (left_kind) {
+		case Operand::Any: return binaryFor<AnyOperand>(type, right_kind);
+		case Operand::Constant: return binaryFor<ConstantOperand>(type, right_kind);
+		case Operand::Local: return binaryFor<LocalOperand>(type, right_kind);
+	}
+	return nullptr;
+}
+
+} // namespace
+
+ClosureProgram ClosureCompiler::compile(ASTNode* program, const ScopeResolver& resolver) {
+	ClosureProgram result;
+	m_program = &result;
+	IntHeap::Scope ints(result.ints);
+
+	TopLevel top = TopLevel::of(program, resolver);
+	result.globals = std::move(top.globals);
+	result.functions.resize(1 + top.functions.size());
+
+	ClosureFunction& script = result.functions[0];
+	script.name = "<script>";
+	script.frame_size = resolver.programFrameSize();
+	std::vector<const Closure*> body;
+	for (ASTNode* statement : top.statements) {
+		body.push_back(this->statement(statement));
+	}
+	Closure* set = make(statements, program ? program->m_tok : Token{});
+	set->count = static_cast<std::uint32_t>(body.size());
+	set->children = list(std::move(body));
+	script.body = set;
+
+	for (std::size_t i = 0; i < top.functions.size(); i++) {
+		ASTNodeFunctionDefinition& definition = *top.functions[i];
+		ClosureFunction& function = result.functions[i + 1];
+		function.name = definition.m_identifier;
+		function.arity = static_cast<std::uint32_t>(definition.m_args.size());
+		function.frame_size = definition.m_frame_size;
+		visit(definition);
+		function.body = m_result;
+	}
+
+	m_program = nullptr;
+	m_result = nullptr;
+	return result;
+}
+
+const Closure* ClosureCompiler::expression(ASTNode* node) {
+	if (!node) {
+		// Only left by a parse error
+		return constant(Value::nil(), Token{});
+	}
+	node->visit(*this);
+	return m_result;
+}
+
+const Closure* ClosureCompiler::statement(ASTNode* node) {
+	if (!node) {
+		return make(nothing, Token{});
+	}
+	if (node->m_kind == ASTKind::FunctionDefinition) {
+		error(node->m_tok, "Functions can only be defined at the top level");
+		return make(nothing, node->m_tok);
+	}
+	// An expression statement is the expression, its value ignored
+	node->visit(*this);
+	return m_result;
+}
+
+Closure* ClosureCompiler::make(Evaluate evaluate, const Token& at) {
+	Closure& closure = m_program->closures.emplace_back();
+	closure.evaluate = evaluate;
+	closure.line = static_cast<std::uint32_t>(at.line);
+	closure.col = static_cast<std::uint32_t>(at.col);
+	return &closure;
+}
+
+Closure* ClosureCompiler::constant(Value value, const Token& at) {
+	Closure* closure = make(Nitro::constant, at);
+	closure->value = value;
+	return closure;
+}
+
+const Closure* const* ClosureCompiler::list(std::vector<const Closure*> closures) {
+	return m_program->lists.emplace_back(std::move(closures)).data();
+}
+
+void ClosureCompiler::error(const Token& at, const char* msg) {
+	m_had_error = true;
+	*m_diagnostics << "Error: " << at.line << ":" << at.col << ": " << msg << "\n";
+}
+
+void ClosureCompiler::visit(ASTNodeConstant<std::int64_t>& node) {
+	m_result = constant(Value::integer(node.m_value), node.m_tok);
+}
+
+void ClosureCompiler::visit(ASTNodeConstant<double>& node) {
+	m_result = constant(Value::floating(node.m_value), node.m_tok);
+}
+
+void ClosureCompiler::visit(ASTNodeConstant<bool>& node) {
+	m_result = constant(Value::boolean(node.m_value), node.m_tok);
+}
+
+void ClosureCompiler::visit(ASTNodeConstant<std::string_view>& node) {
+	m_program->strings.push_back(node.m_value);
+	m_result = constant(Value::string(&m_program->strings.back()), node.m_tok);
+}
+
+void ClosureCompiler::visit(ASTNodeConstant<char>& node) {
+	m_result = constant(Value::character(node.m_value), node.m_tok);
+}
+
+void ClosureCompiler::visit(ASTNodeNil& node) {
+	m_result = constant(Value::nil(), node.m_tok);
+}
+
+void ClosureCompiler::visit(ASTNodeBinary& node) {
+	const Closure* left = expression(node.m_left);
+	const Closure* right = expression(node.m_right);
+	Closure* closure = make(binaryFor(node.m_type, left, right), node.m_tok);
+	closure->left = left;
+	closure->right = right;
+	m_result = closure;
+}
+
+void ClosureCompiler::visit(ASTNodeUnary& node) {
+	const Closure* value = expression(node.m_branch);
+
+	Evaluate evaluate = nullptr;
+	switch (node.m_type) {
+		case ASTNodeUnary::Type::Plus:
+			m_result = value;
+			return;
+		case ASTNodeUnary::Type::Negate: evaluate = unary<Operators::negate>; break;
+		case ASTNodeUnary::Type::Not: evaluate = unary<Operators::logicalNot>; break;
+		case ASTNodeUnary::Type::BitwiseNot: evaluate = unary<Operators::bitwiseNot>; break;
+	}
+
+	Closure* closure = make(evaluate, node.m_tok);
+	closure->left = value;
+	m_result = closure;
+}
+
+void ClosureCompiler::visit(ASTNodeVariableInvokation& node) {
+	Closure* variable = nullptr;
+	switch (node.m_slot.kind) {
+		case ASTSlot::Kind::Local:
+			if (node.m_slot.depth != 0) {
+				error(node.m_tok, "Variables of an enclosing function cannot be used");
+			}
+			variable = make(local, node.m_tok);
+			variable->index = node.m_slot.index;
+			break;
+		case ASTSlot::Kind::Global:
+			variable = make(global, node.m_tok);
+			variable->index = node.m_slot.index;
+			break;
+		case ASTSlot::Kind::Unresolved:
+			// Reported by the resolver
+			m_had_error = true;
+			variable = constant(Value::nil(), node.m_tok);
+			break;
+	}
+
+	if (!node.m_call) {
+		m_result = variable;
+		return;
+	}
+
+	std::vector<const Closure*> args;
+	for (ASTNode* arg : node.m_args) {
+		args.push_back(expression(arg));
+	}
+	// Functions are called by the global holding them
+	Closure* closure = make(variable->evaluate == global ? call<GlobalOperand> : call<AnyOperand>, node.m_tok);
+	closure->left = variable;
+	closure->count = static_cast<std::uint32_t>(args.size());
+	closure->children = list(std::move(args));
+	m_result = closure;
+}
+
+void ClosureCompiler::visit(ASTNodeVariableDeclaration& node) {
+	const Closure* value = expression(node.m_assign);
+	Closure* closure = make(node.m_slot.kind == ASTSlot::Kind::Global ? declareGlobal : declareLocal, node.m_tok);
+	closure->left = value;
+	closure->index = node.m_slot.index;
+	m_result = closure;
+}
+
+void ClosureCompiler::visit(ASTNodeStatementSet& node) {
+	std::vector<const Closure*> body;
+	for (ASTNode* statement : node.m_statements) {
+		body.push_back(this->statement(statement));
+	}
+	if (body.size() == 1) {
+		m_result = body[0];
+		return;
+	}
+	Closure* closure = make(statements, node.m_tok);
+	closure->count = static_cast<std::uint32_t>(body.size());
+	closure->children = list(std::move(body));
+	m_result = closure;
+}
+
+void ClosureCompiler::visit(ASTNodeConditional& node) {
+	std::vector<const Closure*> children;
+	for (auto& condition : node.m_conditions) {
+		children.push_back(expression(condition.first));
+		children.push_back(statement(condition.second));
+	}
+	if (node.m_else_statement) {
+		children.push_back(statement(node.m_else_statement));
+	}
+	Closure* closure = make(conditional, node.m_tok);
+	closure->count = static_cast<std::uint32_t>(children.size());
+	closure->children = list(std::move(children));
+	m_result = closure;
+}
+
+void ClosureCompiler::visit(ASTNodeFunctionDefinition& node) {
+	if (!node.m_contents) {
+		error(node.m_tok, "Function body was not parsed");
+	}
+	m_result = statement(node.m_contents);
+}
+
+void ClosureCompiler::visit(ASTNodeFunctionReturn& node) {
+	Closure* closure = make(functionReturn, node.m_tok);
+	closure->left = node.m_expr ? expression(node.m_expr) : constant(Value::nil(), node.m_tok);
+	m_result = closure;
+}
+
+} // namespace Nitro
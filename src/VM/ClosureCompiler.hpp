@@ -0,0 +1,101 @@
+#pragma once
+
+#include <cstdint>
+#include <iostream>
+#include <vector>
+
+#include "../global/defs.hpp"
+#include "../AST/ASTNode.hpp"
+#include "../AST/ASTVisitor.hpp"
+#include "Closure.hpp"
+
+namespace Nitro {
+
+class ScopeResolver;
+
+/**
+* Compiles a tree, resolved as for the BytecodeCompiler, to closures in a
+* single pass: every node becomes a Closure calling its children directly,
+* so running it needs no visitor.
+*
+* The function of a binary operator is specialized for its operands: a
+* constant or a local is read in place instead of through a call, and an
+* arithmetic or comparison operator with a small Int constant operand tries
+* integer math first.
+*/
+class ClosureCompiler : public ASTVisitor {
+public:
+	NITRO_DISABLE_COPY_MOVE(ClosureCompiler)
+
+	ClosureCompiler() = default;
+
+	ClosureProgram compile(ASTNode* program, const ScopeResolver& resolver);
+
+	/**
+	* Where errors are written, std::cerr by default. out must outlive the
+	* compiler.
+	*/
+	void setDiagnostics(std::ostream& out) { m_diagnostics = &out; }
+
+	bool hadError() const { return m_had_error; }
+
+	void visit(ASTNodeConstant<std::int64_t>& node) override;
+
+	void visit(ASTNodeConstant<double>& node) override;
+
+	void visit(ASTNodeConstant<bool>& node) override;
+
+	void visit(ASTNodeConstant<std::string_view>& node) override;
+
+	void visit(ASTNodeConstant<char>& node) override;
+
+	void visit(ASTNodeNil& node) override;
+
+	void visit(ASTNodeBinary& node) override;
+
+	void visit(ASTNodeUnary& node) override;
+
+	void visit(ASTNodeVariableInvokation& node) override;
+
+	void visit(ASTNodeVariableDeclaration& node) override;
+
+	void visit(ASTNodeStatementSet& node) override;
+
+	void visit(ASTNodeConditional& node) override;
+
+	void visit(ASTNodeFunctionDefinition& node) override;
+
+	void visit(ASTNodeFunctionReturn& node) override;
+
+private:
+	/**
+	* Compiles an expression, nil if it is missing.
+	*/
+	const Closure* expression(ASTNode* node);
+
+	/**
+	* Compiles a statement, which does nothing if it is missing.
+	*/
+	const Closure* statement(ASTNode* node);
+
+	Closure* make(Evaluate evaluate, const Token& at);
+
+	Closure* constant(Value value, const Token& at);
+
+	/**
+	* Stores closures for a node's children.
+	*/
+	const Closure* const* list(std::vector<const Closure*> closures);
+
+	void error(const Token& at, const char* msg);
+
+	ClosureProgram* m_program = nullptr;
+
+	// What the last node visited compiled to
+	const Closure* m_result = nullptr;
+
+	std::ostream* m_diagnostics = &std::cerr;
+	bool m_had_error = false;
+};
+
+} // namespace Nitro
@@ -0,0 +1,42 @@
+#include "ClosureEvaluator.hpp"
+
+#include <algorithm>
+#include <cstdint>
+
+namespace Nitro {
+
+ClosureEvaluator::ClosureEvaluator(const ClosureProgram& program) : m_program(program), m_stack(STACK_SIZE) {}
+
+bool ClosureEvaluator::run() {
+	m_globals = m_program.globals;
+	m_ints.clear();
+	IntHeap::Scope ints(m_ints);
+
+	const ClosureFunction& script = m_program.functions[0];
+	if (script.frame_size > m_stack.size()) {
+		*m_diagnostics << "Runtime error: " << script.body->line << ":" << script.body->col << ": Stack overflow\n";
+		return false;
+	}
+	std::fill(m_stack.begin(), m_stack.begin() + script.frame_size, Value());
+
+	// The stack grows down from here
+	char probe;
+	auto here = reinterpret_cast<std::uintptr_t>(&probe);
+
+	ClosureContext context;
+	context.program = &m_program;
+	context.globals = m_globals.data();
+	context.stack = m_stack.data();
+	context.base = m_stack.data();
+	context.top = m_stack.data() + script.frame_size;
+	context.end = m_stack.data() + m_stack.size();
+	context.stack_limit = here > FIRST_SEGMENT_SIZE ? here - FIRST_SEGMENT_SIZE : 0;
+	context.ints = &m_ints;
+	context.output = m_output;
+	context.diagnostics = m_diagnostics;
+
+	script.body->evaluate(script.body, context);
+	return !context.failed;
+}
+
+} // namespace Nitro
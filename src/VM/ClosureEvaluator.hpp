@@ -0,0 +1,80 @@
+#pragma once
+
+#include <cstddef>
+#include <iostream>
+#include <vector>
+
+#include "../global/defs.hpp"
+#include "Closure.hpp"
+#include "Value.hpp"
+
+namespace Nitro {
+
+/**
+* Runs a ClosureProgram. Nothing is decoded or dispatched: each closure
+* calls its children, so a script call is a native call, and the frames
+* share a stack of Values as in the VM. A call fails with a stack overflow
+* where the VMs' would.
+*
+* It starts sooner than the VMs on a short script, as compiling is a
+* single pass with no bytecode to lay out.
+*/
+class ClosureEvaluator {
+public:
+	NITRO_DISABLE_COPY_MOVE(ClosureEvaluator)
+
+	/**
+	* Values on the stack, for every frame together.
+	*/
+	static constexpr std::size_t STACK_SIZE = 1 << 20;
+
+	static constexpr std::size_t MAX_FRAMES = 1 << 16;
+
+	/**
+	* Script calls recurse natively. A run takes this much of the stack of
+	* the thread calling run(), then goes on on a new thread with a stack of
+	* STACK_SEGMENT_SIZE, and so on, so recursion goes as deep as MAX_FRAMES
+	* allows whatever the size of the native frames.
+	*/
+	static constexpr std::size_t FIRST_SEGMENT_SIZE = 256 << 10;
+	static constexpr std::size_t STACK_SEGMENT_SIZE = 64 << 20;
+
+	/**
+	* Stack left past the end of a segment, for what runs between two calls.
+	*/
+	static constexpr std::size_t STACK_MARGIN = 256 << 10;
+
+	/**
+	* The program must outlive the evaluator.
+	*/
+	explicit ClosureEvaluator(const ClosureProgram& program);
+
+	/**
+	* Where the script's output goes, std::cout by default.
+	*/
+	void setOutput(std::ostream& out) { m_output = &out; }
+
+	/**
+	* Where runtime errors are written, std::cerr by default.
+	*/
+	void setDiagnostics(std::ostream& out) { m_diagnostics = &out; }
+
+	/**
+	* Runs the script from the start, with the globals reset. Returns false
+	* after a runtime error.
+	*/
+	bool run();
+
+private:
+	const ClosureProgram& m_program;
+	std::vector<Value> m_stack;
+	std::vector<Value> m_globals;
+
+	// Integers too wide for a Value made by the last run
+	IntHeap m_ints;
+
+	std::ostream* m_output = &std::cout;
+	std::ostream* m_diagnostics = &std::cerr;
+};
+
+} // namespace Nitro
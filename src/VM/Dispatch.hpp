@@ -0,0 +1,52 @@
+#pragma once
+
+/**
+* How the VMs get from one instruction to the next, chosen with NITRO_DISPATCH
+* in CMakeLists.txt:
+*
+* NITRO_DISPATCH_SWITCH: a switch in a loop. Portable, but every instruction
+* leaves through the same indirect branch, which predicts poorly.
+*
+* NITRO_DISPATCH_THREADED: every handler ends with its own jump to the next
+* one, through a table of handler addresses taken with the labels as values
+* extension of GCC and Clang. Each jump is predicted from its own history,
+* which follows the patterns of the script.
+*
+* NITRO_DISPATCH_PREDECODED: the first run rewrites the code of the program
+* with the handler addresses in place of the opcodes, so a jump needs no
+* table (direct threading).
+*/
+#if !defined(NITRO_DISPATCH_SWITCH) && !defined(NITRO_DISPATCH_THREADED) && !defined(NITRO_DISPATCH_PREDECODED)
+	#if defined(__GNUC__)
+		#define NITRO_DISPATCH_THREADED
+	#else
+		#define NITRO_DISPATCH_SWITCH
+	#endif
+#endif
+
+#if !defined(NITRO_DISPATCH_SWITCH) && !defined(__GNUC__)
+	#error "Threaded dispatch needs labels as values, use NITRO_DISPATCH=switch"
+#endif
+
+/**
+* With NITRO_COUNT_DISPATCHES the VMs count the instructions they run, see
+* their dispatches(). The count slows every dispatch down, so only the
+* benchmarks that report it are built with it.
+*/
+#if defined(NITRO_COUNT_DISPATCHES)
+	#define NITRO_COUNT_DISPATCH(counter) ((counter)++)
+#else
+	#define NITRO_COUNT_DISPATCH(counter) ((void)0)
+#endif
+
+namespace Nitro {
+
+#if defined(NITRO_DISPATCH_SWITCH)
+constexpr const char* DISPATCH_STRATEGY = "switch";
+#elif defined(NITRO_DISPATCH_THREADED)
+constexpr const char* DISPATCH_STRATEGY = "threaded";
+#else
+constexpr const char* DISPATCH_STRATEGY = "predecoded";
+#endif
+
+} // namespace Nitro
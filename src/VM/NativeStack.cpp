@@ -0,0 +1,82 @@
+#include "NativeStack.hpp"
+
+#if defined(_WIN32)
+	#include <windows.h>
+#elif defined(__unix__) || defined(__APPLE__)
+	#include <pthread.h>
+#endif
+
+namespace Nitro {
+
+namespace {
+
+struct Job {
+	void (*body)(void*);
+	void* arg;
+};
+
+} // namespace
+
+#if defined(_WIN32)
+
+namespace {
+
+DWORD WINAPI start(LPVOID arg) {
+	Job* job = static_cast<Job*>(arg);
+	job->body(job->arg);
+	return 0;
+}
+
+} // namespace
+
+bool runOnNewStack(std::size_t size, void (*body)(void*), void* arg) {
+	Job job{ body, arg };
+	HANDLE thread = CreateThread(nullptr, size, start, &job, STACK_SIZE_PARAM_IS_A_RESERVATION, nullptr);
+	if (!thread) {
+		return false;
+	}
+	WaitForSingleObject(thread, INFINITE);
+	CloseHandle(thread);
+	return true;
+}
+
+#elif defined(__unix__) || defined(__APPLE__)
+
+namespace {
+
+void* start(void* arg) {
+	Job* job = static_cast<Job*>(arg);
+	job->body(job->arg);
+	return nullptr;
+}
+
+} // namespace
+
+bool runOnNewStack(std::size_t size, void (*body)(void*), void* arg) {
+	pthread_attr_t attributes;
+	if (pthread_attr_init(&attributes) != 0) {
+		return false;
+	}
+
+	Job job{ body, arg };
+	pthread_t thread;
+	bool started = pthread_attr_setstacksize(&attributes, size) == 0 &&
+		pthread_create(&thread, &attributes, start, &job) == 0;
+	pthread_attr_destroy(&attributes);
+
+	if (started) {
+		pthread_join(thread, nullptr);
+	}
+	return started;
+}
+
+#else
+
+// No way to choose the stack size of a thread
+bool runOnNewStack(std::size_t, void (*)(void*), void*) {
+	return false;
+}
+
+#endif
+
+} // namespace Nitro
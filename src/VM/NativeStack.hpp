@@ -0,0 +1,14 @@
+#pragma once
+
+#include <cstddef>
+
+namespace Nitro {
+
+/**
+* Runs body(arg) on a new thread with a stack of size bytes, and waits for it
+* to return. For an engine that recurses natively and needs more stack than
+* the thread running it has. Returns false if no thread could be started.
+*/
+bool runOnNewStack(std::size_t size, void (*body)(void*), void* arg);
+
+} // namespace Nitro
@@ -0,0 +1,30 @@
+#include "Natives.hpp"
+
+namespace Nitro {
+
+namespace {
+
+/**
+* Writes its arguments separated by spaces, then a newline.
+*/
+Value print(std::ostream& out, const Value* args, std::size_t count) {
+	for (std::size_t i = 0; i < count; i++) {
+		if (i > 0) {
+			out << ' ';
+		}
+		out << args[i];
+	}
+	out << '\n';
+	return Value::nil();
+}
+
+} // namespace
+
+const std::vector<Native>& natives() {
+	static const std::vector<Native> table = {
+		{ "print", print },
+	};
+	return table;
+}
+
+} // namespace Nitro
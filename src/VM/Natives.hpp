@@ -0,0 +1,27 @@
+#pragma once
+
+#include <cstddef>
+#include <ostream>
+#include <string_view>
+#include <vector>
+
+#include "Value.hpp"
+
+namespace Nitro {
+
+/**
+* A function provided by the host. out is where the script's output goes.
+*/
+using NativeFunction = Value (*)(std::ostream& out, const Value* args, std::size_t count);
+
+struct Native {
+	std::string_view name;
+	NativeFunction function;
+};
+
+/**
+* The functions every script can call, by the index of Value::native().
+*/
+const std::vector<Native>& natives();
+
+} // namespace Nitro
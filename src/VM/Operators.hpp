@@ -0,0 +1,211 @@
+#pragma once
+
+#include <cmath>
+#include <cstdint>
+#include <limits>
+
+#include "Value.hpp"
+
+namespace Nitro {
+
+/**
+* The operators of the language on Values, for every engine to share. Each
+* one stores its result in out and returns null, or returns the error to
+* report if the operands do not allow it.
+*
+* Integers are 64 bit and wrap around, an operator with a float operand
+* works on floats, comparisons give bools. ConstantFolder folds constants
+* by the same rules.
+*
+* Small Ints and Floats take a shorter path: the sum or difference of two
+* small Ints cannot overflow, and neither needs converting.
+*/
+namespace Operators {
+
+// Unsigned arithmetic wraps around without overflowing
+inline std::int64_t wrap(std::uint64_t value) {
+	return static_cast<std::int64_t>(value);
+}
+
+inline std::int64_t power(std::int64_t base, std::int64_t exponent) {
+	std::uint64_t result = 1;
+	std::uint64_t factor = static_cast<std::uint64_t>(base);
+	for (auto e = static_cast<std::uint64_t>(exponent); e > 0; e >>= 1) {
+		if (e & 1) {
+			result *= factor;
+		}
+		factor *= factor;
+	}
+	return wrap(result);
+}
+
+inline const char* add(const Value& a, const Value& b, Value& out) {
+	if (Value::areSmallInts(a, b)) {
+		out = Value::integer(a.asSmallInt() + b.asSmallInt());
+	} else if (Value::areFloats(a, b)) {
+		out = Value::floating(a.asFloat() + b.asFloat());
+	} else if (a.isInt() && b.isInt()) {
+		out = Value::integer(wrap(static_cast<std::uint64_t>(a.asInt()) + static_cast<std::uint64_t>(b.asInt())));
+	} else if (a.isNumber() && b.isNumber()) {
+		out = Value::floating(a.toFloat() + b.toFloat());
+	} else {
+		return "Operands of + must be numbers";
+	}
+	return nullptr;
+}
+
+inline const char* sub(const Value& a, const Value& b, Value& out) {
+	if (Value::areSmallInts(a, b)) {
+		out = Value::integer(a.asSmallInt() - b.asSmallInt());
+	} else if (Value::areFloats(a, b)) {
+		out = Value::floating(a.asFloat() - b.asFloat());
+	} else if (a.isInt() && b.isInt()) {
+		out = Value::integer(wrap(static_cast<std::uint64_t>(a.asInt()) - static_cast<std::uint64_t>(b.asInt())));
+	} else if (a.isNumber() && b.isNumber()) {
+		out = Value::floating(a.toFloat() - b.toFloat());
+	} else {
+		return "Operands of - must be numbers";
+	}
+	return nullptr;
+}
+
+inline const char* mult(const Value& a, const Value& b, Value& out) {
+	if (a.isInt() && b.isInt()) {
+		out = Value::integer(wrap(static_cast<std::uint64_t>(a.asInt()) * static_cast<std::uint64_t>(b.asInt())));
+	} else if (Value::areFloats(a, b)) {
+		out = Value::floating(a.asFloat() * b.asFloat());
+	} else if (a.isNumber() && b.isNumber()) {
+		out = Value::floating(a.toFloat() * b.toFloat());
+	} else {
+		return "Operands of * must be numbers";
+	}
+	return nullptr;
+}
+
+inline const char* div(const Value& a, const Value& b, Value& out) {
+	if (a.isInt() && b.isInt()) {
+		if (b.asInt() == 0) {
+			return "Integer division by zero";
+		}
+		if (a.asInt() == std::numeric_limits<std::int64_t>::min() && b.asInt() == -1) {
+			return "Integer division overflow";
+		}
+		out = Value::integer(a.asInt() / b.asInt());
+	} else if (a.isNumber() && b.isNumber()) {
+		out = Value::floating(a.toFloat() / b.toFloat());
+	} else {
+		return "Operands of / must be numbers";
+	}
+	return nullptr;
+}
+
+inline const char* pow(const Value& a, const Value& b, Value& out) {
+	if (a.isInt() && b.isInt() && b.asInt() >= 0) {
+		out = Value::integer(power(a.asInt(), b.asInt()));
+	} else if (a.isNumber() && b.isNumber()) {
+		out = Value::floating(std::pow(a.toFloat(), b.toFloat()));
+	} else {
+		return "Operands of ** must be numbers";
+	}
+	return nullptr;
+}
+
+#define NITRO_COMPARISON(name, op, text) \
+	inline const char* name(const Value& a, const Value& b, Value& out) { \
+		if (Value::areSmallInts(a, b)) { \
+			out = Value::boolean(a.asSmallInt() op b.asSmallInt()); \
+		} else if (a.isInt() && b.isInt()) { \
+			out = Value::boolean(a.asInt() op b.asInt()); \
+		} else if (a.isNumber() && b.isNumber()) { \
+			out = Value::boolean(a.toFloat() op b.toFloat()); \
+		} else { \
+			return "Operands of " text " must be numbers"; \
+		} \
+		return nullptr; \
+	}
+
+NITRO_COMPARISON(greater, >, ">")
+NITRO_COMPARISON(greaterEqual, >=, ">=")
+NITRO_COMPARISON(less, <, "<")
+NITRO_COMPARISON(lessEqual, <=, "<=")
+
+#undef NITRO_COMPARISON
+
+inline const char* lshift(const Value& a, const Value& b, Value& out) {
+	if (!a.isInt() || !b.isInt()) {
+		return "Operands of << must be integers";
+	}
+	if (b.asInt() < 0 || b.asInt() >= 64) {
+		return "Shift amount out of range";
+	}
+	out = Value::integer(wrap(static_cast<std::uint64_t>(a.asInt()) << b.asInt()));
+	return nullptr;
+}
+
+inline const char* rshift(const Value& a, const Value& b, Value& out) {
+	if (!a.isInt() || !b.isInt()) {
+		return "Operands of >> must be integers";
+	}
+	if (b.asInt() < 0 || b.asInt() >= 64) {
+		return "Shift amount out of range";
+	}
+	out = Value::integer(a.asInt() >> b.asInt());
+	return nullptr;
+}
+
+inline const char* equal(const Value& a, const Value& b, Value& out) {
+	out = Value::boolean(Value::areSmallInts(a, b) ? a.bits() == b.bits() : a.equals(b));
+	return nullptr;
+}
+
+inline const char* notEqual(const Value& a, const Value& b, Value& out) {
+	out = Value::boolean(Value::areSmallInts(a, b) ? a.bits() != b.bits() : !a.equals(b));
+	return nullptr;
+}
+
+#define NITRO_BITWISE(name, op, text) \
+	inline const char* name(const Value& a, const Value& b, Value& out) { \
+		if (Value::areSmallInts(a, b)) { \
+			out = Value::integer(a.asSmallInt() op b.asSmallInt()); \
+			return nullptr; \
+		} \
+		if (!a.isInt() || !b.isInt()) { \
+			return "Operands of " text " must be integers"; \
+		} \
+		out = Value::integer(a.asInt() op b.asInt()); \
+		return nullptr; \
+	}
+
+NITRO_BITWISE(bitwiseAnd, &, "&")
+NITRO_BITWISE(bitwiseOr, |, "|")
+NITRO_BITWISE(bitwiseXor, ^, "^")
+
+#undef NITRO_BITWISE
+
+inline const char* negate(const Value& a, Value& out) {
+	if (a.isInt()) {
+		out = Value::integer(wrap(0 - static_cast<std::uint64_t>(a.asInt())));
+	} else if (a.isFloat()) {
+		out = Value::floating(-a.asFloat());
+	} else {
+		return "Operand of - must be a number";
+	}
+	return nullptr;
+}
+
+inline const char* logicalNot(const Value& a, Value& out) {
+	out = Value::boolean(!a.truthy());
+	return nullptr;
+}
+
+inline const char* bitwiseNot(const Value& a, Value& out) {
+	if (!a.isInt()) {
+		return "Operand of ~ must be an integer";
+	}
+	out = Value::integer(~a.asInt());
+	return nullptr;
+}
+
+} // namespace Operators
+
+} // namespace Nitro
@@ -0,0 +1,99 @@
+#pragma once
+
+#include <cstdint>
+#include <deque>
+#include <string_view>
+#include <vector>
+
+#include "../global/defs.hpp"
+#include "Bytecode.hpp"
+#include "Value.hpp"
+
+namespace Nitro {
+
+/**
+* Instructions of the RegisterVM, which take their operands from registers
+* of the frame instead of a stack: A = B op C. R(x) is register x, RK(x) is
+* register x or, with RegisterInstruction::CONSTANT set, constant x.
+*/
+enum class RegisterOp : std::uint8_t {
+	Move,          // R(A) = RK(B)
+	GetGlobal,     // R(A) = global B
+	SetGlobal,     // global A = RK(B)
+
+	// R(A) = RK(B) op RK(C), in the order of ASTNodeBinary::Type
+	Add,
+	Sub,
+	Mult,
+	Div,
+	Pow,
+	Greater,
+	GreaterEqual,
+	RShift,
+	Less,
+	LessEqual,
+	LShift,
+	Equal,
+	NotEqual,
+	BitwiseAnd,
+	BitwiseOr,
+	BitwiseXor,
+
+	// R(A) = op RK(B)
+	Negate,
+	Not,
+	BitwiseNot,
+
+	Jump,          // Skips B instructions
+	JumpIfFalse,   // Skips B instructions if RK(A) is false
+	JumpIfTrue,    // Skips B instructions if RK(A) is true
+
+	Call,          // R(A) = R(A)(R(A + 1), ..., R(A + B))
+	Return         // Returns RK(A)
+};
+
+struct RegisterInstruction {
+	/**
+	* Marks an RK operand that is a constant.
+	*/
+	static constexpr std::uint16_t CONSTANT = 0x8000;
+
+	RegisterOp op;
+	std::uint16_t a;
+	std::uint16_t b;
+	std::uint16_t c;
+};
+
+static_assert(sizeof(RegisterInstruction) == 8, "Instructions should be packed in 8 bytes");
+
+/**
+* A function of a RegisterProgram. Its registers are the slots of its
+* arguments and locals, as the ScopeResolver gave them, followed by the
+* temporaries of its expressions.
+*/
+struct RegisterFunction {
+	std::string_view name;
+	std::uint32_t arity = 0;
+	std::uint32_t frame_size = 0;     // Registers of arguments and locals
+	std::uint32_t register_count = 0; // All registers, temporaries included
+	std::vector<RegisterInstruction> code;
+	std::vector<Value> constants;
+	SourceMap positions;
+};
+
+/**
+* A compiled script, see RegisterCompiler. functions[0] is the top level.
+*/
+struct RegisterProgram {
+	NITRO_DISABLE_COPY(RegisterProgram)
+	NITRO_DEFAULT_MOVE(RegisterProgram)
+
+	RegisterProgram() = default;
+
+	std::vector<RegisterFunction> functions;
+	std::vector<Value> globals;
+	std::deque<std::string_view> strings;
+	IntHeap ints;
+};
+
+} // namespace Nitro
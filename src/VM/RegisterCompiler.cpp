@@ -0,0 +1,371 @@
+#include "RegisterCompiler.hpp"
+
+#include <algorithm>
+#include <utility>
+#include <vector>
+
+#include "../AST/ASTNodeConstant.hpp"
+#include "../AST/ASTNodeNil.hpp"
+#include "../AST/ASTNodeBinary.hpp"
+#include "../AST/ASTNodeUnary.hpp"
+#include "../AST/ASTNodeVariableInvokation.hpp"
+#include "../AST/ASTNodeVariableDeclaration.hpp"
+#include "../AST/ASTNodeStatementSet.hpp"
+#include "../AST/ASTNodeConditional.hpp"
+#include "../AST/ASTNodeFunctionDefinition.hpp"
+#include "../AST/ASTNodeFunctionReturn.hpp"
+#include "../Semantic/ScopeResolver.hpp"
+#include "TopLevel.hpp"
+
+namespace Nitro {
+
+static_assert(static_cast<int>(RegisterOp::BitwiseXor) - static_cast<int>(RegisterOp::Add) ==
+	static_cast<int>(ASTNodeBinary::Type::BitwiseXor) - static_cast<int>(ASTNodeBinary::Type::Add),
+	"Binary opcodes must follow ASTNodeBinary::Type");
+
+// Registers are operands without the constant bit
+static constexpr std::uint32_t MAX_REGISTERS = RegisterInstruction::CONSTANT;
+
+RegisterProgram RegisterCompiler::compile(ASTNode* program, const ScopeResolver& resolver) {
+	RegisterProgram result;
+	m_program = &result;
+	IntHeap::Scope ints(result.ints);
+
+	TopLevel top = TopLevel::of(program, resolver);
+	result.globals = std::move(top.globals);
+	result.functions.resize(1 + top.functions.size());
+
+	m_function = &result.functions[0];
+	m_function->name = "<script>";
+	m_function->frame_size = resolver.programFrameSize();
+	m_function->register_count = m_function->frame_size;
+	m_next = m_function->frame_size;
+	if (m_next > MAX_REGISTERS) {
+		error(program ? program->m_tok : Token{}, "Too many variables in one function");
+	}
+	for (ASTNode* statement : top.statements) {
+		this->statement(statement);
+	}
+	Token end = program ? program->m_tok : Token{};
+	emit(RegisterOp::Return, constant(Value::nil(), end), 0, 0, end);
+
+	for (std::size_t i = 0; i < top.functions.size(); i++) {
+		m_function = &result.functions[i + 1];
+		visit(*top.functions[i]);
+	}
+
+	m_program = nullptr;
+	m_function = nullptr;
+	return result;
+}
+
+void RegisterCompiler::statement(ASTNode* node) {
+	if (!node) {
+		return;
+	}
+
+	switch (node->m_kind) {
+		case ASTKind::VariableDeclaration:
+		case ASTKind::StatementSet:
+		case ASTKind::Conditional:
+		case ASTKind::FunctionReturn:
+			node->visit(*this);
+			break;
+		case ASTKind::FunctionDefinition:
+			error(node->m_tok, "Functions can only be defined at the top level");
+			break;
+		default: {
+			std::uint32_t mark = m_next;
+			operand(node);
+			m_next = mark;
+			break;
+		}
+	}
+}
+
+std::uint16_t RegisterCompiler::operand(ASTNode* node) {
+	if (!node) {
+		// Only left by a parse error
+		return constant(Value::nil(), Token{});
+	}
+
+	switch (node->m_kind) {
+		case ASTKind::Int64:
+			return constant(Value::integer(static_cast<ASTNodeConstant<std::int64_t>*>(node)->m_value), node->m_tok);
+		case ASTKind::Float64:
+			return constant(Value::floating(static_cast<ASTNodeConstant<double>*>(node)->m_value), node->m_tok);
+		case ASTKind::Bool:
+			return constant(Value::boolean(static_cast<ASTNodeConstant<bool>*>(node)->m_value), node->m_tok);
+		case ASTKind::String:
+			m_program->strings.push_back(static_cast<ASTNodeConstant<std::string_view>*>(node)->m_value);
+			return constant(Value::string(&m_program->strings.back()), node->m_tok);
+		case ASTKind::Char:
+			return constant(Value::character(static_cast<ASTNodeConstant<char>*>(node)->m_value), node->m_tok);
+		case ASTKind::Nil:
+			return constant(Value::nil(), node->m_tok);
+		case ASTKind::VariableInvokation: {
+			// A local is read where it lives
+			auto* variable = static_cast<ASTNodeVariableInvokation*>(node);
+			if (!variable->m_call && variable->m_slot.kind == ASTSlot::Kind::Local && variable->m_slot.depth == 0) {
+				return static_cast<std::uint16_t>(variable->m_slot.index);
+			}
+			break;
+		}
+		default:
+			break;
+	}
+
+	std::uint16_t target = allocate(node->m_tok);
+	expression(node, target);
+	return target;
+}
+
+void RegisterCompiler::expression(ASTNode* node, std::uint16_t target) {
+	if (!node) {
+		// Only left by a parse error
+		emit(RegisterOp::Move, target, constant(Value::nil(), Token{}), 0, Token{});
+		return;
+	}
+
+	std::uint16_t outer = m_target;
+	m_target = target;
+	node->visit(*this);
+	m_target = outer;
+}
+
+std::uint16_t RegisterCompiler::constant(Value value, const Token& at) {
+	std::vector<Value>& constants = m_function->constants;
+	if (constants.size() >= RegisterInstruction::CONSTANT) {
+		error(at, "Too many constants in one function");
+		return RegisterInstruction::CONSTANT;
+	}
+	constants.push_back(value);
+	return static_cast<std::uint16_t>(RegisterInstruction::CONSTANT | (constants.size() - 1));
+}
+
+std::uint16_t RegisterCompiler::allocate(const Token& at) {
+	if (m_next >= MAX_REGISTERS) {
+		error(at, "Expression too complex");
+		return 0;
+	}
+	std::uint32_t result = m_next++;
+	m_function->register_count = std::max(m_function->register_count, m_next);
+	return static_cast<std::uint16_t>(result);
+}
+
+void RegisterCompiler::emit(RegisterOp op, std::uint16_t a, std::uint16_t b, std::uint16_t c, const Token& at) {
+	m_function->positions.add(m_function->code.size(), at);
+	m_function->code.push_back(RegisterInstruction{ op, a, b, c });
+}
+
+std::size_t RegisterCompiler::emitJump(RegisterOp op, std::uint16_t condition, const Token& at) {
+	emit(op, condition, 0, 0, at);
+	return m_function->code.size() - 1;
+}
+
+void RegisterCompiler::patchJump(std::size_t index, const Token& at) {
+	std::size_t offset = m_function->code.size() - (index + 1);
+	if (offset > UINT16_MAX) {
+		error(at, "Too much code to jump over");
+	}
+	m_function->code[index].b = static_cast<std::uint16_t>(offset);
+}
+
+void RegisterCompiler::error(const Token& at, const char* msg) {
+	m_had_error = true;
+	*m_diagnostics << "Error: " << at.line << ":" << at.col << ": " << msg << "\n";
+}
+
+void RegisterCompiler::visit(ASTNodeConstant<std::int64_t>& node) {
+	emit(RegisterOp::Move, m_target, constant(Value::integer(node.m_value), node.m_tok), 0, node.m_tok);
+}
+
+void RegisterCompiler::visit(ASTNodeConstant<double>& node) {
+	emit(RegisterOp::Move, m_target, constant(Value::floating(node.m_value), node.m_tok), 0, node.m_tok);
+}
+
+void RegisterCompiler::visit(ASTNodeConstant<bool>& node) {
+	emit(RegisterOp::Move, m_target, constant(Value::boolean(node.m_value), node.m_tok), 0, node.m_tok);
+}
+
+void RegisterCompiler::visit(ASTNodeConstant<std::string_view>& node) {
+	m_program->strings.push_back(node.m_value);
+	emit(RegisterOp::Move, m_target, constant(Value::string(&m_program->strings.back()), node.m_tok), 0, node.m_tok);
+}
+
+void RegisterCompiler::visit(ASTNodeConstant<char>& node) {
+	emit(RegisterOp::Move, m_target, constant(Value::character(node.m_value), node.m_tok), 0, node.m_tok);
+}
+
+void RegisterCompiler::visit(ASTNodeNil& node) {
+	emit(RegisterOp::Move, m_target, constant(Value::nil(), node.m_tok), 0, node.m_tok);
+}
+
+// The target is only written once the operands have been read, so a
+// declaration can compute its value straight into its register
+void RegisterCompiler::visit(ASTNodeBinary& node) {
+	std::uint16_t target = m_target;
+	std::uint32_t mark = m_next;
+
+	if (node.m_type == ASTNodeBinary::Type::And || node.m_type == ASTNodeBinary::Type::Or) {
+		// Both give a bool: x && y is false as soon as x or y is
+		bool is_and = node.m_type == ASTNodeBinary::Type::And;
+		RegisterOp decide = is_and ? RegisterOp::JumpIfFalse : RegisterOp::JumpIfTrue;
+
+		std::size_t left = emitJump(decide, operand(node.m_left), node.m_tok);
+		m_next = mark;
+		std::size_t right = emitJump(decide, operand(node.m_right), node.m_tok);
+		m_next = mark;
+		emit(RegisterOp::Move, target, constant(Value::boolean(is_and), node.m_tok), 0, node.m_tok);
+		std::size_t end = emitJump(RegisterOp::Jump, 0, node.m_tok);
+
+		patchJump(left, node.m_tok);
+		patchJump(right, node.m_tok);
+		emit(RegisterOp::Move, target, constant(Value::boolean(!is_and), node.m_tok), 0, node.m_tok);
+		patchJump(end, node.m_tok);
+		return;
+	}
+
+	std::uint16_t left = operand(node.m_left);
+	std::uint16_t right = operand(node.m_right);
+	m_next = mark;
+	emit(static_cast<RegisterOp>(static_cast<int>(RegisterOp::Add) + static_cast<int>(node.m_type)),
+		target, left, right, node.m_tok);
+}
+
+void RegisterCompiler::visit(ASTNodeUnary& node) {
+	if (node.m_type == ASTNodeUnary::Type::Plus) {
+		expression(node.m_branch, m_target);
+		return;
+	}
+
+	std::uint16_t target = m_target;
+	std::uint32_t mark = m_next;
+	std::uint16_t value = operand(node.m_branch);
+	m_next = mark;
+
+	switch (node.m_type) {
+		case ASTNodeUnary::Type::Plus: break;
+		case ASTNodeUnary::Type::Negate: emit(RegisterOp::Negate, target, value, 0, node.m_tok); break;
+		case ASTNodeUnary::Type::Not: emit(RegisterOp::Not, target, value, 0, node.m_tok); break;
+		case ASTNodeUnary::Type::BitwiseNot: emit(RegisterOp::BitwiseNot, target, value, 0, node.m_tok); break;
+	}
+}
+
+void RegisterCompiler::visit(ASTNodeVariableInvokation& node) {
+	std::uint16_t target = m_target;
+	std::uint32_t mark = m_next;
+
+	// A call needs the function and its arguments in a row at the top, so
+	// it takes the target only if that is the last temporary
+	std::uint16_t function = target;
+	if (node.m_call && !(target >= m_function->frame_size && target + 1u == m_next)) {
+		function = allocate(node.m_tok);
+	}
+
+	switch (node.m_slot.kind) {
+		case ASTSlot::Kind::Local:
+			if (node.m_slot.depth != 0) {
+				error(node.m_tok, "Variables of an enclosing function cannot be used");
+			}
+			if (function != node.m_slot.index) {
+				emit(RegisterOp::Move, function, static_cast<std::uint16_t>(node.m_slot.index), 0, node.m_tok);
+			}
+			break;
+		case ASTSlot::Kind::Global:
+			if (node.m_slot.index > UINT16_MAX) {
+				error(node.m_tok, "Too many globals");
+			}
+			emit(RegisterOp::GetGlobal, function, static_cast<std::uint16_t>(node.m_slot.index), 0, node.m_tok);
+			break;
+		case ASTSlot::Kind::Unresolved:
+			// Reported by the resolver
+			m_had_error = true;
+			emit(RegisterOp::Move, function, constant(Value::nil(), node.m_tok), 0, node.m_tok);
+			break;
+	}
+
+	if (!node.m_call) {
+		return;
+	}
+
+	for (ASTNode* arg : node.m_args) {
+		expression(arg, allocate(node.m_tok));
+	}
+	emit(RegisterOp::Call, function, static_cast<std::uint16_t>(node.m_args.size()), 0, node.m_tok);
+	if (function != target) {
+		emit(RegisterOp::Move, target, function, 0, node.m_tok);
+	}
+	m_next = mark;
+}
+
+void RegisterCompiler::visit(ASTNodeVariableDeclaration& node) {
+	if (node.m_slot.kind != ASTSlot::Kind::Global) {
+		expression(node.m_assign, static_cast<std::uint16_t>(node.m_slot.index));
+		return;
+	}
+
+	if (node.m_slot.index > UINT16_MAX) {
+		error(node.m_tok, "Too many globals");
+	}
+	std::uint32_t mark = m_next;
+	std::uint16_t value = operand(node.m_assign);
+	m_next = mark;
+	emit(RegisterOp::SetGlobal, static_cast<std::uint16_t>(node.m_slot.index), value, 0, node.m_tok);
+}
+
+void RegisterCompiler::visit(ASTNodeStatementSet& node) {
+	for (ASTNode* statement : node.m_statements) {
+		this->statement(statement);
+	}
+}
+
+void RegisterCompiler::visit(ASTNodeConditional& node) {
+	std::vector<std::size_t> ends;
+
+	for (std::size_t i = 0; i < node.m_conditions.size(); i++) {
+		auto& condition = node.m_conditions[i];
+		std::uint32_t mark = m_next;
+		std::size_t next = emitJump(RegisterOp::JumpIfFalse, operand(condition.first), node.m_tok);
+		m_next = mark;
+		statement(condition.second);
+
+		// The last branch without an else falls through to the end
+		if (i + 1 < node.m_conditions.size() || node.m_else_statement) {
+			ends.push_back(emitJump(RegisterOp::Jump, 0, node.m_tok));
+		}
+		patchJump(next, node.m_tok);
+	}
+
+	statement(node.m_else_statement);
+	for (std::size_t end : ends) {
+		patchJump(end, node.m_tok);
+	}
+}
+
+void RegisterCompiler::visit(ASTNodeFunctionDefinition& node) {
+	m_function->name = node.m_identifier;
+	m_function->arity = static_cast<std::uint32_t>(node.m_args.size());
+	m_function->frame_size = node.m_frame_size;
+	m_function->register_count = node.m_frame_size;
+	m_next = node.m_frame_size;
+	if (m_next > MAX_REGISTERS) {
+		error(node.m_tok, "Too many variables in one function");
+	}
+
+	if (!node.m_contents) {
+		error(node.m_tok, "Function body was not parsed");
+	}
+	statement(node.m_contents);
+
+	emit(RegisterOp::Return, constant(Value::nil(), node.m_tok), 0, 0, node.m_tok);
+}
+
+void RegisterCompiler::visit(ASTNodeFunctionReturn& node) {
+	std::uint32_t mark = m_next;
+	std::uint16_t value = node.m_expr ? operand(node.m_expr) : constant(Value::nil(), node.m_tok);
+	m_next = mark;
+	emit(RegisterOp::Return, value, 0, 0, node.m_tok);
+}
+
+} // namespace Nitro
@@ -0,0 +1,125 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+
+#include "../global/defs.hpp"
+#include "../AST/ASTNode.hpp"
+#include "../AST/ASTVisitor.hpp"
+#include "RegisterBytecode.hpp"
+
+namespace Nitro {
+
+class ScopeResolver;
+
+/**
+* Lowers a tree to instructions for the RegisterVM, from the same resolved
+* tree as the BytecodeCompiler.
+*
+* Locals live in the registers of their slots, so reading one costs no
+* instruction, and a declaration computes its value straight into its
+* register. Every other subexpression gets a temporary register above the
+* locals, given back as soon as the expression using it is done. A call
+* puts the function and its arguments in consecutive registers, which
+* become the start of the callee's frame.
+*/
+class RegisterCompiler : public ASTVisitor {
+public:
+	NITRO_DISABLE_COPY_MOVE(RegisterCompiler)
+
+	RegisterCompiler() = default;
+
+	RegisterProgram compile(ASTNode* program, const ScopeResolver& resolver);
+
+	/**
+	* Where errors are written, std::cerr by default. out must outlive the
+	* compiler.
+	*/
+	void setDiagnostics(std::ostream& out) { m_diagnostics = &out; }
+
+	bool hadError() const { return m_had_error; }
+
+	// Expressions compile into the target register
+	void visit(ASTNodeConstant<std::int64_t>& node) override;
+
+	void visit(ASTNodeConstant<double>& node) override;
+
+	void visit(ASTNodeConstant<bool>& node) override;
+
+	void visit(ASTNodeConstant<std::string_view>& node) override;
+
+	void visit(ASTNodeConstant<char>& node) override;
+
+	void visit(ASTNodeNil& node) override;
+
+	void visit(ASTNodeBinary& node) override;
+
+	void visit(ASTNodeUnary& node) override;
+
+	void visit(ASTNodeVariableInvokation& node) override;
+
+	// Statements
+	void visit(ASTNodeVariableDeclaration& node) override;
+
+	void visit(ASTNodeStatementSet& node) override;
+
+	void visit(ASTNodeConditional& node) override;
+
+	void visit(ASTNodeFunctionDefinition& node) override;
+
+	void visit(ASTNodeFunctionReturn& node) override;
+
+private:
+	void statement(ASTNode* node);
+
+	/**
+	* Compiles an expression, nil if it is missing, and returns the RK
+	* operand holding its value: a constant, the register of a local, or a
+	* new temporary.
+	*/
+	std::uint16_t operand(ASTNode* node);
+
+	/**
+	* Compiles an expression, nil if it is missing, into register target.
+	*/
+	void expression(ASTNode* node, std::uint16_t target);
+
+	/**
+	* The RK operand of a new constant.
+	*/
+	std::uint16_t constant(Value value, const Token& at);
+
+	/**
+	* A new temporary register, above those in use.
+	*/
+	std::uint16_t allocate(const Token& at);
+
+	void emit(RegisterOp op, std::uint16_t a, std::uint16_t b, std::uint16_t c, const Token& at);
+
+	/**
+	* Emits a jump to be patched, returns its index.
+	*/
+	std::size_t emitJump(RegisterOp op, std::uint16_t condition, const Token& at);
+
+	/**
+	* Makes the jump at index land on the next instruction.
+	*/
+	void patchJump(std::size_t index, const Token& at);
+
+	void error(const Token& at, const char* msg);
+
+	RegisterProgram* m_program = nullptr;
+	RegisterFunction* m_function = nullptr;
+
+	// Where the expression being visited goes
+	std::uint16_t m_target = 0;
+
+	// The first free temporary
+	std::uint32_t m_next = 0;
+
+	std::ostream* m_diagnostics = &std::cerr;
+	bool m_had_error = false;
+};
+
+} // namespace Nitro
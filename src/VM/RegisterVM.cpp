@@ -0,0 +1,235 @@
+#include "RegisterVM.hpp"
+
+#include <algorithm>
+#include <string>
+
+#include "Natives.hpp"
+#include "Operators.hpp"
+
+namespace Nitro {
+
+RegisterVM::RegisterVM(const RegisterProgram& program) : m_program(program), m_registers(REGISTER_COUNT) {
+	m_frames.reserve(MAX_FRAMES);
+}
+
+bool RegisterVM::runtimeError(const RegisterFunction& function, const Code* pc, std::string_view msg) {
+#if defined(NITRO_DISPATCH_PREDECODED)
+	const Code* code = m_decoded[static_cast<std::size_t>(&function - m_program.functions.data())].data();
+#else
+	const Code* code = function.code.data();
+#endif
+	const SourceMap::Position& at = function.positions.at(static_cast<std::size_t>(pc - 1 - code));
+	*m_diagnostics << "Runtime error: " << at.line << ":" << at.col << ": " << msg << "\n";
+	return false;
+}
+
+#if defined(NITRO_DISPATCH_PREDECODED)
+void RegisterVM::decode(const void* const* handlers) {
+	m_decoded.clear();
+	m_decoded.reserve(m_program.functions.size());
+
+	for (const RegisterFunction& function : m_program.functions) {
+		std::vector<Code>& decoded = m_decoded.emplace_back();
+		decoded.reserve(function.code.size());
+		for (const RegisterInstruction& in : function.code) {
+			decoded.push_back(Code{ handlers[static_cast<std::size_t>(in.op)], in.a, in.b, in.c });
+		}
+	}
+}
+#endif
+
+// Taking the address of a label is an extension
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wpedantic"
+
+bool RegisterVM::run() {
+#if !defined(NITRO_DISPATCH_SWITCH)
+	// In the order of RegisterOp
+	static const void* const handlers[] = {
+		&&op_Move, &&op_GetGlobal, &&op_SetGlobal,
+		&&op_Add, &&op_Sub, &&op_Mult, &&op_Div, &&op_Pow,
+		&&op_Greater, &&op_GreaterEqual, &&op_RShift, &&op_Less, &&op_LessEqual, &&op_LShift,
+		&&op_Equal, &&op_NotEqual, &&op_BitwiseAnd, &&op_BitwiseOr, &&op_BitwiseXor,
+		&&op_Negate, &&op_Not, &&op_BitwiseNot,
+		&&op_Jump, &&op_JumpIfFalse, &&op_JumpIfTrue,
+		&&op_Call, &&op_Return
+	};
+	static_assert(sizeof(handlers) / sizeof(handlers[0]) == static_cast<std::size_t>(RegisterOp::Return) + 1,
+		"Every opcode needs a handler");
+#endif
+
+#if defined(NITRO_DISPATCH_PREDECODED)
+	if (m_decoded.empty()) {
+		decode(handlers);
+	}
+	#define CODE(function) (m_decoded[static_cast<std::size_t>((function) - m_program.functions.data())].data())
+	#define NEXT() do { NITRO_COUNT_DISPATCH(m_dispatches); in = *pc++; goto *in.handler; } while (0)
+#else
+	#define CODE(function) ((function)->code.data())
+	#if defined(NITRO_DISPATCH_SWITCH)
+		#define NEXT() break
+	#else
+		#define NEXT() do { NITRO_COUNT_DISPATCH(m_dispatches); in = *pc++; goto *handlers[static_cast<std::size_t>(in.op)]; } while (0)
+	#endif
+#endif
+
+#if defined(NITRO_DISPATCH_SWITCH)
+	#define CASE(op) case RegisterOp::op
+#else
+	#define CASE(op) op_##op
+#endif
+
+	m_globals = m_program.globals;
+	m_frames.clear();
+#if defined(NITRO_COUNT_DISPATCHES)
+	m_dispatches = 0;
+#endif
+	m_ints.clear();
+	IntHeap::Scope ints(m_ints);
+
+	const RegisterFunction* function = &m_program.functions[0];
+	if (function->register_count > REGISTER_COUNT) {
+		return runtimeError(*function, CODE(function) + 1, "Stack overflow");
+	}
+
+	Value* const registers_end = m_registers.data() + m_registers.size();
+	Value* base = m_registers.data();
+	std::fill(base, base + function->frame_size, Value());
+	const Code* pc = CODE(function);
+	const Value* constants = function->constants.data();
+	Code in;
+
+#define RK(x) ((x) & RegisterInstruction::CONSTANT ? constants[(x) & ~RegisterInstruction::CONSTANT] : base[x])
+#define BINARY(op) { \
+		const char* error = Operators::op(RK(in.b), RK(in.c), base[in.a]); \
+		if (error) { \
+			return runtimeError(*function, pc, error); \
+		} \
+		NEXT(); \
+	}
+#define UNARY(op) { \
+		const char* error = Operators::op(RK(in.b), base[in.a]); \
+		if (error) { \
+			return runtimeError(*function, pc, error); \
+		} \
+		NEXT(); \
+	}
+
+#if defined(NITRO_DISPATCH_SWITCH)
+	for (;;) {
+		NITRO_COUNT_DISPATCH(m_dispatches);
+		in = *pc++;
+
+		switch (in.op) {
+#else
+	NEXT();
+	{
+		{
+#endif
+			CASE(Move): base[in.a] = RK(in.b); NEXT();
+			CASE(GetGlobal): base[in.a] = m_globals[in.b]; NEXT();
+			CASE(SetGlobal): m_globals[in.a] = RK(in.b); NEXT();
+
+			CASE(Add): BINARY(add)
+			CASE(Sub): BINARY(sub)
+			CASE(Mult): BINARY(mult)
+			CASE(Div): BINARY(div)
+			CASE(Pow): BINARY(pow)
+			CASE(Greater): BINARY(greater)
+			CASE(GreaterEqual): BINARY(greaterEqual)
+			CASE(RShift): BINARY(rshift)
+			CASE(Less): BINARY(less)
+			CASE(LessEqual): BINARY(lessEqual)
+			CASE(LShift): BINARY(lshift)
+			CASE(Equal): BINARY(equal)
+			CASE(NotEqual): BINARY(notEqual)
+			CASE(BitwiseAnd): BINARY(bitwiseAnd)
+			CASE(BitwiseOr): BINARY(bitwiseOr)
+			CASE(BitwiseXor): BINARY(bitwiseXor)
+
+			CASE(Negate): UNARY(negate)
+			CASE(Not): UNARY(logicalNot)
+			CASE(BitwiseNot): UNARY(bitwiseNot)
+
+			CASE(Jump): pc += in.b; NEXT();
+			CASE(JumpIfFalse):
+				if (!RK(in.a).truthy()) {
+					pc += in.b;
+				}
+				NEXT();
+			CASE(JumpIfTrue):
+				if (RK(in.a).truthy()) {
+					pc += in.b;
+				}
+				NEXT();
+
+			CASE(Call): {
+				Value* callee = base + in.a;
+				Value* args = callee + 1;
+				std::uint16_t count = in.b;
+
+				if (callee->isNative()) {
+					*callee = natives()[callee->asIndex()].function(*m_output, args, count);
+					NEXT();
+				}
+
+				if (!callee->isFunction()) {
+					return runtimeError(*function, pc, "Only functions can be called");
+				}
+
+				const RegisterFunction* target = &m_program.functions[callee->asIndex()];
+				if (count != target->arity) {
+					return runtimeError(*function, pc, "Expected " + std::to_string(target->arity) +
+						" arguments but got " + std::to_string(count));
+				}
+				if (m_frames.size() == MAX_FRAMES ||
+					static_cast<std::size_t>(registers_end - args) < target->register_count) {
+					return runtimeError(*function, pc, "Stack overflow");
+				}
+
+				m_frames.push_back(CallFrame{ function, pc, base });
+				function = target;
+				base = args;
+				std::fill(args + count, base + function->frame_size, Value());
+				if (m_ints.wantsCollection()) {
+					// Every live Value is in a register of the frames or in
+					// a global here
+					m_ints.collect({ { m_registers.data(), base + function->register_count },
+						{ m_globals.data(), m_globals.data() + m_globals.size() } });
+				}
+				pc = CODE(function);
+				constants = function->constants.data();
+				NEXT();
+			}
+
+			CASE(Return): {
+				Value result = RK(in.a);
+				if (m_frames.empty()) {
+					// A return at the top level ends the script
+					return true;
+				}
+
+				base[-1] = result;
+
+				const CallFrame& frame = m_frames.back();
+				function = frame.function;
+				pc = frame.pc;
+				base = frame.base;
+				constants = function->constants.data();
+				m_frames.pop_back();
+				NEXT();
+			}
+		}
+	}
+
+#undef UNARY
+#undef BINARY
+#undef RK
+#undef CASE
+#undef NEXT
+#undef CODE
+}
+
+#pragma GCC diagnostic pop
+
+} // namespace Nitro
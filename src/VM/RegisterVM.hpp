@@ -0,0 +1,111 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <string_view>
+#include <vector>
+
+#include "../global/defs.hpp"
+#include "Dispatch.hpp"
+#include "RegisterBytecode.hpp"
+#include "Value.hpp"
+
+namespace Nitro {
+
+/**
+* Runs a RegisterProgram, the register machine counterpart of the VM. Each
+* frame is a window of registers: a call's function is the register just
+* below it, and the callee's result replaces it.
+*/
+class RegisterVM {
+public:
+	NITRO_DISABLE_COPY_MOVE(RegisterVM)
+
+	/**
+	* Registers, for every frame together.
+	*/
+	static constexpr std::size_t REGISTER_COUNT = 1 << 20;
+
+	static constexpr std::size_t MAX_FRAMES = 1 << 16;
+
+	/**
+	* The program must outlive the VM.
+	*/
+	explicit RegisterVM(const RegisterProgram& program);
+
+	/**
+	* Where the script's output goes, std::cout by default.
+	*/
+	void setOutput(std::ostream& out) { m_output = &out; }
+
+	/**
+	* Where runtime errors are written, std::cerr by default.
+	*/
+	void setDiagnostics(std::ostream& out) { m_diagnostics = &out; }
+
+	/**
+	* Runs the script from the start, with the globals reset. Returns false
+	* after a runtime error.
+	*/
+	bool run();
+
+#if defined(NITRO_COUNT_DISPATCHES)
+	/**
+	* Instructions executed by the last run.
+	*/
+	std::uint64_t dispatches() const { return m_dispatches; }
+#endif
+
+private:
+#if defined(NITRO_DISPATCH_PREDECODED)
+	/**
+	* An instruction with the address of its handler in run() as opcode.
+	*/
+	struct Code {
+		const void* handler;
+		std::uint16_t a;
+		std::uint16_t b;
+		std::uint16_t c;
+	};
+
+	/**
+	* Decodes every function of the program, with handlers indexed by
+	* opcode.
+	*/
+	void decode(const void* const* handlers);
+#else
+	using Code = RegisterInstruction;
+#endif
+
+	struct CallFrame {
+		const RegisterFunction* function;
+		const Code* pc;
+		Value* base;
+	};
+
+	/**
+	* Reports msg at the instruction before pc.
+	*/
+	bool runtimeError(const RegisterFunction& function, const Code* pc, std::string_view msg);
+
+	const RegisterProgram& m_program;
+	std::vector<Value> m_registers;
+	std::vector<CallFrame> m_frames;
+	std::vector<Value> m_globals;
+#if defined(NITRO_COUNT_DISPATCHES)
+	std::uint64_t m_dispatches = 0;
+#endif
+
+	// Integers too wide for a Value made by the last run
+	IntHeap m_ints;
+
+#if defined(NITRO_DISPATCH_PREDECODED)
+	std::vector<std::vector<Code>> m_decoded;
+#endif
+
+	std::ostream* m_output = &std::cout;
+	std::ostream* m_diagnostics = &std::cerr;
+};
+
+} // namespace Nitro
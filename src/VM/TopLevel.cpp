@@ -0,0 +1,57 @@
+#include "TopLevel.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+
+#include "../AST/ASTNodeStatementSet.hpp"
+#include "../AST/ASTNodeFunctionDefinition.hpp"
+#include "../Semantic/ScopeResolver.hpp"
+#include "Natives.hpp"
+
+namespace Nitro {
+
+TopLevel TopLevel::of(ASTNode* program, const ScopeResolver& resolver) {
+	TopLevel result;
+
+	const auto& names = resolver.globals();
+	result.globals.assign(names.size(), Value::nil());
+	for (std::size_t i = 0; i < natives().size(); i++) {
+		auto found = std::find(names.begin(), names.end(), natives()[i].name);
+		if (found != names.end()) {
+			result.globals[static_cast<std::size_t>(found - names.begin())] = Value::native(static_cast<std::uint32_t>(i));
+		}
+	}
+
+	// Parser::parse() groups the statements between functions into
+	// statement sets, which are not blocks
+	auto add = [&](ASTNode* node) {
+		if (node && node->m_kind == ASTKind::FunctionDefinition) {
+			result.functions.push_back(static_cast<ASTNodeFunctionDefinition*>(node));
+		} else {
+			result.statements.push_back(node);
+		}
+	};
+	if (program && program->m_kind == ASTKind::StatementSet) {
+		for (ASTNode* item : static_cast<ASTNodeStatementSet*>(program)->m_statements) {
+			if (item && item->m_kind == ASTKind::StatementSet) {
+				for (ASTNode* statement : static_cast<ASTNodeStatementSet*>(item)->m_statements) {
+					add(statement);
+				}
+			} else {
+				add(item);
+			}
+		}
+	} else {
+		add(program);
+	}
+
+	// Functions are in the globals before anything runs
+	for (std::size_t i = 0; i < result.functions.size(); i++) {
+		result.globals[result.functions[i]->m_slot.index] = Value::function(static_cast<std::uint32_t>(i + 1));
+	}
+
+	return result;
+}
+
+} // namespace Nitro
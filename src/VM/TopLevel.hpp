@@ -0,0 +1,32 @@
+#pragma once
+
+#include <vector>
+
+#include "../AST/ASTNode.hpp"
+#include "Value.hpp"
+
+namespace Nitro {
+
+class ASTNodeFunctionDefinition;
+class ScopeResolver;
+
+/**
+* The top level of a tree resolved by a ScopeResolver, as the compilers
+* lower it: the functions, which become functions 1 and on of the program,
+* and the statements outside of them in order, which become function 0.
+*/
+struct TopLevel {
+	std::vector<ASTNode*> statements;
+	std::vector<ASTNodeFunctionDefinition*> functions;
+
+	// Values of the globals before the script runs: the functions and the
+	// natives, nil for the rest
+	std::vector<Value> globals;
+
+	/**
+	* The resolver must have declared the natives() first.
+	*/
+	static TopLevel of(ASTNode* program, const ScopeResolver& resolver);
+};
+
+} // namespace Nitro
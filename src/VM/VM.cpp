@@ -0,0 +1,311 @@
+#include "VM.hpp"
+
+#include <algorithm>
+#include <string>
+#include <utility>
+
+#include "Natives.hpp"
+#include "Operators.hpp"
+
+namespace Nitro {
+
+VM::VM(const Program& program) : m_program(program), m_stack(STACK_SIZE) {
+	m_frames.reserve(MAX_FRAMES);
+}
+
+bool VM::runtimeError(const Function& function, const Code* ip, std::string_view msg) {
+#if defined(NITRO_DISPATCH_PREDECODED)
+	const DecodedFunction& decoded = m_decoded[static_cast<std::size_t>(&function - m_program.functions.data())];
+	std::size_t offset = decoded.offsets[static_cast<std::size_t>(ip - 1 - decoded.code.data())];
+#else
+	std::size_t offset = static_cast<std::size_t>(ip - 1 - function.chunk.code.data());
+#endif
+	const SourceMap::Position& at = function.chunk.positions.at(offset);
+	*m_diagnostics << "Runtime error: " << at.line << ":" << at.col << ": " << msg << "\n";
+	return false;
+}
+
+#if defined(NITRO_DISPATCH_PREDECODED)
+void VM::decode(const void* const* handlers) {
+	m_decoded.clear();
+	m_decoded.reserve(m_program.functions.size());
+
+	for (const Function& function : m_program.functions) {
+		const std::vector<std::uint8_t>& bytes = function.chunk.code;
+		DecodedFunction decoded;
+
+		// Where each byte went, and the jumps to point at their targets
+		// once those are known
+		std::vector<std::uint32_t> moved(bytes.size() + 1);
+		std::vector<std::pair<std::size_t, std::size_t>> jumps;
+
+		auto add = [&](Code code, std::size_t offset) {
+			decoded.code.push_back(code);
+			decoded.offsets.push_back(static_cast<std::uint32_t>(offset));
+		};
+
+		for (std::size_t i = 0; i < bytes.size();) {
+			auto op = static_cast<OpCode>(bytes[i]);
+			moved[i] = static_cast<std::uint32_t>(decoded.code.size());
+			Code handler;
+			handler.handler = handlers[bytes[i]];
+			add(handler, i++);
+
+			Code operand;
+			switch (op) {
+				case OpCode::Constant:
+				case OpCode::GetLocal:
+				case OpCode::SetLocal:
+				case OpCode::GetGlobal:
+				case OpCode::SetGlobal:
+				case OpCode::Jump:
+				case OpCode::JumpIfFalse:
+				case OpCode::JumpIfTrue:
+					operand.operand = static_cast<std::uint32_t>(bytes[i] | (bytes[i + 1] << 8));
+					if (op == OpCode::Jump || op == OpCode::JumpIfFalse || op == OpCode::JumpIfTrue) {
+						jumps.emplace_back(decoded.code.size(), i + 2 + operand.operand);
+					}
+					moved[i] = moved[i + 1] = static_cast<std::uint32_t>(decoded.code.size());
+					add(operand, i);
+					i += 2;
+					break;
+				case OpCode::Call:
+					operand.operand = bytes[i];
+					moved[i] = static_cast<std::uint32_t>(decoded.code.size());
+					add(operand, i);
+					i += 1;
+					break;
+				default:
+					break;
+			}
+		}
+		moved[bytes.size()] = static_cast<std::uint32_t>(decoded.code.size());
+
+		// Jumps are relative to the code after their operand
+		for (const auto& [at, target] : jumps) {
+			decoded.code[at].operand = static_cast<std::uint32_t>(moved[target] - (at + 1));
+		}
+
+		m_decoded.push_back(std::move(decoded));
+	}
+}
+#endif
+
+// Taking the address of a label is an extension
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wpedantic"
+
+bool VM::run() {
+#if !defined(NITRO_DISPATCH_SWITCH)
+	// In the order of OpCode
+	static const void* const handlers[] = {
+		&&op_Constant, &&op_Nil, &&op_True, &&op_False, &&op_Pop,
+		&&op_GetLocal, &&op_SetLocal, &&op_GetGlobal, &&op_SetGlobal,
+		&&op_Add, &&op_Sub, &&op_Mult, &&op_Div, &&op_Pow,
+		&&op_Greater, &&op_GreaterEqual, &&op_RShift, &&op_Less, &&op_LessEqual, &&op_LShift,
+		&&op_Equal, &&op_NotEqual, &&op_BitwiseAnd, &&op_BitwiseOr, &&op_BitwiseXor,
+		&&op_Negate, &&op_Not, &&op_BitwiseNot,
+		&&op_Jump, &&op_JumpIfFalse, &&op_JumpIfTrue,
+		&&op_Call, &&op_Return
+	};
+	static_assert(sizeof(handlers) / sizeof(handlers[0]) == static_cast<std::size_t>(OpCode::Return) + 1,
+		"Every opcode needs a handler");
+#endif
+
+#if defined(NITRO_DISPATCH_PREDECODED)
+	if (m_decoded.empty()) {
+		decode(handlers);
+	}
+	#define CODE(function) (m_decoded[static_cast<std::size_t>((function) - m_program.functions.data())].code.data())
+	#define READ_U8() ((ip++)->operand)
+	#define READ_U16() ((ip++)->operand)
+	#define NEXT() do { NITRO_COUNT_DISPATCH(m_dispatches); goto *(ip++)->handler; } while (0)
+#else
+	#define CODE(function) ((function)->chunk.code.data())
+	#define READ_U8() (*ip++)
+	#define READ_U16() (ip += 2, static_cast<std::uint16_t>(ip[-2] | (ip[-1] << 8)))
+	#if defined(NITRO_DISPATCH_SWITCH)
+		#define NEXT() break
+	#else
+		#define NEXT() do { NITRO_COUNT_DISPATCH(m_dispatches); goto *handlers[*ip++]; } while (0)
+	#endif
+#endif
+
+#if defined(NITRO_DISPATCH_SWITCH)
+	#define CASE(op) case OpCode::op
+#else
+	#define CASE(op) op_##op
+#endif
+
+	m_globals = m_program.globals;
+	m_frames.clear();
+#if defined(NITRO_COUNT_DISPATCHES)
+	m_dispatches = 0;
+#endif
+	m_ints.clear();
+	IntHeap::Scope ints(m_ints);
+
+	const Function* function = &m_program.functions[0];
+	if (function->frame_size + function->max_stack > STACK_SIZE) {
+		return runtimeError(*function, CODE(function) + 1, "Stack overflow");
+	}
+
+	Value* const stack_end = m_stack.data() + m_stack.size();
+	Value* base = m_stack.data();
+	Value* sp = base + function->frame_size;
+	std::fill(base, sp, Value());
+	const Code* ip = CODE(function);
+	const Value* constants = function->chunk.constants.data();
+
+#define BINARY(op) { \
+		const char* error = Operators::op(sp[-2], sp[-1], sp[-2]); \
+		if (error) { \
+			return runtimeError(*function, ip, error); \
+		} \
+		sp--; \
+		NEXT(); \
+	}
+#define UNARY(op) { \
+		const char* error = Operators::op(sp[-1], sp[-1]); \
+		if (error) { \
+			return runtimeError(*function, ip, error); \
+		} \
+		NEXT(); \
+	}
+
+#if defined(NITRO_DISPATCH_SWITCH)
+	for (;;) {
+		NITRO_COUNT_DISPATCH(m_dispatches);
+
+		switch (static_cast<OpCode>(*ip++)) {
+#else
+	NEXT();
+	{
+		{
+#endif
+			CASE(Constant): *sp++ = constants[READ_U16()]; NEXT();
+			CASE(Nil): *sp++ = Value::nil(); NEXT();
+			CASE(True): *sp++ = Value::boolean(true); NEXT();
+			CASE(False): *sp++ = Value::boolean(false); NEXT();
+			CASE(Pop): sp--; NEXT();
+
+			CASE(GetLocal): *sp++ = base[READ_U16()]; NEXT();
+			CASE(SetLocal): base[READ_U16()] = *--sp; NEXT();
+			CASE(GetGlobal): *sp++ = m_globals[READ_U16()]; NEXT();
+			CASE(SetGlobal): m_globals[READ_U16()] = *--sp; NEXT();
+
+			CASE(Add): BINARY(add)
+			CASE(Sub): BINARY(sub)
+			CASE(Mult): BINARY(mult)
+			CASE(Div): BINARY(div)
+			CASE(Pow): BINARY(pow)
+			CASE(Greater): BINARY(greater)
+			CASE(GreaterEqual): BINARY(greaterEqual)
+			CASE(RShift): BINARY(rshift)
+			CASE(Less): BINARY(less)
+			CASE(LessEqual): BINARY(lessEqual)
+			CASE(LShift): BINARY(lshift)
+			CASE(Equal): BINARY(equal)
+			CASE(NotEqual): BINARY(notEqual)
+			CASE(BitwiseAnd): BINARY(bitwiseAnd)
+			CASE(BitwiseOr): BINARY(bitwiseOr)
+			CASE(BitwiseXor): BINARY(bitwiseXor)
+
+			CASE(Negate): UNARY(negate)
+			CASE(Not): UNARY(logicalNot)
+			CASE(BitwiseNot): UNARY(bitwiseNot)
+
+			CASE(Jump): {
+				std::uint32_t offset = READ_U16();
+				ip += offset;
+				NEXT();
+			}
+			CASE(JumpIfFalse): {
+				std::uint32_t offset = READ_U16();
+				if (!(--sp)->truthy()) {
+					ip += offset;
+				}
+				NEXT();
+			}
+			CASE(JumpIfTrue): {
+				std::uint32_t offset = READ_U16();
+				if ((--sp)->truthy()) {
+					ip += offset;
+				}
+				NEXT();
+			}
+
+			CASE(Call): {
+				std::uint32_t count = READ_U8();
+				Value* args = sp - count;
+				const Value& callee = args[-1];
+
+				if (callee.isNative()) {
+					Value result = natives()[callee.asIndex()].function(*m_output, args, count);
+					sp = args - 1;
+					*sp++ = result;
+					NEXT();
+				}
+
+				if (!callee.isFunction()) {
+					return runtimeError(*function, ip, "Only functions can be called");
+				}
+
+				const Function* target = &m_program.functions[callee.asIndex()];
+				if (count != target->arity) {
+					return runtimeError(*function, ip, "Expected " + std::to_string(target->arity) +
+						" arguments but got " + std::to_string(count));
+				}
+				if (m_frames.size() == MAX_FRAMES ||
+					static_cast<std::size_t>(stack_end - args) < target->frame_size + target->max_stack) {
+					return runtimeError(*function, ip, "Stack overflow");
+				}
+
+				m_frames.push_back(CallFrame{ function, ip, base });
+				function = target;
+				base = args;
+				sp = base + function->frame_size;
+				std::fill(args + count, sp, Value());
+				if (m_ints.wantsCollection()) {
+					// Every live Value is on the stack or in a global here
+					m_ints.collect({ { m_stack.data(), sp }, { m_globals.data(), m_globals.data() + m_globals.size() } });
+				}
+				ip = CODE(function);
+				constants = function->chunk.constants.data();
+				NEXT();
+			}
+
+			CASE(Return): {
+				Value result = *--sp;
+				if (m_frames.empty()) {
+					// A return at the top level ends the script
+					return true;
+				}
+
+				// The function and its arguments give way to the result
+				sp = base - 1;
+				*sp++ = result;
+
+				const CallFrame& frame = m_frames.back();
+				function = frame.function;
+				ip = frame.ip;
+				base = frame.base;
+				constants = function->chunk.constants.data();
+				m_frames.pop_back();
+				NEXT();
+			}
+		}
+	}
+
+#undef UNARY
+#undef BINARY
+#undef CASE
+#undef NEXT
+#undef READ_U16
+#undef READ_U8
+#undef CODE
+}
+
+#pragma GCC diagnostic pop
+
+} // namespace Nitro
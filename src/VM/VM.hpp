@@ -0,0 +1,113 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <string_view>
+#include <vector>
+
+#include "../global/defs.hpp"
+#include "Bytecode.hpp"
+#include "Dispatch.hpp"
+#include "Value.hpp"
+
+namespace Nitro {
+
+/**
+* Runs a Program on a stack of Values. A call's arguments are the first
+* slots of its frame, followed by its locals and then its temporaries.
+*/
+class VM {
+public:
+	NITRO_DISABLE_COPY_MOVE(VM)
+
+	/**
+	* Values on the stack, for every frame together.
+	*/
+	static constexpr std::size_t STACK_SIZE = 1 << 20;
+
+	static constexpr std::size_t MAX_FRAMES = 1 << 16;
+
+	/**
+	* The program must outlive the VM.
+	*/
+	explicit VM(const Program& program);
+
+	/**
+	* Where the script's output goes, std::cout by default.
+	*/
+	void setOutput(std::ostream& out) { m_output = &out; }
+
+	/**
+	* Where runtime errors are written, std::cerr by default.
+	*/
+	void setDiagnostics(std::ostream& out) { m_diagnostics = &out; }
+
+	/**
+	* Runs the script from the start, with the globals reset. Returns false
+	* after a runtime error.
+	*/
+	bool run();
+
+#if defined(NITRO_COUNT_DISPATCHES)
+	/**
+	* Instructions executed by the last run.
+	*/
+	std::uint64_t dispatches() const { return m_dispatches; }
+#endif
+
+private:
+#if defined(NITRO_DISPATCH_PREDECODED)
+	/**
+	* An opcode, as the address of its handler in run(), or an operand.
+	*/
+	union Code {
+		const void* handler;
+		std::uint32_t operand;
+	};
+
+	struct DecodedFunction {
+		std::vector<Code> code;
+		std::vector<std::uint32_t> offsets; // Where each one is in the chunk
+	};
+
+	/**
+	* Decodes every function of the program, with handlers indexed by
+	* opcode. Jumps are rewritten to count codes instead of bytes.
+	*/
+	void decode(const void* const* handlers);
+#else
+	using Code = std::uint8_t;
+#endif
+
+	struct CallFrame {
+		const Function* function;
+		const Code* ip;
+		Value* base;
+	};
+
+	/**
+	* Reports msg at the instruction holding the code before ip.
+	*/
+	bool runtimeError(const Function& function, const Code* ip, std::string_view msg);
+
+	const Program& m_program;
+	std::vector<Value> m_stack;
+	std::vector<CallFrame> m_frames;
+	std::vector<Value> m_globals;
+#if defined(NITRO_COUNT_DISPATCHES)
+	std::uint64_t m_dispatches = 0;
+#endif
+
+	// Integers too wide for a Value made by the last run
+	IntHeap m_ints;
+
+#if defined(NITRO_DISPATCH_PREDECODED)
+	std::vector<DecodedFunction> m_decoded;
+#endif
+
+	std::ostream* m_output = &std::cout;
+	std::ostream* m_diagnostics = &std::cerr;
+};
+
+} // namespace Nitro
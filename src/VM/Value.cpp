@@ -0,0 +1,112 @@
+#include "Value.hpp"
+
+#include <algorithm>
+#include <charconv>
+#include <cmath>
+#include <cstring>
+#include <functional>
+#include <mutex>
+
+namespace Nitro {
+
+namespace {
+
+thread_local IntHeap* t_current_heap = nullptr;
+
+} // namespace
+
+void IntHeap::clear() {
+	m_boxes.clear();
+	m_free.clear();
+	m_collect_at = MIN_COLLECTION;
+}
+
+void IntHeap::collect(std::initializer_list<Roots> roots) {
+	std::vector<const std::int64_t*> live;
+	for (const Roots& range : roots) {
+		for (const Value* value = range.begin; value != range.end; value++) {
+			if (value->isBoxedInt()) {
+				live.push_back(value->box());
+			}
+		}
+	}
+	std::less<const std::int64_t*> before;
+	std::sort(live.begin(), live.end(), before);
+
+	// Boxes freed before are not live either, so the list is made anew
+	m_free.clear();
+	for (std::size_t i = 0; i < m_boxes.size(); i++) {
+		if (!std::binary_search(live.begin(), live.end(), &m_boxes[i], before)) {
+			m_free.push_back(i);
+		}
+	}
+	m_collect_at = std::max(MIN_COLLECTION, 2 * size());
+}
+
+IntHeap::Scope::Scope(IntHeap& heap) : m_outer(t_current_heap) {
+	t_current_heap = &heap;
+}
+
+IntHeap::Scope::~Scope() {
+	t_current_heap = m_outer;
+}
+
+const std::int64_t* IntHeap::boxInCurrent(std::int64_t value) {
+	if (t_current_heap) {
+		return t_current_heap->box(value);
+	}
+
+	// Shared by every thread outside of a Scope
+	static std::mutex mutex;
+	static IntHeap process_heap;
+	std::lock_guard<std::mutex> lock(mutex);
+	return process_heap.box(value);
+}
+
+Value Value::boxed(std::int64_t value) {
+	return Value(tagged(Tag::BoxedInt, reinterpret_cast<std::uintptr_t>(IntHeap::boxInCurrent(value))));
+}
+
+bool Value::equals(const Value& other) const {
+	if (isNumber() && other.isNumber()) {
+		if (isInt() && other.isInt()) {
+			return asInt() == other.asInt();
+		}
+		return toFloat() == other.toFloat();
+	}
+
+	// Other values have a single encoding, but for strings with the same
+	// text in different places
+	if (type() == Type::String && other.type() == Type::String) {
+		return asString() == other.asString();
+	}
+	return m_bits == other.m_bits;
+}
+
+std::ostream& operator<<(std::ostream& os, const Value& value) {
+	switch (value.type()) {
+		case Value::Type::Nil: return os << "nil";
+		case Value::Type::Bool: return os << (value.asBool() ? "true" : "false");
+		case Value::Type::Int: return os << value.asInt();
+		case Value::Type::Float: {
+			// The shortest text that reads back as the same double, with a
+			// .0 to tell whole floats from integers
+			double number = value.asFloat();
+			char buffer[32];
+			char* end = std::to_chars(buffer, buffer + sizeof(buffer), number).ptr;
+			os.write(buffer, end - buffer);
+			if (std::isfinite(number) && !std::memchr(buffer, '.', static_cast<std::size_t>(end - buffer)) &&
+				!std::memchr(buffer, 'e', static_cast<std::size_t>(end - buffer))) {
+				os << ".0";
+			}
+			return os;
+		}
+		case Value::Type::Char: return os << value.asChar();
+		case Value::Type::String: return os << value.asString();
+		case Value::Type::Function: return os << "<function " << value.asIndex() << ">";
+		case Value::Type::Native: return os << "<native " << value.asIndex() << ">";
+	}
+	return os;
+}
+
+} // namespace Nitro
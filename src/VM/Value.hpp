@@ -0,0 +1,317 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <deque>
+#include <initializer_list>
+#include <ostream>
+#include <string_view>
+#include <vector>
+
+#include "../global/defs.hpp"
+
+namespace Nitro {
+
+class Value;
+
+/**
+* Holds the integers too wide to fit in a Value. Boxes live until the heap
+* is cleared or destroyed, or until collect() finds no Value holding them
+* and frees them for reuse.
+*
+* Values box into the heap of the innermost Scope of their thread. A
+* Program owns the boxes of its constants, and a VM owns those made by a
+* run until the next one, collecting them as it calls functions. Integers
+* boxed outside of any Scope go to a heap that lives as long as the
+* process.
+*/
+class IntHeap {
+public:
+	NITRO_DISABLE_COPY(IntHeap)
+	NITRO_DEFAULT_MOVE(IntHeap)
+
+	IntHeap() = default;
+
+	/**
+	* Boxes in use before collect() is first worth running.
+	*/
+	static constexpr std::size_t MIN_COLLECTION = 64 * 1024;
+
+	/**
+	* A box holding value, one freed by collect() if there is any.
+	*/
+	const std::int64_t* box(std::int64_t value) {
+		if (m_free.empty()) {
+			return &m_boxes.emplace_back(value);
+		}
+		std::int64_t& box = m_boxes[m_free.back()];
+		m_free.pop_back();
+		box = value;
+		return &box;
+	}
+
+	void clear();
+
+	/**
+	* Boxes in use.
+	*/
+	std::size_t size() const { return m_boxes.size() - m_free.size(); }
+
+	/**
+	* Whether the boxes in use grew enough since the last collect() for
+	* another to be worth it.
+	*/
+	bool wantsCollection() const { return size() >= m_collect_at; }
+
+	/**
+	* Values a run may still use, from begin to end.
+	*/
+	struct Roots {
+		const Value* begin;
+		const Value* end;
+	};
+
+	/**
+	* Frees the boxes of this heap that no Value of roots holds. Every Value
+	* that may still be used must be in roots, others are left dangling.
+	*/
+	void collect(std::initializer_list<Roots> roots);
+
+	/**
+	* Makes a heap the one Values of this thread box into, while it lives.
+	*/
+	class Scope {
+	public:
+		NITRO_DISABLE_COPY_MOVE(Scope)
+
+		explicit Scope(IntHeap& heap);
+		~Scope();
+
+	private:
+		IntHeap* m_outer;
+	};
+
+private:
+	friend class Value;
+
+	/**
+	* Boxes value in the heap of the current Scope.
+	*/
+	static const std::int64_t* boxInCurrent(std::int64_t value);
+
+	// A deque, as values point to the boxes
+	std::deque<std::int64_t> m_boxes;
+	std::vector<std::size_t> m_free;
+	std::size_t m_collect_at = MIN_COLLECTION;
+};
+
+/**
+* A value of a running script: one of the types ASTNodeConstant models, or
+* a function. Strings are views of the source held by the Program, scripts
+* cannot build new ones yet.
+*
+* Values are NaN-boxed in 64 bits. A Float is its own bits, with every NaN
+* made the same positive quiet NaN. Everything else is a negative quiet NaN
+* no arithmetic produces: the 13 high bits set, a tag in the next 3 and a
+* 48 bit payload.
+*
+*   Float      any double, NaN canonical
+*   Nil        0xfff8 0000 0000 0000
+*   Bool       0xfff9 0000 0000 000b
+*   Int        0xfffa iiii iiii iiii  the low 48 bits of an int from
+*                                     -2^47 to 2^47 - 1
+*   Int        0xfffb pppp pppp pppp  a pointer to the int in an IntHeap,
+*                                     for the rest of the int64 range
+*   Char       0xfffc 0000 0000 00cc
+*   String     0xfffd pppp pppp pppp  a pointer to the text
+*   Function   0xfffe 0000 iiii iiii  an index
+*   Native     0xffff 0000 iiii iiii  an index
+*
+* An int in the small range is always stored inline, so small Ints of the
+* same int are equal bits. Boxed Ints of the same int may be in different
+* boxes, and compare by value. Pointers must fit in 48 bits, as they do on
+* x86-64 and AArch64 without tagged pointers.
+*/
+class Value {
+public:
+	enum class Type : std::uint8_t {
+		Nil,
+		Bool,
+		Int,
+		Float,
+		Char,
+		String,
+		Function, // Index into Program::functions
+		Native    // Index into natives()
+	};
+
+	Value() : m_bits(NIL_BITS) {}
+
+	static Value nil() { return Value(); }
+
+	static Value boolean(bool value) { return Value(FALSE_BITS | static_cast<std::uint64_t>(value)); }
+
+	/**
+	* Boxes the value in the current IntHeap if it does not fit in 48 bits.
+	*/
+	static Value integer(std::int64_t value) {
+		if (value >= -SMALL_INT_LIMIT && value < SMALL_INT_LIMIT) {
+			return Value(tagged(Tag::Int, static_cast<std::uint64_t>(value) & PAYLOAD));
+		}
+		return boxed(value);
+	}
+
+	static Value floating(double value) {
+		if (value != value) {
+			return Value(CANONICAL_NAN);
+		}
+		std::uint64_t bits;
+		std::memcpy(&bits, &value, sizeof(bits));
+		return Value(bits);
+	}
+
+	static Value character(char value) { return Value(tagged(Tag::Char, static_cast<unsigned char>(value))); }
+
+	/**
+	* text must outlive the value.
+	*/
+	static Value string(const std::string_view* text) {
+		return Value(tagged(Tag::String, reinterpret_cast<std::uintptr_t>(text)));
+	}
+
+	static Value function(std::uint32_t index) { return Value(tagged(Tag::Function, index)); }
+
+	static Value native(std::uint32_t index) { return Value(tagged(Tag::Native, index)); }
+
+	Type type() const {
+		if (isFloat()) {
+			return Type::Float;
+		}
+		switch (static_cast<Tag>((m_bits >> 48) & 7)) {
+			case Tag::Nil: return Type::Nil;
+			case Tag::Bool: return Type::Bool;
+			case Tag::Int:
+			case Tag::BoxedInt: return Type::Int;
+			case Tag::Char: return Type::Char;
+			case Tag::String: return Type::String;
+			case Tag::Function: return Type::Function;
+			case Tag::Native: return Type::Native;
+		}
+		return Type::Nil;
+	}
+
+	bool isNil() const { return m_bits == NIL_BITS; }
+	bool isBool() const { return (m_bits >> 48) == tagged(Tag::Bool, 0) >> 48; }
+	bool isInt() const { return (m_bits >> 49) == tagged(Tag::Int, 0) >> 49; } // Int and BoxedInt
+	bool isFloat() const { return m_bits < TAGGED; }
+	bool isNumber() const { return isFloat() || isInt(); }
+	bool isFunction() const { return (m_bits >> 48) == tagged(Tag::Function, 0) >> 48; }
+	bool isNative() const { return (m_bits >> 48) == tagged(Tag::Native, 0) >> 48; }
+
+	/**
+	* An Int that fits in the payload, so needs no IntHeap.
+	*/
+	bool isSmallInt() const { return (m_bits >> 48) == tagged(Tag::Int, 0) >> 48; }
+
+	/**
+	* Whether a and b are both small Ints: their sum or difference cannot
+	* overflow an int64.
+	*/
+	static bool areSmallInts(const Value& a, const Value& b) {
+		return ((a.m_bits >> 48) == tagged(Tag::Int, 0) >> 48) & ((b.m_bits >> 48) == tagged(Tag::Int, 0) >> 48);
+	}
+
+	static bool areFloats(const Value& a, const Value& b) { return (a.m_bits < TAGGED) & (b.m_bits < TAGGED); }
+
+	bool asBool() const { return m_bits & 1; }
+
+	std::int64_t asInt() const {
+		return isSmallInt() ? asSmallInt() : *box();
+	}
+
+	/**
+	* The value of a small Int, from its sign extended payload.
+	*/
+	std::int64_t asSmallInt() const {
+		std::uint64_t payload = m_bits & PAYLOAD;
+		return static_cast<std::int64_t>(payload ^ SIGN) - static_cast<std::int64_t>(SIGN);
+	}
+
+	double asFloat() const {
+		double value;
+		std::memcpy(&value, &m_bits, sizeof(value));
+		return value;
+	}
+
+	char asChar() const { return static_cast<char>(m_bits & 0xff); }
+	std::string_view asString() const { return *reinterpret_cast<const std::string_view*>(static_cast<std::uintptr_t>(m_bits & PAYLOAD)); }
+	std::uint32_t asIndex() const { return static_cast<std::uint32_t>(m_bits); }
+
+	/**
+	* An Int or Float as a double.
+	*/
+	double toFloat() const { return isFloat() ? asFloat() : static_cast<double>(asInt()); }
+
+	/**
+	* Only nil and false are false.
+	*/
+	bool truthy() const { return m_bits != NIL_BITS && m_bits != FALSE_BITS; }
+
+	/**
+	* Numbers are equal by value whatever their type, other values only to
+	* a value of the same type.
+	*/
+	bool equals(const Value& other) const;
+
+	/**
+	* The encoding, see the class comment.
+	*/
+	std::uint64_t bits() const { return m_bits; }
+
+	friend std::ostream& operator<<(std::ostream& os, const Value& value);
+
+private:
+	enum class Tag : std::uint8_t {
+		Nil,
+		Bool,
+		Int,
+		BoxedInt,
+		Char,
+		String,
+		Function,
+		Native
+	};
+
+	static constexpr std::uint64_t TAGGED = 0xfff8000000000000;
+	static constexpr std::uint64_t PAYLOAD = 0x0000ffffffffffff;
+	static constexpr std::uint64_t SIGN = 0x0000800000000000;
+	static constexpr std::uint64_t CANONICAL_NAN = 0x7ff8000000000000;
+	static constexpr std::int64_t SMALL_INT_LIMIT = std::int64_t(1) << 47;
+
+	static constexpr std::uint64_t tagged(Tag tag, std::uint64_t payload) {
+		return TAGGED | static_cast<std::uint64_t>(tag) << 48 | payload;
+	}
+
+	static constexpr std::uint64_t NIL_BITS = TAGGED;
+	static constexpr std::uint64_t FALSE_BITS = TAGGED | std::uint64_t(1) << 48; // Tag::Bool
+
+	friend class IntHeap;
+
+	explicit Value(std::uint64_t bits) : m_bits(bits) {}
+
+	bool isBoxedInt() const { return (m_bits >> 48) == tagged(Tag::BoxedInt, 0) >> 48; }
+
+	const std::int64_t* box() const { return reinterpret_cast<const std::int64_t*>(static_cast<std::uintptr_t>(m_bits & PAYLOAD)); }
+
+	/**
+	* An Int too wide for the payload.
+	*/
+	static Value boxed(std::int64_t value);
+
+	std::uint64_t m_bits;
+};
+
+static_assert(sizeof(Value) == 8, "Values should be NaN-boxed in 64 bits");
+
+} // namespace Nitro
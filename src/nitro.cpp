@@ -1,9 +1,12 @@
 #include <iostream>
 #include <filesystem>
+#include <optional>
 #include <string>
-#include <fstream>
+#include <string_view>
 
 #include "Lexer/Lexer.hpp"
+#include "Lexer/TokenBuffer.hpp"
+#include "Source/SourceBuffer.hpp"
 #include "Parser/Parser.hpp"
 
 #include "AST/ASTNodeConstant.hpp"
@@ -11,30 +14,140 @@
 #include "AST/ASTNodeBinary.hpp"
 #include "AST/ASTNodeUnary.hpp"
 #include "AST/ASTPrettyPrinter.hpp"
+#include "Optimizer/ConstantFolder.hpp"
+#include "Semantic/ScopeResolver.hpp"
+#include "VM/BytecodeCompiler.hpp"
+#include "VM/ClosureCompiler.hpp"
+#include "VM/ClosureEvaluator.hpp"
+#include "VM/Natives.hpp"
+#include "VM/RegisterCompiler.hpp"
+#include "VM/RegisterVM.hpp"
+#include "VM/VM.hpp"
 
 using namespace Nitro;
 
+namespace {
+
+std::optional<SourceBuffer> load(const std::filesystem::path& script_path) {
+	if (script_path == "-") {
+		return SourceBuffer::fromStream(std::cin);
+	}
+	return SourceBuffer::fromFile(script_path);
+}
+
+enum class Engine {
+	Stack,
+	Register,
+	Closure
+};
+
+// nitro run: compiles the script to bytecode, or closures, and runs it
+int run(const SourceBuffer& source, Engine engine) {
+	StringInterner interner;
+	Lexer lexer(source);
+	lexer.setInterner(&interner);
+	TokenBuffer tokens = lexer.tokenizeAll();
+
+	ASTArena arena;
+	Parser parser(tokens, arena);
+	ASTNode* ast = parser.parse();
+	if (parser.hadError()) {
+		return -10;
+	}
+
+	ConstantFolder folder(arena);
+	ast = folder.fold(ast);
+
+	ScopeResolver resolver(&interner);
+	for (const Native& native : natives()) {
+		resolver.declareGlobal(native.name);
+	}
+	resolver.resolve(ast);
+	if (resolver.hadError()) {
+		return -10;
+	}
+
+	if (engine == Engine::Register) {
+		RegisterCompiler compiler;
+		RegisterProgram program = compiler.compile(ast, resolver);
+		if (compiler.hadError()) {
+			return -10;
+		}
+
+		RegisterVM vm(program);
+		return vm.run() ? 0 : -30;
+	}
+
+	if (engine == Engine::Closure) {
+		ClosureCompiler compiler;
+		ClosureProgram program = compiler.compile(ast, resolver);
+		if (compiler.hadError()) {
+			return -10;
+		}
+
+		ClosureEvaluator evaluator(program);
+		return evaluator.run() ? 0 : -30;
+	}
+
+	BytecodeCompiler compiler;
+	Program program = compiler.compile(ast, resolver);
+	if (compiler.hadError()) {
+		return -10;
+	}
+
+	VM vm(program);
+	return vm.run() ? 0 : -30;
+}
+
+} // namespace
+
 int main(int argc, char *argv[]) {
+	if (argc >= 3 && std::string_view(argv[1]) == "run") {
+		Engine engine = Engine::Stack;
+		int script = 2;
+		if (argc == 4 && std::string_view(argv[2]) == "--engine=register") {
+			engine = Engine::Register;
+			script = 3;
+		} else if (argc == 4 && std::string_view(argv[2]) == "--engine=closure") {
+			engine = Engine::Closure;
+			script = 3;
+		} else if (argc == 4 && std::string_view(argv[2]) == "--engine=stack") {
+			script = 3;
+		}
+
+		if (script == argc - 1) {
+			std::optional<SourceBuffer> source = load(argv[script]);
+			if (!source) {
+				std::cerr << "File does not exist. Now exiting." << std::endl;
+				return -20;
+			}
+			return run(*source, engine);
+		}
+	}
+
 	if (argc != 2) {
-		std::cerr << "Usage: " << argv[0] << " [script]" << std::endl;
+		std::cerr << "Usage: " << argv[0] << " [script | -]" << std::endl;
+		std::cerr << "       " << argv[0] << " run [--engine=stack|register|closure] [script | -]" << std::endl;
 		return -10;
 	}
 	std::filesystem::path script_path{ argv[1] };
 
-	std::cout << "Compiling " << script_path.string() << std::endl;
+	std::optional<SourceBuffer> source;
+	if (script_path == "-") {
+		std::cout << "Compiling <stdin>" << std::endl;
+		source = SourceBuffer::fromStream(std::cin);
+	} else {
+		std::cout << "Compiling " << script_path.string() << std::endl;
+		source = SourceBuffer::fromFile(script_path);
+	}
 
-	std::ifstream infile(script_path);
-	if (!infile) {
+	if (!source) {
 		std::cerr << "File does not exist. Now exiting." << std::endl;
 		return -20;
 	}
-	std::string source(
-		(std::istreambuf_iterator<char>(infile)),
-		(std::istreambuf_iterator<char>())
-			);
 
 	// Test the lexer
-	Lexer lexer(source);
+	Lexer lexer(*source);
 
 
 	Token tk;
@@ -55,10 +168,14 @@ int main(int argc, char *argv[]) {
 		}
 	}
 
-	Lexer lexer2(source);
-	Parser parser(lexer2);
+	StringInterner interner;
+	Lexer lexer2(*source);
+	lexer2.setInterner(&interner);
+	TokenBuffer tokens = lexer2.tokenizeAll();
+	ASTArena arena;
+	Parser parser(tokens, arena);
 
-	auto ast = parser.parse();
+	ASTNode* ast = parser.parse();
 	
 	if (!ast) {
 		std::cerr << "Did not compile" << std::endl;
@@ -66,7 +183,7 @@ int main(int argc, char *argv[]) {
 	}
 
 	ASTPrettyPrinter printer(std::cout);
-	ast->visit(printer);
+	printer.walk(ast);
 
 	return 0;
 }